@@ -0,0 +1,124 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Batches acceleration structure work into a single command buffer per submit.
+// Queued work is recorded in dependency order: BLAS builds, then property queries (compacted or
+// serialized size), then copies (compaction, serialization, deserialization), then TLAS builds, with one barrier between each phase. Every build gets
+// its own aligned slice of one reusable scratch arena (a phase starts again at offset 0 once
+// the barrier has retired the previous phase). Completion is signalled with a fence, so other
+// work on the queue keeps running while a batch is in flight.
+class AccelerationStructureBuilder {
+public:
+    AccelerationStructureBuilder(VkDevice device, VkPhysicalDevice physicalDevice,
+                                 VkCommandPool commandPool, VkQueue queue);
+    ~AccelerationStructureBuilder();
+
+    AccelerationStructureBuilder(const AccelerationStructureBuilder&) = delete;
+    AccelerationStructureBuilder& operator=(const AccelerationStructureBuilder&) = delete;
+
+    // buildInfo.pGeometries and ranges must stay valid until submit(); the scratch address is
+    // filled in from the arena
+    void addBuild(const VkAccelerationStructureBuildGeometryInfoKHR& buildInfo,
+                  const VkAccelerationStructureBuildRangeInfoKHR* ranges, VkDeviceSize scratchSize);
+    void addPropertyQuery(VkAccelerationStructureKHR accelerationStructure, VkQueryType queryType,
+                          VkQueryPool queryPool, uint32_t query);
+    void addCopy(const VkCopyAccelerationStructureInfoKHR& copyInfo);
+    // Serialized data is made visible to host reads once the submit has completed
+    void addSerialize(const VkCopyAccelerationStructureToMemoryInfoKHR& copyInfo);
+    void addDeserialize(const VkCopyMemoryToAccelerationStructureInfoKHR& copyInfo);
+
+    // Destroyed once the next submit has completed (e.g. the source of a compaction copy or a
+    // deserialization upload buffer; accelerationStructure may be VK_NULL_HANDLE)
+    void retireAfterCompletion(VkAccelerationStructureKHR accelerationStructure, VkBuffer buffer,
+                               VkDeviceMemory memory);
+
+    // Records everything queued into one command buffer and submits it with the fence
+    void submit();
+    // Blocks on the fence of the last submit, then frees its command buffer and retired objects
+    void wait();
+    void flush() { submit(); wait(); }
+
+    // Per-frame refits recorded into frame command buffers share the arena: grow it to at least
+    // size at setup time, then use getScratchAddress() (valid until the arena grows again)
+    void reserveScratch(VkDeviceSize size);
+    VkDeviceAddress getScratchAddress() const { return scratchAddress; }
+    
+    // GPU time of the TLAS phase of the last completed submit that had one (timestamp queries;
+    // 0 when the device has no graphics/compute timestamps)
+    double getLastTopLevelBuildMs() const { return lastTopLevelBuildMs; }
+    
+    // Inspection: bracket every build with its own timestamps and a barrier, so builds in a
+    // phase run one after another instead of overlapping (slower; off by default)
+    void setPerBuildTimestamps(bool enabled) { perBuildTimestamps = enabled; }
+    // GPU time of the last timed build into this structure, or < 0 when it was not timed
+    double getBuildMs(VkAccelerationStructureKHR accelerationStructure) const;
+
+private:
+    struct PendingBuild {
+        VkAccelerationStructureBuildGeometryInfoKHR buildInfo;
+        const VkAccelerationStructureBuildRangeInfoKHR* ranges;
+        VkDeviceSize scratchSize;
+    };
+    struct PendingQuery {
+        VkAccelerationStructureKHR accelerationStructure;
+        VkQueryType queryType;
+        VkQueryPool queryPool;
+        uint32_t query;
+    };
+    struct RetiredStructure {
+        VkAccelerationStructureKHR accelerationStructure;
+        VkBuffer buffer;
+        VkDeviceMemory memory;
+    };
+
+    VkDevice device;
+    VkPhysicalDevice physicalDevice;
+    VkCommandPool commandPool;
+    VkQueue queue;
+
+    VkDeviceSize scratchAlignment = 1;   // minAccelerationStructureScratchOffsetAlignment
+    VkBuffer scratchBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory scratchMemory = VK_NULL_HANDLE;
+    VkDeviceSize scratchCapacity = 0;
+    VkDeviceAddress scratchAddress = 0;   // Aligned base of the arena
+
+    std::vector<PendingBuild> bottomLevelBuilds;
+    std::vector<PendingBuild> topLevelBuilds;
+    std::vector<PendingQuery> queries;
+    std::vector<VkCopyAccelerationStructureInfoKHR> copies;
+    std::vector<VkCopyAccelerationStructureToMemoryInfoKHR> serializations;
+    std::vector<VkCopyMemoryToAccelerationStructureInfoKHR> deserializations;
+    std::vector<RetiredStructure> retiring;    // Queued for the next submit
+    std::vector<RetiredStructure> inFlight;    // Freed by wait()
+
+    VkFence fence = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;   // Non-null while a submit is in flight
+    
+    VkQueryPool timestampPool = VK_NULL_HANDLE;   // Begin/end of the TLAS phase
+    double timestampPeriodNs = 1.0;
+    bool topLevelTimed = false;                   // The in-flight submit wrote the timestamps
+    double lastTopLevelBuildMs = 0.0;
+    
+    bool perBuildTimestamps = false;
+    VkQueryPool buildTimestampPool = VK_NULL_HANDLE;   // Begin/end pair per build
+    uint32_t buildTimestampCapacity = 0;
+    std::vector<VkAccelerationStructureKHR> timedBuilds;   // In flight, in query pair order
+    std::unordered_map<VkAccelerationStructureKHR, double> buildMs;
+
+    PFN_vkCmdBuildAccelerationStructuresKHR vkCmdBuildAccelerationStructuresKHR;
+    PFN_vkCmdWriteAccelerationStructuresPropertiesKHR vkCmdWriteAccelerationStructuresPropertiesKHR;
+    PFN_vkCmdCopyAccelerationStructureKHR vkCmdCopyAccelerationStructureKHR;
+    PFN_vkCmdCopyAccelerationStructureToMemoryKHR vkCmdCopyAccelerationStructureToMemoryKHR;
+    PFN_vkCmdCopyMemoryToAccelerationStructureKHR vkCmdCopyMemoryToAccelerationStructureKHR;
+    PFN_vkDestroyAccelerationStructureKHR vkDestroyAccelerationStructureKHR;
+
+    VkDeviceSize alignScratch(VkDeviceSize size) const;
+    VkDeviceSize phaseScratchSize(const std::vector<PendingBuild>& builds) const;
+    void recordBuilds(std::vector<PendingBuild>& builds);
+    void recordPhaseBarrier();
+    void reserveBuildTimestamps(uint32_t buildCount);
+};
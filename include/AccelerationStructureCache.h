@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Serialized bottom level acceleration structures persisted between runs, so a warm start
+// deserializes them (vkCmdCopyMemoryToAccelerationStructureKHR) instead of building.
+//
+// Entries are keyed by a hash of the source geometry and build flags. Every serialized blob
+// starts with the driver UUID and the acceleration structure compatibility ID of the device
+// that wrote it; entries the current driver rejects (vkGetDeviceAccelerationStructureCompatibilityKHR)
+// are dropped at load time, and the caller falls back to a regular build.
+//
+// On-disk layout: a small header (magic, format version, entry count), then per entry the key,
+// blob size and the raw serialized blob. Only entries looked up or stored during the run are
+// written back, so stale geometry does not accumulate.
+class AccelerationStructureCache {
+public:
+    AccelerationStructureCache(VkDevice device, const std::string& path);
+
+    AccelerationStructureCache(const AccelerationStructureCache&) = delete;
+    AccelerationStructureCache& operator=(const AccelerationStructureCache&) = delete;
+
+    // Compatible serialized data for key, or nullptr
+    const std::vector<uint8_t>* find(uint64_t key);
+    void store(uint64_t key, std::vector<uint8_t> data);
+
+    // Written back only when something was stored (temp file + rename, like PipelineCache)
+    bool save() const;
+
+    // Size of the acceleration structure a blob deserializes into (from the serialized header)
+    static VkDeviceSize deserializedSize(const std::vector<uint8_t>& data);
+
+    // 64-bit FNV-1a; chain calls through seed to hash several ranges
+    static constexpr uint64_t HASH_SEED = 0xcbf29ce484222325ull;
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = HASH_SEED);
+
+private:
+    struct Entry {
+        std::vector<uint8_t> data;
+        bool used = false;
+    };
+
+    static constexpr uint32_t FILE_MAGIC = 0x43415343;   // "CSAC"
+    static constexpr uint32_t FILE_VERSION = 1;
+    static constexpr uint64_t MAX_ENTRY_SIZE = 1ull << 30;   // Larger sizes can only be corruption
+    // driverUUID, compatibility ID, serialized size, deserialized size, handle count
+    static constexpr size_t SERIALIZED_HEADER_SIZE = 2 * VK_UUID_SIZE + 3 * sizeof(uint64_t);
+
+    VkDevice device;
+    std::string path;
+    std::unordered_map<uint64_t, Entry> entries;
+    bool dirty = false;
+
+    PFN_vkGetDeviceAccelerationStructureCompatibilityKHR vkGetDeviceAccelerationStructureCompatibilityKHR;
+
+    void load();
+    bool isCompatible(const std::vector<uint8_t>& data) const;
+};
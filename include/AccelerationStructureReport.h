@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "ClippyGeometry.h"
+#include "RayTracingPipeline.h"
+#include "Vertex.h"
+
+// Machine-readable inspection of the acceleration structures, so a geometry change that makes
+// tracing slower shows up as a diff in review.
+//
+// Per structure: source (device/host build or cache), primitive and degenerate triangle counts,
+// size before and after compaction, scratch sizes and GPU build time. Every BLAS also gets a
+// CPU BVH mirror (Bvh, same part geometry) with node count, leaf depth histogram and SAH cost,
+// which tracks tree quality independently of the driver's builder.
+class AccelerationStructureReport {
+public:
+    // structures[i] is the BLAS of parts[i] for i < parts.size(); the rest are top level
+    static bool write(const std::string& path, const std::string& deviceName,
+                      const std::vector<RayTracingPipeline::AccelerationStructureStats>& structures,
+                      const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                      const std::vector<ClippyGeometry::Part>& parts);
+};
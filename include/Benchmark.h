@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Deterministic benchmark: fixed timestep, scripted timeline, percentile report.
+//
+// Script format (one key per line, '#' starts a comment, times in seconds):
+//   <time> camera <px> <py> <pz> <tx> <ty> <tz>   position + look-at target, linearly interpolated
+//   <time> personality <0-5>                      step: holds until the next key
+//   <time> rtx on|off                             step
+class Benchmark {
+public:
+    struct Options {
+        uint32_t frames = 600;
+        uint32_t warmupFrames = 60;
+        float timestep = 1.0f / 60.0f;
+        std::string scriptPath;                   // Empty = default orbit camera
+        std::string reportPath = "benchmark.json";
+    };
+
+    // Script state at a given time; fields without keys are left unset
+    struct ScriptState {
+        bool hasCamera = false;
+        glm::vec3 cameraPos{0.0f};
+        glm::vec3 cameraTarget{0.0f};
+        int personalityMode = -1;
+        int rtxEnabled = -1;
+    };
+
+    struct Percentiles {
+        double min = 0.0, avg = 0.0, p50 = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0;
+        size_t count = 0;
+    };
+
+    explicit Benchmark(const Options& options);
+
+    const Options& getOptions() const { return options; }
+    uint32_t totalFrames() const { return options.warmupFrames + options.frames; }
+
+    ScriptState evaluate(float time) const;
+
+    // Measured frames only (after warmup)
+    void recordCpuFrame(double ms) { cpuFrameMs.push_back(static_cast<float>(ms)); }
+    void sampleDeviceMemory(VkPhysicalDevice physicalDevice, bool memoryBudgetSupported);
+
+    // GPU samples are appended by GpuProfiler (see GpuProfiler::captureScope)
+    std::vector<float>& gpuFrameSamples() { return gpuFrameMs; }
+    std::vector<float>& gpuTraceRaysSamples() { return gpuTraceRaysMs; }
+    std::vector<float>& gpuTlasUpdateSamples() { return gpuTlasUpdateMs; }
+
+    // TLAS scaling: instance count, GPU time of the initial full build, and the per-frame
+    // CPU instance fill (the per-frame GPU refit comes from the tlasUpdate scope)
+    void setTLASStats(uint32_t instanceCount, double buildMs) { tlasInstances = instanceCount; tlasBuildMs = buildMs; }
+    void recordInstanceFill(double ms) { cpuInstanceFillMs.push_back(static_cast<float>(ms)); }
+
+    // primaryRaysPerFrame = pixels * samples per pixel of a ray traced frame
+    bool writeReport(const std::string& deviceName, VkExtent2D extent, uint64_t primaryRaysPerFrame) const;
+
+    static Percentiles computePercentiles(std::vector<float> samples);
+
+private:
+    struct CameraKey {
+        float time;
+        glm::vec3 position;
+        glm::vec3 target;
+    };
+    struct StepKey {
+        float time;
+        int value;
+    };
+
+    Options options;
+    std::vector<CameraKey> cameraKeys;
+    std::vector<StepKey> personalityKeys;
+    std::vector<StepKey> rtxKeys;
+
+    std::vector<float> cpuFrameMs;
+    std::vector<float> gpuFrameMs;
+    std::vector<float> gpuTraceRaysMs;
+    std::vector<float> gpuTlasUpdateMs;
+    std::vector<float> cpuInstanceFillMs;
+    uint32_t tlasInstances = 0;
+    double tlasBuildMs = 0.0;
+    VkDeviceSize peakDeviceBytes = 0;
+    bool deviceMemoryKnown = false;
+
+    void loadScript(const std::string& path);
+    static int stepValueAt(const std::vector<StepKey>& keys, float time);
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "Vertex.h"
+
+// Binned-SAH bounding volume hierarchy over an indexed triangle mesh, built on the CPU.
+// No Vulkan objects are involved, so it runs without a GPU (picking, software rendering,
+// offline analysis of the geometry the BLAS is built from).
+//
+// Nodes live in one flat array aligned to a cache line. Children are allocated in pairs
+// (left, left + 1) starting at an even index, so siblings share a 64-byte line; index 1 is
+// left unused for that reason. Large subtrees are built as parallel tasks: each task owns a
+// disjoint range of the triangle order and allocates its child pairs from an atomic counter.
+class Bvh {
+public:
+    static constexpr size_t CACHE_LINE = 64;
+    // Nodes this deep become leaves whatever their size, so a traversal stack of MAX_DEPTH entries
+    // (one far child per level) never overflows, even on degenerate input
+    static constexpr uint32_t MAX_DEPTH = 64;
+
+    // Minimal allocator so std::vector storage starts on a cache line
+    template <typename T>
+    struct CacheAlignedAllocator {
+        using value_type = T;
+        CacheAlignedAllocator() = default;
+        template <typename U>
+        CacheAlignedAllocator(const CacheAlignedAllocator<U>&) {}
+        T* allocate(size_t n) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(CACHE_LINE)));
+        }
+        void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(CACHE_LINE)); }
+        template <typename U>
+        bool operator==(const CacheAlignedAllocator<U>&) const { return true; }
+        template <typename U>
+        bool operator!=(const CacheAlignedAllocator<U>&) const { return false; }
+    };
+
+    // 32 bytes: count == 0 is an interior node whose children are leftOrFirst and leftOrFirst + 1,
+    // otherwise a leaf over triangleOrder[leftOrFirst, leftOrFirst + count)
+    struct alignas(32) Node {
+        glm::vec3 boundsMin;
+        uint32_t leftOrFirst;
+        glm::vec3 boundsMax;
+        uint32_t count;
+
+        bool isLeaf() const { return count > 0; }
+    };
+
+    struct Triangle {
+        glm::vec3 v0, v1, v2;
+    };
+
+    struct BuildOptions {
+        uint32_t binCount = 16;
+        uint32_t maxLeafSize = 4;
+        float traversalCost = 1.0f;          // SAH cost of visiting an interior node
+        float intersectionCost = 1.0f;       // SAH cost of one ray/triangle test
+        bool parallel = true;
+        uint32_t parallelMinTriangles = 8192;   // Smaller subtrees stay on the calling thread
+    };
+
+    struct BuildStats {
+        uint32_t triangleCount = 0;
+        uint32_t nodeCount = 0;
+        uint32_t leafCount = 0;
+        uint32_t maxDepth = 0;
+        float sahCost = 0.0f;
+        double buildMs = 0.0;
+        std::vector<uint32_t> leafDepthHistogram;   // Leaves per depth, [0, maxDepth]
+    };
+
+    struct Ray {
+        glm::vec3 origin;
+        glm::vec3 direction;
+        float tMax = std::numeric_limits<float>::max();
+    };
+
+    struct Hit {
+        float t = std::numeric_limits<float>::max();
+        float u = 0.0f;
+        float v = 0.0f;
+        uint32_t triangle = UINT32_MAX;   // Index into the source triangles (indices / 3)
+    };
+
+    void build(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+    void build(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+               const BuildOptions& options);
+
+    // Closest hit along the ray; returns false on a miss
+    bool intersect(const Ray& ray, Hit& hit) const;
+
+    // SAH cost of the finished tree, relative to the root surface area
+    float computeSahCost() const;
+
+    const std::vector<Node, CacheAlignedAllocator<Node>>& getNodes() const { return nodes; }
+    const std::vector<uint32_t>& getTriangleOrder() const { return triangleOrder; }
+    const std::vector<Triangle>& getTriangles() const { return triangles; }
+    const BuildStats& getStats() const { return stats; }
+    const BuildOptions& getOptions() const { return options; }
+
+    // Builds the mesh replicated 1, 4, 16, ... times on a grid (up to maxReplicas) and writes
+    // triangle count, build time (parallel and single-threaded) and SAH cost per size as JSON
+    static bool writeScalingReport(const std::string& path, const std::vector<Vertex>& vertices,
+                                   const std::vector<uint32_t>& indices, uint32_t maxReplicas = 64);
+
+private:
+    struct Bounds {
+        glm::vec3 min{std::numeric_limits<float>::max()};
+        glm::vec3 max{-std::numeric_limits<float>::max()};
+
+        void grow(const glm::vec3& p) { min = glm::min(min, p); max = glm::max(max, p); }
+        void grow(const Bounds& b) { min = glm::min(min, b.min); max = glm::max(max, b.max); }
+        float area() const;
+    };
+
+    struct Split {
+        int axis = -1;
+        float position = 0.0f;
+        float cost = std::numeric_limits<float>::max();
+    };
+
+    BuildOptions options;
+    std::vector<Node, CacheAlignedAllocator<Node>> nodes;
+    std::vector<uint32_t> triangleOrder;
+    std::vector<Triangle> triangles;
+    std::vector<Bounds> triangleBounds;       // Build only
+    std::vector<glm::vec3> triangleCentroids; // Build only
+    BuildStats stats;
+
+    void buildNode(uint32_t nodeIndex, uint32_t depth, std::atomic<uint32_t>& nodesUsed);
+    void updateNodeBounds(Node& node) const;
+    Split findBestSplit(const Node& node) const;
+    void gatherStats(uint32_t nodeIndex, uint32_t depth);
+};
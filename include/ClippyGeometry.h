@@ -1,14 +1,54 @@
 #pragma once
 
 #include <vector>
+#include <string>
 #include <glm/glm.hpp>
 #include "Vertex.h"
 
 class ClippyGeometry {
 public:
+    // A named piece of geometry in its own local space: a range of the shared vertex/index
+    // arrays, with indices relative to the part's first vertex
+    struct Part {
+        std::string name;
+        uint32_t firstVertex = 0;
+        uint32_t vertexCount = 0;
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        uint64_t contentHash = 0;   // Vertices + indices, keys the acceleration structure cache
+        uint32_t degenerateTriangles = 0;   // Repeated indices or (near) zero area
+    };
+    
+    // Stored in the TLAS instance custom index; keep in sync with closesthit.rchit
+    enum PartMaterial : uint32_t {
+        MATERIAL_WIRE = 0,
+        MATERIAL_EYE = 1,
+        MATERIAL_HIGHLIGHT = 2
+    };
+    
+    // One placement of a part in model space
+    struct PartInstance {
+        uint32_t part = 0;
+        glm::mat4 transform{1.0f};
+        PartMaterial material = MATERIAL_WIRE;
+    };
+    
+    // Part 0 is the wire body (identity transform); the eyes and their highlights are two unit
+    // spheres instanced twice each
+    static void generateClippyParts(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                                    std::vector<Part>& parts, std::vector<PartInstance>& instances);
+    
+    // Flat mesh with every instance baked into model space (rasterization path)
     static void generateClippy(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
     
 private:
+    static void beginPart(std::vector<Part>& parts, const char* name,
+                          const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+    static void endPart(std::vector<Part>& parts,
+                        const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+    
+    static void createWire(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+    
     static void createTorusSection(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
                                    glm::vec3 center, float majorRadius, float minorRadius,
                                    float startAngle, float endAngle, int segments,
@@ -23,8 +63,7 @@ private:
                                   int segments, glm::vec3 color);
     
     // Funciones para crear los ojitos de Clippy 👀
-    static void createClippyEyes(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, 
-                                 glm::vec3 baseColor);
+    static void createClippyEyes(std::vector<PartInstance>& instances, uint32_t eyePart, uint32_t highlightPart);
     
     static void createEyeSphere(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
                                 glm::vec3 center, float radius, int segments, glm::vec3 color);
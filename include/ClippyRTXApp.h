@@ -7,6 +7,7 @@
 
 #include <vector>
 #include <memory>
+#include <string>
 
 #include "Vertex.h"
 #include "VulkanHelpers.h"
@@ -14,21 +15,103 @@
 #include "RayTracingPipeline.h"
 #include "ClippyUI.h"
 #include "PostProcessing.h"
+#include "GpuWatchdog.h"
+#include "UniformRing.h"
+#include "GpuProfiler.h"
+#include "HeadlessTarget.h"
+#include "Benchmark.h"
+#include "PipelineCache.h"
+#include "TileScheduler.h"
+#include "DeformationPass.h"
+#include "CpuPathTracer.h"
+#include "ImageCompare.h"
 
 const uint32_t WIDTH = 1920;
 const uint32_t HEIGHT = 1080;
-const int MAX_FRAMES_IN_FLIGHT = 2;
+const uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+const uint32_t MAX_FRAMES_IN_FLIGHT = 4;
 
 class ClippyRTXApp {
 public:
     void run();
+    
+    // Must be called before run(); clamped to [1, MAX_FRAMES_IN_FLIGHT]
+    void setFramesInFlight(uint32_t count);
+    
+    // Headless: no GLFW window, surface or swapchain. Renders a fixed number of frames at a
+    // fixed timestep into offscreen images and writes the selected ones to outputDir.
+    struct HeadlessOptions {
+        uint32_t width = WIDTH;
+        uint32_t height = HEIGHT;
+        uint32_t frameCount = 60;
+        uint32_t saveEvery = 0;   // 0 = only the last frame
+        std::string outputDir = "headless_out";
+    };
+    void setHeadless(const HeadlessOptions& options);
+    
+    // Benchmark: fixed timestep + scripted timeline, writes a JSON report (windowed or headless)
+    void setBenchmark(const Benchmark::Options& options);
+    
+    // Tiled traceRays: tileSize 0 = single launch; tilesPerFrame 0 = whole image every frame,
+    // otherwise each frame (one submit) traces at most that many tiles
+    void setTracing(uint32_t tileSize, uint32_t tilesPerFrame);
+    
+    // BLAS compaction after build (on by default)
+    void setBLASCompaction(bool enabled) { blasCompaction = enabled; }
+    
+    // Animated BLAS: the personality animation is applied to the ray traced geometry too, refit
+    // every frame and fully rebuilt every rebuildInterval frames (on by default)
+    void setAnimatedBLAS(bool enabled, uint32_t rebuildInterval);
+    
+    // Crowd mode: count Clippies in the ray traced scene (1 = just the hero)
+    void setCrowdSize(uint32_t count) { crowdSize = count; }
+    
+    // Serialized BLAS cache on disk for warm starts (on by default)
+    void setAccelerationStructureCache(bool enabled) { asCacheEnabled = enabled; }
+    
+    // Build static BLASes on the CPU when the device supports accelerationStructureHostCommands
+    // (on by default; device builds otherwise)
+    void setHostASBuilds(bool enabled) { hostASBuilds = enabled; }
+    
+    // Acceleration structure inspection report (JSON) written once they are built; also turns
+    // on per-build GPU timestamps
+    void setAccelerationStructureReport(const std::string& path) { asReportPath = path; }
+    
+    // Without ray tracing support, trace on the CPU (CpuPathTracer) and upload each frame instead
+    // of dropping to rasterization (on by default); threadCount 0 = one per hardware thread
+    void setCpuFallback(bool enabled, uint32_t threadCount) { cpuFallback = enabled; cpuTraceThreads = threadCount; }
+    // Primary rays of the CPU fallback as 8x8 packets (on by default) or one ray per pixel
+    void setCpuPacketTracing(bool enabled) { cpuTracePackets = enabled; }
+    // Bounces of the CPU fallback through sorted wavefront queues (off by default) or recursively
+    void setCpuWavefront(bool enabled) { cpuTraceWavefront = enabled; }
+    
+    // Headless regression check: every saved frame is also traced by a CpuPathTracer into
+    // <outputDir>/reference, and after the run each frame is compared with its reference
+    // (ImageCompare): diffs and error maps go to <outputDir>/compare, metrics to
+    // <outputDir>/image_compare.json. The animated BLAS is turned off and the crowd reduced to one
+    // Clippy, as the reference traces a single rest pose; frames of a partial tiled pass
+    // (--tiles-per-frame) do not match it.
+    void setImageComparison(const ImageCompare::Thresholds& thresholds) { imageComparison = true; compareThresholds = thresholds; }
+    // False once a compared frame had no reference or broke a threshold
+    bool imageComparisonPassed() const { return comparePassed; }
 
 private:
-    GLFWwindow* window;
+    GLFWwindow* window = nullptr;
+    
+    bool headless = false;
+    HeadlessOptions headlessOptions;
+    std::unique_ptr<HeadlessTarget> headlessTarget;  // Stands in for the swapchain images
+    uint32_t headlessFrame = 0;
+    
+    std::unique_ptr<Benchmark> benchmark;
+    bool memoryBudgetSupported = false;   // VK_EXT_memory_budget, for the report
+    bool cameraScripted = false;
+    glm::vec3 scriptedCameraPos{0.0f};
+    glm::vec3 scriptedCameraTarget{0.0f};
     
     VkInstance instance;
     VkDebugUtilsMessengerEXT debugMessenger;
-    VkSurfaceKHR surface;
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
     
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
     VkDevice device;
@@ -36,7 +119,7 @@ private:
     VkQueue graphicsQueue;
     VkQueue presentQueue;
     
-    VkSwapchainKHR swapChain;
+    VkSwapchainKHR swapChain = VK_NULL_HANDLE;
     std::vector<VkImage> swapChainImages;
     VkFormat swapChainImageFormat;
     VkExtent2D swapChainExtent;
@@ -44,6 +127,10 @@ private:
     std::vector<VkFramebuffer> swapChainFramebuffers;
     std::vector<VkFramebuffer> uiFramebuffers;  // UI overlay framebuffers
     
+    // Layout the output images end every frame in: PRESENT_SRC with a swapchain,
+    // TRANSFER_SRC for headless readback
+    VkImageLayout outputFinalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    
     // Ray Tracing Storage Images
     VkImage rtOutputImage;
     VkDeviceMemory rtOutputImageMemory;
@@ -52,6 +139,7 @@ private:
     VkImage rtAccumulationImage;
     VkDeviceMemory rtAccumulationImageMemory;
     VkImageView rtAccumulationImageView;
+    bool rtStorageImagesNeedInit = true;   // Fresh images are UNDEFINED until the first RTX frame
     
     VkRenderPass renderPass;
     VkRenderPass uiRenderPass = VK_NULL_HANDLE;  // Dedicated UI overlay render pass
@@ -78,18 +166,41 @@ private:
     VkBuffer indexBuffer;
     VkDeviceMemory indexBufferMemory;
     
-    std::vector<VkBuffer> uniformBuffers;
-    std::vector<VkDeviceMemory> uniformBuffersMemory;
+    // Ray tracing geometry: one BLAS per part, the eyes instanced in the TLAS
+    std::vector<Vertex> partVertices;
+    std::vector<uint32_t> partIndices;
+    std::vector<ClippyGeometry::Part> clippyParts;
+    std::vector<ClippyGeometry::PartInstance> clippyPartInstances;
+    VkBuffer partVertexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory partVertexBufferMemory = VK_NULL_HANDLE;
+    VkBuffer partIndexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory partIndexBufferMemory = VK_NULL_HANDLE;
+    
+    // Persistently mapped uniform memory shared with PostProcessing (dynamic offsets)
+    std::unique_ptr<UniformRing> uniformRing;
+    UniformRing::BlockHandle sceneUniformBlock = 0;
     
     VkDescriptorPool descriptorPool;
     std::vector<VkDescriptorSet> descriptorSets;
     
+    // Un command pool por frame en vuelo: se resetea entero cuando su valor del timeline se alcanza
+    // y el primary buffer preasignado se vuelve a grabar (sin allocs por frame)
+    std::vector<VkCommandPool> frameCommandPools;
     std::vector<VkCommandBuffer> commandBuffers;
     
-    std::vector<VkSemaphore> imageAvailableSemaphores;
-    std::vector<VkSemaphore> renderFinishedSemaphores;
-    std::vector<VkFence> inFlightFences;
-    std::vector<VkFence> imagesInFlight;
+    uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+    
+    std::vector<VkSemaphore> imageAvailableSemaphores;  // Per frame in flight (binary, acquire)
+    std::vector<VkSemaphore> renderFinishedSemaphores;  // Per swapchain image (binary, present)
+    
+    // Timeline semaphore: each submit signals ++frameTimelineValue. A frame slot can be
+    // reused once the value it last signaled has been reached - the only CPU wait per frame.
+    VkSemaphore frameTimeline = VK_NULL_HANDLE;
+    uint64_t frameTimelineValue = 0;
+    std::vector<uint64_t> frameSlotTimelineValues;
+    std::unique_ptr<GpuWatchdog> gpuWatchdog;
+    std::unique_ptr<GpuProfiler> gpuProfiler;   // Timestamp scopes around every pass
+    std::unique_ptr<PipelineCache> pipelineCache;   // Shared by every pipeline, persisted across runs
     size_t currentFrame = 0;
     
     bool framebufferResized = false;
@@ -98,6 +209,25 @@ private:
     // Ray Tracing
     std::unique_ptr<RayTracingPipeline> rayTracingPipeline;
     
+    // CPU fallback: traced into a persistently mapped staging buffer per frame in flight, copied
+    // to the output image by the frame's command buffer
+    std::unique_ptr<CpuPathTracer> cpuPathTracer;
+    bool cpuFallback = true;
+    uint32_t cpuTraceThreads = 0;
+    bool cpuTracePackets = true;
+    bool cpuTraceWavefront = false;
+    std::vector<VkBuffer> cpuTraceUploadBuffers;
+    std::vector<VkDeviceMemory> cpuTraceUploadMemories;
+    std::vector<void*> cpuTraceUploadMapped;
+    
+    // Image comparison: the CPU reference renders each ray traced frame next to the device
+    std::unique_ptr<CpuPathTracer> referenceTracer;
+    UniformBufferObject referenceUniforms{};    // Uniforms of the last ray traced frame
+    bool referencePending = false;              // referenceUniforms not traced yet
+    bool imageComparison = false;
+    ImageCompare::Thresholds compareThresholds;
+    bool comparePassed = true;
+    
     // UI System
     std::unique_ptr<ClippyUI> clippyUI;
     
@@ -116,11 +246,56 @@ private:
     uint32_t frameCount = 0;
     int maxBounces = 3;
     int samplesPerPixel = 4;
+    uint32_t currentSamplesPerPixel = 1;   // What the last UBO actually used
+    
+    // Personality cycle shown by the shaders (was function-static state)
+    int personalityMode = 0;
+    float personalityTimer = 0.0f;
+    bool personalityScripted = false;
+    float animationModeTimer = 0.0f;
     
     // Mouse interaction
     double mouseX = 0.0, mouseY = 0.0;
+    int windowWidth = WIDTH, windowHeight = HEIGHT;  // Updated by windowSizeCallback
+    
+    // Camera matrices are only inverted when they change
+    glm::mat4 cachedView{0.0f}, cachedViewInverse{1.0f};
+    glm::mat4 cachedProj{1.0f}, cachedProjInverse{1.0f};
+    VkExtent2D cachedProjExtent{0, 0};
     bool mousePressed = false;
     
+    // Progressive accumulation: the running average restarts when any of these change
+    bool accumulationEnabled = true;
+    bool animationPaused = false;   // Freezes the scene so a static view can converge
+    uint32_t accumulationFrame = 0;
+    glm::mat4 accumulationView{0.0f}, accumulationModel{0.0f};
+    int accumulationPersonality = -1;
+    VkExtent2D accumulationExtent{0, 0};
+    
+    // Tiled ray tracing dispatch
+    TileScheduler tileScheduler;
+    uint32_t traceTileSize = 0;
+    uint32_t traceTilesPerFrame = 0;
+    float clippyBoundingRadius = 1.0f;   // Model space, for the tile cost estimate
+    
+    bool blasCompaction = true;
+    glm::mat4 instanceTransform{1.0f};   // ubo.model, written into the TLAS instances every frame
+    float instanceTime = 0.0f;           // ubo.time, drives the crowd animation
+    uint32_t crowdSize = 1;
+    bool asCacheEnabled = true;
+    bool hostASBuilds = true;
+    bool hostASBuildsSupported = false;   // accelerationStructureHostCommands enabled on the device
+    std::string asReportPath;
+    
+    // Animated BLAS
+    std::unique_ptr<DeformationPass> deformationPass;
+    bool animatedBLAS = true;
+    uint32_t blasRebuildInterval = 60;
+    uint32_t framesSinceBLASRebuild = 0;
+    int blasBuiltPersonality = -1;           // Personality of the last full rebuild
+    float deformAnimationStrength = 0.0f;    // Last values written to the UBO
+    float deformGlitchIntensity = 0.0f;
+    
     // Animation modes
     enum class AnimationMode {
         IDLE,
@@ -136,10 +311,15 @@ private:
     void initWindow();
     void initVulkan();
     void mainLoop();
+    void headlessLoop();
+    void benchmarkLoop();
+    void stepFixedFrame(float timestep);
+    void applyBenchmarkScript();
     void cleanup();
     
     // Window callbacks
     static void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+    static void windowSizeCallback(GLFWwindow* window, int width, int height);
     static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
     static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
     static void cursorPositionCallback(GLFWwindow* window, double xpos, double ypos);
@@ -155,6 +335,9 @@ private:
     void pickPhysicalDevice();
     void createLogicalDevice();
     void createSwapChain();
+    void createHeadlessTarget();
+    bool isSavedHeadlessFrame() const;
+    std::vector<const char*> getDeviceExtensions() const;
     void createImageViews();
     void createRenderPass();
     void createUIRenderPass();
@@ -166,13 +349,17 @@ private:
     void createRayTracingStorageImages();
     void createFramebuffers();
     void createUIFramebuffers();
+    void createDeviceLocalBuffer(const void* contents, VkDeviceSize bufferSize, VkBufferUsageFlags usage,
+                                 VkBuffer& buffer, VkDeviceMemory& bufferMemory);
     void createVertexBuffer();
     void createIndexBuffer();
+    void createPartBuffers();
     void createUniformBuffers();
     void createDescriptorPool();
     void createDescriptorSets();
     void createCommandBuffers();
     void createSyncObjects();
+    void createPresentSemaphores();
     
     // Geometry
     void createClippyGeometry();
@@ -181,6 +368,12 @@ private:
     bool checkRayTracingSupport();
     void setupRayTracing();
     void updateDescriptorSetsWithTLAS();
+    void setupCpuPathTracer();
+    void createCpuTraceUploadBuffers();
+    void destroyCpuTraceUploadBuffers();
+    void setupReferenceTracer();
+    void traceReference();
+    void compareWithReference();
     
     // UI System
     void setupUI();
@@ -196,6 +389,11 @@ private:
     void updateUniformBuffer(uint32_t currentImage);
     void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
     void copyRTOutputToSwapchain(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+    void recordCpuTraceUpload(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+    void prepareRTStorageImages(VkCommandBuffer commandBuffer);
+    void recordBLASUpdate(VkCommandBuffer commandBuffer);
+    void updateAccumulation(UniformBufferObject& ubo);
+    void updateTraceTiles(const UniformBufferObject& ubo);
     
     // Swapchain recreation
     void recreateSwapChain();
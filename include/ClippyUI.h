@@ -9,6 +9,8 @@
 #include <imgui_impl_vulkan.h>
 #include <GLFW/glfw3.h>
 
+#include "GpuProfiler.h"
+
 class ClippyUI {
 public:
     ClippyUI(VkDevice device, VkRenderPass renderPass, VkDescriptorPool descriptorPool, 
@@ -33,7 +35,10 @@ public:
     void update(float deltaTime, double mouseX, double mouseY, bool mousePressed);
     void render(VkCommandBuffer commandBuffer, uint32_t currentFrame);
     void initImGui(GLFWwindow* window, VkInstance instance, VkPhysicalDevice physicalDevice, 
-                   VkQueue graphicsQueue, uint32_t queueFamily, uint32_t imageCount);
+                   VkQueue graphicsQueue, uint32_t queueFamily, uint32_t imageCount,
+                   VkPipelineCache pipelineCache);
+    
+    void setGpuTimings(std::vector<GpuProfiler::ScopeStats> timings) { gpuTimings = std::move(timings); }
     
     void cleanup();
 
@@ -65,6 +70,9 @@ private:
     float textScale = 1.0f;
     float messageLifetime = 5.0f;
     
+    // Rolling GPU pass timings (ms), refreshed by the app
+    std::vector<GpuProfiler::ScopeStats> gpuTimings;
+    
     // 🎭 PERSONALITY MESSAGE LIBRARIES (like clippy2025.html)
     std::vector<std::vector<std::string>> personalityMessages = {
         // IDLE (0)
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Bvh.h"
+#include "ClippyGeometry.h"
+#include "RayPacketTracer.h"
+#include "RayQueue.h"
+#include "VulkanHelpers.h"
+#include "WideBvh.h"
+#include "WorkStealingPool.h"
+
+// Reference path tracer on the CPU: the fallback when the device has no ray tracing, and a
+// GPU-free way to render the same frames for comparison.
+//
+// It mirrors raygen.rgen, closesthit.rchit and miss.rmiss for the hero Clippy: same camera ray
+// and jitter, personality base colour and per-personality metal/roughness, GGX direct light,
+// reflection and GI bounces up to ubo.maxBounces, the procedural sky and sun, and the HDR running
+// average with ACES tone mapping. Only the rest pose is traced (the animated BLAS deformation is
+// not applied), and shadow rays are left out: on the GPU they never darken anything, because a
+// hit skips the closest-hit shader and leaves the payload at "unoccluded".
+//
+// The part instances are baked into one model-space triangle soup under a Bvh, traced through its
+// WideBvh collapse with the widest SIMD kernel the CPU has; rays are moved into model space with
+// the inverse of ubo.model, so the BVH is built once and not per frame. With packet tracing on
+// (the default), primary rays go through the same Bvh as 8x8 RayPacketTracer packets instead.
+// Image tiles are spread over a WorkStealingPool and write disjoint pixels only.
+//
+// With the wavefront on, bounces are not traced recursively from inside the shading of a hit.
+// Shading stops at its bounce rays (ShadePoint), which go into a RayQueue for the whole frame; the
+// queue is sorted by direction octant and origin, traced, and its hits compacted into the next
+// bounce's ShadePoints. Once a bounce spawns no rays, the points are finished deepest first, each
+// handing its colour to the point that spawned it. Both ways run the same shading code and render
+// the same image. The wavefront is off by default: the Clippy BVH is small enough to stay in cache,
+// and there the bounces of neighbouring pixels, traced recursively, are as coherent as a sorted queue.
+class CpuPathTracer {
+public:
+    static constexpr uint32_t TILE_SIZE = 16;
+
+    // threadCount 0 = one per hardware thread
+    explicit CpuPathTracer(uint32_t threadCount = 0);
+
+    CpuPathTracer(const CpuPathTracer&) = delete;
+    CpuPathTracer& operator=(const CpuPathTracer&) = delete;
+
+    // Same inputs as RayTracingPipeline::createAccelerationStructures (ClippyGeometry::generateClippyParts)
+    void setScene(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                  const std::vector<ClippyGeometry::Part>& parts,
+                  const std::vector<ClippyGeometry::PartInstance>& instances);
+
+    // Traces one frame. ubo.accumulationFrame == 0 (or a new size) restarts the running average.
+    void render(const UniformBufferObject& ubo, uint32_t width, uint32_t height);
+
+    // Primary rays as 8x8 packets (on) or one ray per pixel through the WideBvh (off)
+    void setPacketTracing(bool enabled) { packetTracing = enabled; }
+    // Bounces traced a frame-wide queue at a time (on) or recursively per pixel (off)
+    void setWavefront(bool enabled) { wavefront = enabled; }
+    // Sort each wavefront queue before it is traced
+    void setRaySorting(bool enabled) { raySorting = enabled; }
+
+    // Last wavefront render only
+    struct WavefrontStats {
+        uint64_t primaryRays = 0;
+        uint64_t secondaryRays = 0;      // Every bounce
+        uint32_t bounces = 0;            // Queues that were not empty
+        double sortMs = 0.0;
+        double secondaryTraceMs = 0.0;   // Tracing the queues, shading excluded
+    };
+    const WavefrontStats& getWavefrontStats() const { return wavefrontStats; }
+
+    // Tone mapped RGBA8, channels swapped to BGRA when the last ubo.isBGRFormat was set
+    // (byte-for-byte what the GPU path copies into the swapchain)
+    const std::vector<uint8_t>& getPixels() const { return pixels; }
+    uint32_t getWidth() const { return width; }
+    uint32_t getHeight() const { return height; }
+    bool writePPM(const std::string& path) const;
+
+    double getLastRenderMs() const { return lastRenderMs; }
+    uint32_t getThreadCount() const { return pool.getThreadCount(); }
+    const Bvh& getBvh() const { return bvh; }
+
+    // The default orbit camera and IDLE personality of ClippyRTXApp::updateUniformBuffer, for
+    // rendering without the app (accumulationFrame stays 0: every frame stands alone)
+    static UniformBufferObject defaultUniforms(float time, uint32_t frame, uint32_t width, uint32_t height);
+
+    // Single-threaded throughput of the default camera's primary rays and of shadow rays from their
+    // hits towards the sun: one ray at a time (scalar Bvh, WideBvh) against 8x8 packets, as JSON
+    static bool writePacketReport(const std::string& path, uint32_t width, uint32_t height);
+
+    // Multithreaded ms/frame and Mrays/s of the default camera at 2 and 4 bounces: recursive
+    // bounces against the wavefront with unsorted and with sorted queues, as JSON
+    static bool writeWavefrontReport(const std::string& path, uint32_t width, uint32_t height, uint32_t threadCount = 0);
+
+private:
+    enum RayType { RAY_PRIMARY = 0, RAY_REFLECTION = 1, RAY_GI = 3 };
+
+    // Per-render constants shared by every tile
+    struct Frame {
+        const UniformBufferObject* ubo;
+        glm::mat4 modelInverse;
+        bool resetHistory;
+    };
+
+    // closesthit.rchit cut at its bounce rays: what it computed before them, their directions,
+    // and the colours they bring back, for finishShade
+    struct ShadePoint {
+        glm::vec3 origin;
+        glm::vec3 worldPos;
+        glm::vec3 rayDir;
+        glm::vec3 surfaceNormal;
+        glm::vec3 albedo;
+        glm::vec3 directColor;           // GGX direct light and SSS
+        glm::vec3 reflectionDirection;
+        glm::vec3 giDirection;
+        glm::vec3 reflection;            // Filled by the bounces
+        glm::vec3 gi;
+        float metallic;
+        uint32_t rngState;               // Left for the volumetric samples
+        int depth;
+        bool tracesReflection;
+        bool tracesGi;
+        RayType type;                    // Of the ray that hit
+        uint32_t parent;                 // ShadePoint of the previous bounce, or the sample of a primary hit
+    };
+
+    // (x, y, sample, world origin, world direction, model-space hit of the primary ray)
+    using PrimaryVisitor = std::function<void(uint32_t, uint32_t, int, const glm::vec3&, const glm::vec3&, const Bvh::Hit&)>;
+
+    WorkStealingPool pool;
+    Bvh bvh;
+    WideBvh wideBvh;   // Traces bvh
+    RayPacketTracer packetTracer;   // Traces bvh
+    bool packetTracing = true;
+    bool wavefront = false;
+    bool raySorting = true;
+    std::vector<ClippyGeometry::PartMaterial> triangleMaterials;   // Per Bvh triangle
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    bool bgr = false;
+    std::vector<glm::vec4> accumulation;   // HDR running average, a = frames averaged
+    std::vector<uint8_t> pixels;
+    double lastRenderMs = 0.0;
+
+    // Wavefront state, kept between frames so the buffers are reused
+    std::vector<glm::vec3> sampleColors;                  // Per pixel and sample
+    std::vector<std::vector<ShadePoint>> workerPoints;    // Primary hits, per pool worker
+    std::vector<std::vector<ShadePoint>> bounces;         // Shaded hits per depth
+    RayQueue queue;
+    std::vector<Bvh::Hit> queueHits;
+    std::vector<uint32_t> chunkOffsets;
+    WavefrontStats wavefrontStats;
+
+    // raygen.rgen for one tile, bounces traced recursively
+    void renderTile(const Frame& frame, uint32_t tile, uint32_t tilesX);
+    void renderWavefront(const Frame& frame, uint32_t tilesX, uint32_t tilesY);
+    // Camera rays of one tile and their closest hits, sample by sample, in 8x8 packets or one at a time
+    void tracePrimaries(const Frame& frame, uint32_t tile, uint32_t tilesX, const PrimaryVisitor& visit) const;
+    // Queues the bounce rays of points and compacts their hits into next
+    void traceBounce(const Frame& frame, std::vector<ShadePoint>& points, std::vector<ShadePoint>& next);
+    // Running average, tone mapping and the RGBA8 store of one pixel
+    void resolvePixel(const Frame& frame, uint32_t x, uint32_t y, glm::vec3 color);
+    // traceRayEXT: closest hit shaded, or the miss shader
+    glm::vec3 trace(const Frame& frame, const glm::vec3& origin, const glm::vec3& direction,
+                    float tMin, float tMax, int depth, RayType rayType) const;
+    // closesthit.rchit, bounces traced recursively
+    glm::vec3 shade(const Frame& frame, const glm::vec3& origin, const glm::vec3& direction,
+                    float hitT, uint32_t triangle, int depth) const;
+    // closesthit.rchit up to its bounce rays; type and parent are left to the caller
+    void beginShade(const Frame& frame, const glm::vec3& origin, const glm::vec3& direction,
+                    float hitT, uint32_t triangle, int depth, ShadePoint& point) const;
+    // The rest of closesthit.rchit once point.reflection and point.gi are in
+    glm::vec3 finishShade(const Frame& frame, const ShadePoint& point) const;
+    // miss.rmiss
+    static glm::vec3 sky(const glm::vec3& direction, RayType rayType);
+};
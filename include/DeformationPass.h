@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+#include "UniformRing.h"
+#include "Vertex.h"
+
+// Compute pass that applies the personality vertex animation (same math as vertex.vert) to the
+// Clippy vertices and writes tightly packed positions into a device-local buffer. That buffer
+// is the vertex input of the animated BLAS, which RayTracingPipeline refits every frame.
+class DeformationPass {
+public:
+    // The position buffer starts out holding the rest pose, so the first BLAS build is valid
+    // before any deformation has run
+    DeformationPass(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue queue,
+                    VkBuffer sourceVertices, const std::vector<Vertex>& vertices,
+                    UniformRing& uniformRing, VkDeviceSize uniformRange, VkPipelineCache pipelineCache);
+    ~DeformationPass();
+
+    DeformationPass(const DeformationPass&) = delete;
+    DeformationPass& operator=(const DeformationPass&) = delete;
+
+    // Dispatches the deformation and makes the positions visible to acceleration structure builds
+    void record(VkCommandBuffer commandBuffer, uint32_t uniformOffset);
+
+    VkBuffer getPositionBuffer() const { return positionBuffer; }
+    static constexpr VkDeviceSize POSITION_STRIDE = 3 * sizeof(float);
+
+    // Upper bound of how far the animation moves any vertex from its rest position, used to
+    // decide when a refit has drifted too far and the BLAS needs a full rebuild
+    static float maxDisplacement(int personalityMode, float animationStrength, float glitchIntensity,
+                                 float boundingRadius);
+
+private:
+    VkDevice device;
+    uint32_t vertexCount;
+
+    VkBuffer positionBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory positionMemory = VK_NULL_HANDLE;
+
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+
+    void createDescriptors(VkBuffer sourceVertices, UniformRing& uniformRing, VkDeviceSize uniformRange);
+    void createPipeline(VkPipelineCache pipelineCache);
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// GPU timing per named scope, built on a VkQueryPool of timestamps.
+// Each frame in flight owns a slice of the pool. beginFrame() for a slot first collects the
+// results that slot recorded N frames ago (already complete: the frame timeline wait
+// happened), then resets the slice in the new command buffer - readback never stalls.
+class GpuProfiler {
+public:
+    struct ScopeStats {
+        std::string name;
+        double lastMs = 0.0;
+        double minMs = 0.0;
+        double avgMs = 0.0;
+        double p99Ms = 0.0;
+        uint32_t samples = 0;
+    };
+
+    GpuProfiler(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamily,
+                uint32_t framesInFlight, uint32_t maxScopesPerFrame = 16);
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    bool isSupported() const { return queryPool != VK_NULL_HANDLE; }
+
+    void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+    void beginScope(VkCommandBuffer commandBuffer, const char* name);
+    void endScope(VkCommandBuffer commandBuffer);
+
+    // Collects every outstanding slot; only after the device is idle (end of a run)
+    void collectAll();
+
+    // Every future sample of the scope is also appended to sink (nullptr stops it)
+    void captureScope(const char* name, std::vector<float>* sink);
+
+    // Rolling min/avg/p99 over the last HISTORY_SIZE samples of every scope
+    std::vector<ScopeStats> getStats() const;
+    bool writeCsv(const std::string& path) const;
+
+    // RAII helper for scopes that open and close in the same block
+    class Scope {
+    public:
+        Scope(GpuProfiler* profiler, VkCommandBuffer commandBuffer, const char* name)
+            : profiler(profiler), commandBuffer(commandBuffer) {
+            if (profiler) profiler->beginScope(commandBuffer, name);
+        }
+        ~Scope() {
+            if (profiler) profiler->endScope(commandBuffer);
+        }
+
+    private:
+        GpuProfiler* profiler;
+        VkCommandBuffer commandBuffer;
+    };
+
+private:
+    static constexpr size_t HISTORY_SIZE = 512;
+
+    struct RecordedScope {
+        uint32_t scopeId;
+        uint32_t beginQuery;
+        uint32_t endQuery;
+    };
+
+    struct FrameSlot {
+        std::vector<RecordedScope> scopes;
+        std::vector<size_t> openScopes;   // Indices into scopes (nesting stack)
+        uint32_t nextQuery = 0;
+        bool hasResults = false;
+    };
+
+    struct ScopeHistory {
+        std::string name;
+        std::vector<float> samplesMs;   // Ring buffer
+        size_t head = 0;
+        size_t count = 0;
+        double lastMs = 0.0;
+        std::vector<float>* capture = nullptr;
+    };
+
+    VkDevice device;
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    uint32_t queriesPerFrame;
+    double timestampPeriodNs = 1.0;
+    uint64_t timestampMask = ~0ull;
+
+    std::vector<FrameSlot> frames;
+    uint32_t currentSlot = 0;
+    std::vector<uint64_t> resultScratch;
+
+    std::unordered_map<std::string, uint32_t> scopeIds;
+    std::vector<ScopeHistory> history;
+
+    void collectResults(uint32_t frameIndex);
+    uint32_t scopeIdFor(const char* name);
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Hang detection for the frame timeline.
+// The render loop only records (timeline value, submit time) after each vkQueueSubmit;
+// a background thread polls the semaphore counter and warns when a submitted frame has
+// not completed within the timeout. Nothing here ever blocks the render loop.
+class GpuWatchdog {
+public:
+    GpuWatchdog(VkDevice device, VkSemaphore timeline, uint32_t timeoutMs = 2000);
+    ~GpuWatchdog();
+
+    GpuWatchdog(const GpuWatchdog&) = delete;
+    GpuWatchdog& operator=(const GpuWatchdog&) = delete;
+
+    void frameSubmitted(uint64_t timelineValue);
+    // Set once the timeline reports VK_ERROR_DEVICE_LOST; drawFrame stops the app on it
+    bool deviceLost() const { return lost.load(std::memory_order_relaxed); }
+
+private:
+    struct PendingSubmit {
+        uint64_t value;
+        std::chrono::steady_clock::time_point submitTime;
+    };
+
+    VkDevice device;
+    VkSemaphore timeline;
+    std::chrono::milliseconds timeout;
+
+    std::mutex pendingMutex;
+    std::deque<PendingSubmit> pending;
+
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> lost{false};
+    std::thread thread;
+
+    void run();
+};
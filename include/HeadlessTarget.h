@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Offscreen replacement for the swapchain when running without a window.
+// Owns one color image per frame in flight (used exactly like swapchain images by the
+// render passes and the RTX copy) plus a persistently mapped readback buffer per image.
+// A frame marked for saving is copied into its buffer at the end of the command buffer and
+// written to disk when its slot comes around again, so the render loop never waits on it.
+class HeadlessTarget {
+public:
+    HeadlessTarget(VkDevice device, VkPhysicalDevice physicalDevice, VkExtent2D extent, VkFormat format,
+                   uint32_t imageCount, const std::string& outputDir);
+    ~HeadlessTarget();
+
+    HeadlessTarget(const HeadlessTarget&) = delete;
+    HeadlessTarget& operator=(const HeadlessTarget&) = delete;
+
+    const std::vector<VkImage>& getImages() const { return images; }
+    VkFormat getFormat() const { return format; }
+    VkExtent2D getExtent() const { return extent; }
+
+    // Image must be in TRANSFER_SRC_OPTIMAL (the final layout of every pass in headless mode)
+    void recordReadback(VkCommandBuffer commandBuffer, uint32_t imageIndex, uint32_t frameNumber);
+
+    // Writes the pending frame of this image; only call once its GPU work has completed
+    void collect(uint32_t imageIndex);
+    void flush();
+
+private:
+    struct Readback {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        const uint8_t* mapped = nullptr;
+        bool pending = false;
+        uint32_t frameNumber = 0;
+    };
+
+    VkDevice device;
+    VkExtent2D extent;
+    VkFormat format;
+    std::string outputDir;
+
+    std::vector<VkImage> images;
+    std::vector<VkDeviceMemory> imageMemories;
+    std::vector<Readback> readbacks;
+
+    void writePPM(const Readback& readback) const;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Builds acceleration structures on the CPU (VK_ACCELERATION_STRUCTURE_BUILD_TYPE_HOST_KHR)
+// through VK_KHR_deferred_host_operations, leaving the queue free for rendering.
+//
+// submit() starts one deferred vkBuildAccelerationStructuresKHR per queued build and hands the
+// operations to a pool of worker threads that join them (vkDeferredOperationJoinKHR) until the
+// driver reports them done; wait() blocks until every worker has finished and checks the results.
+// Host builds need accelerationStructureHostCommands, host addresses for the geometry and
+// destination structures whose buffers are bound to host-visible memory.
+class HostAccelerationStructureBuilder {
+public:
+    // workerCount 0 = one per hardware thread
+    HostAccelerationStructureBuilder(VkDevice device, uint32_t workerCount = 0);
+    ~HostAccelerationStructureBuilder();
+
+    HostAccelerationStructureBuilder(const HostAccelerationStructureBuilder&) = delete;
+    HostAccelerationStructureBuilder& operator=(const HostAccelerationStructureBuilder&) = delete;
+
+    // accelerationStructureHostCommands (the device must also have it enabled)
+    static bool isSupported(VkPhysicalDevice physicalDevice);
+
+    // buildInfo.pGeometries (with host addresses) and ranges must stay valid until wait();
+    // host scratch memory is allocated here
+    void addBuild(const VkAccelerationStructureBuildGeometryInfoKHR& buildInfo,
+                  const VkAccelerationStructureBuildRangeInfoKHR* ranges, VkDeviceSize scratchSize);
+
+    // Starts the queued builds on the worker threads and returns immediately
+    void submit();
+    // Joins the workers; throws if a build failed
+    void wait();
+    void flush() { submit(); wait(); }
+    bool isBusy() const { return !inFlight.empty(); }
+
+    // Wall-clock time from the last submit() to the end of its builds
+    double getLastBuildMs() const { return lastBuildMs; }
+    uint32_t getWorkerCount() const { return workerCount; }
+
+private:
+    struct PendingBuild {
+        VkAccelerationStructureBuildGeometryInfoKHR buildInfo;
+        const VkAccelerationStructureBuildRangeInfoKHR* ranges;
+        std::vector<uint8_t> scratch;                 // Over-allocated for alignment
+        VkDeferredOperationKHR operation = VK_NULL_HANDLE;
+        VkResult result = VK_SUCCESS;                 // Of the initial call when not deferred
+    };
+
+    static constexpr size_t SCRATCH_ALIGNMENT = 256;
+
+    VkDevice device;
+    uint32_t workerCount;
+
+    std::vector<PendingBuild> pending;     // Queued for the next submit
+    std::vector<PendingBuild> inFlight;    // Owned by the workers until wait()
+    std::vector<std::thread> workers;
+    double lastBuildMs = 0.0;
+    std::chrono::high_resolution_clock::time_point submitStart;
+    std::vector<std::chrono::high_resolution_clock::time_point> workerFinish;   // One slot per worker
+
+    PFN_vkBuildAccelerationStructuresKHR vkBuildAccelerationStructuresKHR;
+    PFN_vkCreateDeferredOperationKHR vkCreateDeferredOperationKHR;
+    PFN_vkDestroyDeferredOperationKHR vkDestroyDeferredOperationKHR;
+    PFN_vkGetDeferredOperationMaxConcurrencyKHR vkGetDeferredOperationMaxConcurrencyKHR;
+    PFN_vkGetDeferredOperationResultKHR vkGetDeferredOperationResultKHR;
+    PFN_vkDeferredOperationJoinKHR vkDeferredOperationJoinKHR;
+
+    void joinOperations(uint32_t worker);
+};
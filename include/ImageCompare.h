@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-pixel comparison of rendered frames against a reference, for regression checks of the
+// shaders: RMSE and PSNR of the 8-bit values, and a FLIP-style perceptual error per pixel.
+//
+// The FLIP-style error follows NVIDIA's FLIP: both images go to the YCxCz opponent space, are
+// blurred by the contrast sensitivity of each channel at 67 pixels per degree (0.7 m from a 0.7 m
+// wide 4K monitor), and their colour difference (HyAB in L*a*b*, Hunt-adjusted) is compressed to
+// [0, 1]. Edges and points that differ in the luminance raise it further. 0 is identical, 1 is as
+// different as green and blue.
+//
+// The blurs are separable convolutions and take nearly all the time; they and the squared error
+// sum have AVX2 kernels, picked at runtime with WideBvh's CPU detection.
+class ImageCompare {
+public:
+    // 8-bit sRGB, 3 channels, top row first (the PPM frames HeadlessTarget and CpuPathTracer write)
+    struct Image {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> rgb;
+    };
+
+    struct Metrics {
+        double rmse = 0.0;       // Over every channel, in 8-bit steps
+        double psnr = 0.0;       // dB, capped at MAX_PSNR for identical images
+        double meanFlip = 0.0;
+        double maxFlip = 0.0;
+    };
+
+    // A frame fails below minPsnr or above maxMeanFlip
+    struct Thresholds {
+        double minPsnr = 30.0;
+        double maxMeanFlip = 0.05;
+    };
+
+    static constexpr double MAX_PSNR = 100.0;
+
+    static bool readPPM(const std::string& path, Image& image);
+    static bool writePPM(const std::string& path, const Image& image);
+
+    // reference and test must have the same size. diff (optional) gets |test - reference| per
+    // channel, amplified 4x; errorMap (optional) the FLIP-style error through a magma-like ramp.
+    static Metrics compare(const Image& reference, const Image& test, Image* diff = nullptr, Image* errorMap = nullptr);
+
+    // Every frame_*.ppm in testDir against the file of the same name in referenceDir: writes
+    // <frame>_diff.ppm and <frame>_flip.ppm to diffDir and the metrics per frame as JSON to
+    // reportPath. False if a frame has no reference, another size, or breaks a threshold.
+    static bool compareDirectories(const std::string& referenceDir, const std::string& testDir,
+                                   const std::string& diffDir, const std::string& reportPath,
+                                   const Thresholds& thresholds);
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+
+// The reports are written by hand with ofstream; strings that come from outside (device names,
+// file paths) go through quote so quotes, backslashes and control characters stay valid JSON.
+class Json {
+public:
+    // value as a JSON string literal, surrounding quotes included
+    static std::string quote(const std::string& value);
+};
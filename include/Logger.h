@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+
+// Minimum level compiled into the binary (0=trace, 1=debug, 2=info, 3=warn, 4=error).
+// Anything below it is discarded by `if constexpr`: the stream expression is never evaluated.
+#ifndef CLIPPY_LOG_LEVEL
+#define CLIPPY_LOG_LEVEL 2
+#endif
+
+enum class LogLevel : uint8_t {
+    Trace = 0,
+    Debug = 1,
+    Info = 2,
+    Warn = 3,
+    Error = 4
+};
+
+// Hot-path friendly logger.
+// Call sites format into a stack buffer and push the line into a fixed-size lock-free
+// ring; a background thread drains it to stdout/stderr. The render loop never blocks on
+// the terminal: if the ring is full the line is dropped and counted.
+class Logger {
+public:
+    static constexpr size_t MAX_LINE_LENGTH = 1008;
+
+    static void start();
+    static void shutdown();   // Drains everything still queued and joins the writer thread
+
+    static void setLevel(LogLevel level) {
+        runtimeLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+    static bool isEnabled(LogLevel level) {
+        return static_cast<int>(level) >= runtimeLevel.load(std::memory_order_relaxed);
+    }
+
+    static void push(LogLevel level, const char* text, size_t length);
+    static uint64_t droppedCount();
+
+    // One per call site (function-local static): lets a line through at most once per interval
+    class RateLimiter {
+    public:
+        explicit RateLimiter(uint32_t intervalMs);
+        bool allow(uint32_t& suppressedSinceLast);
+
+    private:
+        int64_t intervalNs;
+        std::atomic<int64_t> nextAllowedNs{0};
+        std::atomic<uint32_t> suppressed{0};
+    };
+
+    // Formats a single line without touching the heap; truncates at MAX_LINE_LENGTH
+    class Line {
+    public:
+        explicit Line(LogLevel level);
+        ~Line();
+
+        Line(const Line&) = delete;
+        Line& operator=(const Line&) = delete;
+
+        std::ostream& stream() { return out; }
+
+    private:
+        class FixedBuffer : public std::streambuf {
+        public:
+            FixedBuffer(char* begin, size_t size) { setp(begin, begin + size); }
+            size_t length() const { return static_cast<size_t>(pptr() - pbase()); }
+        };
+
+        LogLevel level;
+        char text[MAX_LINE_LENGTH];
+        FixedBuffer buffer;
+        std::ostream out;
+    };
+
+private:
+    static std::atomic<int> runtimeLevel;
+};
+
+#define CLIPPY_LOG_AT(level, ...)                                                   \
+    do {                                                                            \
+        if constexpr (static_cast<int>(level) >= CLIPPY_LOG_LEVEL) {                \
+            if (Logger::isEnabled(level)) {                                         \
+                Logger::Line clippyLogLine_(level);                                 \
+                clippyLogLine_.stream() << __VA_ARGS__;                             \
+            }                                                                       \
+        }                                                                           \
+    } while (0)
+
+#define CLIPPY_LOG_EVERY_MS(level, intervalMs, ...)                                 \
+    do {                                                                            \
+        if constexpr (static_cast<int>(level) >= CLIPPY_LOG_LEVEL) {                \
+            static Logger::RateLimiter clippyLogLimiter_(intervalMs);               \
+            uint32_t clippyLogSuppressed_ = 0;                                      \
+            if (Logger::isEnabled(level) &&                                         \
+                clippyLogLimiter_.allow(clippyLogSuppressed_)) {                    \
+                Logger::Line clippyLogLine_(level);                                 \
+                clippyLogLine_.stream() << __VA_ARGS__;                             \
+                if (clippyLogSuppressed_ > 0) {                                     \
+                    clippyLogLine_.stream() << " (+" << clippyLogSuppressed_        \
+                                            << " suppressed)";                      \
+                }                                                                   \
+            }                                                                       \
+        }                                                                           \
+    } while (0)
+
+#define LOG_TRACE(...) CLIPPY_LOG_AT(LogLevel::Trace, __VA_ARGS__)
+#define LOG_DEBUG(...) CLIPPY_LOG_AT(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...)  CLIPPY_LOG_AT(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARN(...)  CLIPPY_LOG_AT(LogLevel::Warn, __VA_ARGS__)
+#define LOG_ERROR(...) CLIPPY_LOG_AT(LogLevel::Error, __VA_ARGS__)
+
+// Rate-limited variants for anything that can fire every frame
+#define LOG_DEBUG_EVERY_MS(intervalMs, ...) CLIPPY_LOG_EVERY_MS(LogLevel::Debug, intervalMs, __VA_ARGS__)
+#define LOG_INFO_EVERY_MS(intervalMs, ...)  CLIPPY_LOG_EVERY_MS(LogLevel::Info, intervalMs, __VA_ARGS__)
+#define LOG_WARN_EVERY_MS(intervalMs, ...)  CLIPPY_LOG_EVERY_MS(LogLevel::Warn, intervalMs, __VA_ARGS__)
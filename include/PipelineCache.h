@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+
+// One VkPipelineCache shared by every pipeline (raster, ray tracing, post-process, ImGui),
+// persisted between runs so the driver can skip recompiling SPIR-V on warm starts.
+//
+// On-disk layout: a small header of our own (magic, format version, vendor/device IDs,
+// driver version, pipelineCacheUUID, blob size) followed by the raw vkGetPipelineCacheData
+// blob. A blob from another GPU or driver is discarded instead of being handed to the driver.
+class PipelineCache {
+public:
+    PipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& path);
+    ~PipelineCache();
+
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+
+    VkPipelineCache get() const { return cache; }
+    bool wasLoaded() const { return loaded; }
+
+    // Writes the merged cache back to disk (temp file + rename, so a crash never leaves a torn file)
+    bool save() const;
+
+private:
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+        uint64_t dataSize;
+    };
+
+    static constexpr uint32_t FILE_MAGIC = 0x43505243;   // "CRPC"
+    static constexpr uint32_t FILE_VERSION = 1;
+
+    VkDevice device;
+    VkPhysicalDeviceProperties properties{};
+    std::string path;
+    VkPipelineCache cache = VK_NULL_HANDLE;
+    bool loaded = false;
+
+    bool loadBlob(std::string& blob) const;
+    bool matchesDevice(const FileHeader& header) const;
+};
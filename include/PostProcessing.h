@@ -5,6 +5,8 @@
 #include <vector>
 #include <string>
 
+#include "UniformRing.h"
+
 class PostProcessing {
 public:
     struct PostProcessUniforms {
@@ -26,7 +28,8 @@ public:
         int enableFilmGrain;
     };
 
-    PostProcessing(VkDevice device, VkPhysicalDevice physicalDevice, VkRenderPass renderPass, VkExtent2D extent);
+    PostProcessing(VkDevice device, VkPhysicalDevice physicalDevice, VkRenderPass renderPass, VkExtent2D extent,
+                   uint32_t framesInFlight, UniformRing& uniformRing, VkPipelineCache pipelineCache);
     ~PostProcessing();
 
     void cleanup();
@@ -59,6 +62,8 @@ private:
     VkPhysicalDevice physicalDevice;
     VkRenderPass renderPass;
     VkExtent2D extent;
+    uint32_t framesInFlight;
+    VkPipelineCache pipelineCache;
     
     PostProcessUniforms uniforms;
     
@@ -69,10 +74,9 @@ private:
     VkDescriptorPool descriptorPool;
     std::vector<VkDescriptorSet> descriptorSets;
     
-    // Uniform buffers
-    std::vector<VkBuffer> uniformBuffers;
-    std::vector<VkDeviceMemory> uniformBuffersMemory;
-    std::vector<void*> uniformBuffersMapped;
+    // Uniforms live in the app's shared ring (dynamic offset per frame)
+    UniformRing& uniformRing;
+    UniformRing::BlockHandle uniformBlock;
     
     // Post-process render targets
     VkImage postProcessImage;
@@ -93,7 +97,6 @@ private:
     void createDescriptorSetLayout();
     void createDescriptorPool();
     void createDescriptorSets();
-    void createUniformBuffers();
     void createSamplers();
     void createBloomResources();
     void updateDescriptorSet(uint32_t currentFrame, VkImageView sourceImageView);
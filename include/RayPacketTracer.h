@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Bvh.h"
+
+// 8x8 ray packets traced together through a Bvh, for coherent rays: camera rays of a pixel block,
+// or shadow rays of that block towards the one directional light.
+//
+// Each node is first tested against the packet's frustum (interval bounds of the origins and
+// inverse directions, valid while every ray points the same way per axis): a miss culls the node
+// for all 64 rays at once, which is how most sky blocks end after the root. Otherwise each active
+// ray is slab tested and the hit mask goes down. When fewer than half the rays of a packet still
+// hit, it splits into its four 4x4 sub-packets, each with its own tighter frustum; a sub-packet
+// that diverges again finishes the subtree one ray at a time. Leaf triangles are set up once and
+// tested against every active ray.
+//
+// Ray i of the packet is rayIndex(x, y) of its pixel: sub-packet q owns rays [16q, 16q + 16).
+class RayPacketTracer {
+public:
+    static constexpr uint32_t PACKET_WIDTH = 8;
+    static constexpr uint32_t PACKET_SIZE = PACKET_WIDTH * PACKET_WIDTH;
+    static constexpr uint32_t QUAD_SIZE = PACKET_SIZE / 4;
+
+    // Rays as structure-of-arrays; only the rays in activeMask are traced
+    struct Packet {
+        float originX[PACKET_SIZE], originY[PACKET_SIZE], originZ[PACKET_SIZE];
+        float directionX[PACKET_SIZE], directionY[PACKET_SIZE], directionZ[PACKET_SIZE];
+        float tMax[PACKET_SIZE];
+        uint64_t activeMask = 0;
+
+        void setRay(uint32_t index, const Bvh::Ray& ray);
+    };
+
+    // Optional counters, summed over calls
+    struct Stats {
+        uint64_t nodeVisits = 0;
+        uint64_t frustumCulls = 0;   // Nodes rejected for a whole (sub-)packet by the frustum alone
+        uint64_t splits = 0;         // Packets split into 4x4 sub-packets
+        uint64_t singleRays = 0;     // Subtrees finished one ray at a time
+    };
+
+    static uint32_t rayIndex(uint32_t x, uint32_t y) {
+        return ((y / 4) * 2 + x / 4) * QUAD_SIZE + (y % 4) * 4 + x % 4;
+    }
+
+    // bvh must outlive the tracer; it may be rebuilt in place
+    explicit RayPacketTracer(const Bvh& source) : bvh(source) {}
+
+    // Closest hit per active ray, same contract as Bvh::intersect (hits[i].t also bounds ray i)
+    void intersect(const Packet& packet, Bvh::Hit hits[PACKET_SIZE], Stats* stats = nullptr) const;
+
+    // Any-hit: the mask of active rays blocked before their tMax. Stops at the first hit per ray.
+    uint64_t occluded(const Packet& packet, Stats* stats = nullptr) const;
+
+    // Single-ray any-hit query, the scalar counterpart of the packet one
+    bool occluded(const Bvh::Ray& ray) const;
+
+private:
+    // Per level a packet pops one entry and pushes two; a split adds four sub-packets once. Both
+    // stay within this on a tree capped at Bvh::MAX_DEPTH.
+    static constexpr uint32_t STACK_SIZE = 2 * Bvh::MAX_DEPTH + 8;
+
+    // Frustum of a packet (group 0) or of a sub-packet (groups 1-4)
+    struct Frustum {
+        float originMin[3], originMax[3];
+        float inverseMin[3], inverseMax[3];
+        bool positive[3];
+        float tMax;
+        bool valid;
+    };
+
+    // Per-query state: the packet with inverse directions, the closest hit so far per ray
+    struct Query {
+        const Packet* packet;
+        float inverseX[PACKET_SIZE], inverseY[PACKET_SIZE], inverseZ[PACKET_SIZE];
+        bool inversesReady;          // Filled on the first per-ray test
+        float closest[PACKET_SIZE];
+        Frustum frusta[5];
+        bool quadFrustaReady;        // Built on the first split
+        Bvh::Hit* hits;              // nullptr for any-hit queries
+        uint64_t occludedMask;
+        Stats* stats;
+    };
+
+    const Bvh& bvh;
+
+    void prepare(Query& query, const Packet& packet) const;
+    void buildFrustum(Query& query, uint32_t group) const;
+    void prepareInverses(Query& query) const;
+    void traverse(Query& query) const;
+    uint64_t intersectBoundsMask(const Query& query, const Bvh::Node& node, uint32_t group, uint64_t mask) const;
+    void intersectLeaf(Query& query, const Bvh::Node& node, uint64_t mask) const;
+    void traceRay(Query& query, uint32_t startNode, uint32_t ray) const;
+};
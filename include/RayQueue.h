@@ -0,0 +1,63 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "Bvh.h"
+#include "WorkStealingPool.h"
+
+// Wavefront queue of the rays of one bounce, traced together once every hit of the previous
+// bounce has been shaded.
+//
+// Reflection and GI rays leave the surface in all directions, so in the order they are spawned
+// neighbouring rays touch unrelated parts of the BVH. sort() reorders the queue by a 32-bit key:
+// the direction octant in the top bits, then the Morton code of the origin inside the scene
+// bounds, so rays that start close together and head the same way are traced one after another
+// and find the nodes they need still in cache. It is an LSD radix sort of (key, index) pairs,
+// 8 bits per pass, each pass a parallel per-chunk histogram and a stable per-chunk scatter; the
+// entries themselves are moved once, at the end.
+class RayQueue {
+public:
+    static constexpr uint32_t CHUNK_SIZE = 4096;   // Entries per pool task
+    static constexpr uint32_t MORTON_BITS = 27;     // 9 per axis
+    static constexpr uint32_t KEY_BITS = MORTON_BITS + 3;
+
+    struct Entry {
+        Bvh::Ray ray;          // What gets traced
+        glm::vec3 origin;      // The caller's own copy of the ray, e.g. in world space
+        glm::vec3 direction;
+        uint32_t parent;       // The caller's record that spawned the ray
+        uint32_t type;
+    };
+
+    static uint32_t chunkCount(uint32_t count) { return (count + CHUNK_SIZE - 1) / CHUNK_SIZE; }
+
+    // Morton cells per unit of length along each axis of [boundsMin, boundsMax]
+    static glm::vec3 cellScale(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+    // Octant of ray.direction (negative x, y, z from the high bit down) over the Morton code of
+    // ray.origin, clamped to the bounds
+    static uint32_t sortKey(const Bvh::Ray& ray, const glm::vec3& boundsMin, const glm::vec3& scale);
+
+    void resize(uint32_t count) { entries.resize(count); }
+    uint32_t size() const { return static_cast<uint32_t>(entries.size()); }
+    Entry& operator[](uint32_t index) { return entries[index]; }
+    const Entry& operator[](uint32_t index) const { return entries[index]; }
+
+    // Stable sort by sortKey, keys computed and entries moved on the pool
+    void sort(WorkStealingPool& pool, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
+private:
+    static constexpr uint32_t RADIX = 256;
+
+    struct SortItem {
+        uint32_t key;
+        uint32_t index;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<Entry> sortedEntries;      // Kept between sorts, like the buffers below
+    std::vector<SortItem> items;
+    std::vector<SortItem> sortedItems;
+    std::vector<uint32_t> histograms;      // RADIX counters per chunk, then their scatter offsets
+};
@@ -1,8 +1,17 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
 #include <vector>
 #include <string>
+#include <memory>
+
+#include "TileScheduler.h"
+#include "AccelerationStructureBuilder.h"
+#include "HostAccelerationStructureBuilder.h"
+#include "ClippyGeometry.h"
+#include "AccelerationStructureCache.h"
+#include "WorkStealingPool.h"
 
 class RayTracingPipeline {
 public:
@@ -10,17 +19,97 @@ public:
                        VkCommandPool commandPool, VkQueue graphicsQueue);
     ~RayTracingPipeline();
     
-    void createPipeline(VkDescriptorSetLayout descriptorSetLayout);
+    void createPipeline(VkDescriptorSetLayout descriptorSetLayout, VkPipelineCache pipelineCache);
     void createShaderBindingTable();
+    // One BLAS per part (subranges of the shared vertex/index buffers, all built in one batch)
+    // and one TLAS instance per part instance. The instance material goes into
+    // instanceCustomIndex for closesthit.
     void createAccelerationStructures(VkBuffer vertexBuffer, VkBuffer indexBuffer,
-                                     uint32_t vertexCount, uint32_t indexCount);
+                                     const std::vector<ClippyGeometry::Part>& parts,
+                                     const std::vector<ClippyGeometry::PartInstance>& instances);
+    
+    // Build the static BLASes with ALLOW_COMPACTION and copy them into right-sized buffers
+    // (default on).
+    // Must be set before createAccelerationStructures.
+    void setBLASCompaction(bool enabled) { compactBLAS = enabled; }
+    
+    // Static BLASes are deserialized from the cache when it holds a compatible copy and
+    // serialized into it after a fresh build (the animated BLAS is always built).
+    // Must be set before createAccelerationStructures.
+    void setAccelerationStructureCache(AccelerationStructureCache* cache) { asCache = cache; }
+    
+    // Static BLASes that miss the cache are built on the CPU by a worker pool (deferred host
+    // operations) instead of on the queue. vertices/indices are host copies of the buffers
+    // passed to createAccelerationStructures and must outlive it. Only call this when the device
+    // was created with accelerationStructureHostCommands.
+    // Must be set before createAccelerationStructures.
+    void setHostBuilds(const std::vector<Vertex>* vertices, const std::vector<uint32_t>* indices);
+    
+    // Inspection: time every device build with its own GPU timestamps (builds in a batch then
+    // run one after another).
+    // Must be set before createAccelerationStructures.
+    void setBuildTimestamps(bool enabled) { asBuilder->setPerBuildTimestamps(enabled); }
+    
+    // What createAccelerationStructures produced: one entry per BLAS (in part order), then the TLAS
+    struct AccelerationStructureStats {
+        std::string name;
+        bool topLevel = false;
+        const char* source = "device";     // "device", "host" or "cache"
+        uint32_t primitiveCount = 0;       // Triangles, or instances for the TLAS
+        uint32_t degenerateTriangles = 0;
+        VkDeviceSize buildSize = 0;        // As built (worst case)
+        VkDeviceSize finalSize = 0;        // After compaction; == buildSize when not compacted
+        VkDeviceSize buildScratchSize = 0;
+        VkDeviceSize updateScratchSize = 0;
+        double buildMs = -1.0;             // GPU timestamps; < 0 when not measured
+    };
+    const std::vector<AccelerationStructureStats>& getAccelerationStructureStats() const { return asStats; }
+    
+    // Animated BLAS for one part: built from tightly packed deformed positions (the part's
+    // vertices only) with ALLOW_UPDATE, refit every frame by recordGeometryUpdate and fully
+    // rebuilt every rebuildInterval frames. That part is not compacted.
+    // Must be set before createAccelerationStructures.
+    void setAnimatedGeometry(uint32_t part, VkBuffer positionBuffer, VkDeviceSize positionStride,
+                             uint32_t rebuildInterval);
+    
+    // Refits (or rebuilds) the animated BLAS from the current positions. Must be followed by
+    // recordInstanceUpdate so the TLAS picks up the new bounds.
+    // Returns true when this frame did a full BLAS rebuild.
+    bool recordGeometryUpdate(VkCommandBuffer commandBuffer, bool forceRebuild);
+    bool hasAnimatedGeometry() const { return animatedPositionBuffer != VK_NULL_HANDLE; }
+    
+    // The instance buffer is persistently mapped with one copy of the instances per frame slot,
+    // so the CPU never writes a transform the GPU may still be reading.
+    // Must be set before createAccelerationStructures.
+    void setInstanceSlots(uint32_t slots) { instanceSlots = slots > 0 ? slots : 1; }
+    
+    // Crowd mode: count Clippies in one TLAS (the hero plus count-1 procedurally placed ones,
+    // up to MAX_CROWD_SIZE). Each Clippy is one TLAS instance per part instance; crowd members
+    // get their own personality, tint and mask bit.
+    // Must be set before createAccelerationStructures.
+    void setCrowdSize(uint32_t count);
+    static constexpr uint32_t MAX_CROWD_SIZE = 100000;
+    
+    // Writes model * part transform into this slot's instances (crowd members add their own
+    // placement and bob) and refits the TLAS (MODE_UPDATE) on the frame's command buffer: moving
+    // Clippy costs the instance writes, no BLAS work. Large crowds are filled on several threads.
+    void recordInstanceUpdate(VkCommandBuffer commandBuffer, uint32_t frameSlot, const glm::mat4& transform,
+                              float time);
+    
+    // Per-TLAS-instance shading data for closesthit, indexed by gl_InstanceCustomIndexEXT
+    VkBuffer getInstanceShadingBuffer() const { return instanceShadingBuffer; }
+    uint32_t getInstanceCount() const { return tlasInstanceCount; }
+    double getTLASBuildMs() const { return tlasBuildMs; }            // Initial build, GPU time
+    double getLastInstanceFillMs() const { return lastInstanceFillMs; }
     
     VkPipeline getPipeline() const { return pipeline; }
     VkPipelineLayout getPipelineLayout() const { return pipelineLayout; }
     
     VkAccelerationStructureKHR getTopLevelAS() const { return topLevelAS; }
     
-    void traceRays(VkCommandBuffer commandBuffer, uint32_t width, uint32_t height, VkDescriptorSet descriptorSet);
+    // One vkCmdTraceRaysKHR per tile; raygen gets the tile origin through push constants
+    void traceRays(VkCommandBuffer commandBuffer, uint32_t width, uint32_t height, VkDescriptorSet descriptorSet,
+                   uint32_t uniformOffset, const std::vector<TileScheduler::Tile>& tiles);
     
 private:
     VkDevice device;
@@ -30,14 +119,90 @@ private:
     VkPipeline pipeline;
     VkPipelineLayout pipelineLayout;
     
+    // Matches the push_constant block in raygen.rgen
+    struct RaygenPushConstants {
+        int32_t tileOffset[2];    // Tile origin in the full image
+        int32_t imageSize[2];     // Full image size (gl_LaunchSizeEXT is only the tile)
+        int32_t resetHistory;     // 1 = discard the accumulated average for this tile
+    };
+    
+    // One per ClippyGeometry part; geometry and range are kept for the batched build and refits
+    struct BottomLevel {
+        std::string name;
+        VkAccelerationStructureKHR handle = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+        VkAccelerationStructureGeometryKHR geometry{};
+        VkAccelerationStructureBuildRangeInfoKHR range{};
+        uint64_t cacheKey = 0;      // Non-zero when the BLAS goes through the cache
+        bool fromCache = false;
+        bool hostBuilt = false;     // Host-visible memory until compacted or cloned to the device
+    };
+    
     // Acceleration structures
-    VkAccelerationStructureKHR bottomLevelAS;
+    std::vector<BottomLevel> bottomLevels;
     VkAccelerationStructureKHR topLevelAS;
-    VkBuffer bottomLevelASBuffer;
-    VkDeviceMemory bottomLevelASMemory;
+    bool compactBLAS = true;
+    AccelerationStructureCache* asCache = nullptr;
+    
+    std::vector<AccelerationStructureStats> asStats;
+    
+    // Host builds (null when the BLASes are built on the device)
+    std::unique_ptr<HostAccelerationStructureBuilder> hostBuilder;
+    const std::vector<Vertex>* hostVertices = nullptr;
+    const std::vector<uint32_t>* hostIndices = nullptr;
+    
+    // Animated BLAS state, kept for the per-frame refits
+    uint32_t animatedPart = 0;
+    VkBuffer animatedPositionBuffer = VK_NULL_HANDLE;
+    VkDeviceSize animatedPositionStride = 0;
+    uint32_t blasRebuildInterval = 0;
+    uint32_t framesSinceBLASBuild = 0;
+    
+    // Updatable TLAS state
+    VkAccelerationStructureGeometryKHR tlasGeometry{};
+    uint32_t tlasInstanceCount = 0;
+    uint32_t instanceSlots = 1;
+    VkBuffer instanceBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory instanceBufferMemory = VK_NULL_HANDLE;
+    VkAccelerationStructureInstanceKHR* instanceData = nullptr;   // Persistently mapped
+    std::vector<glm::mat4> instanceLocalTransforms;               // Part transform per instance
+    double tlasBuildMs = 0.0;
+    double lastInstanceFillMs = 0.0;
+    
+    // Crowd layout; member 0 is the hero. TLAS instance = member * instancesPerClippy + part instance.
+    struct CrowdMember {
+        glm::vec3 position{0.0f};
+        float yaw = 0.0f;
+        float phase = 0.0f;          // Bob animation offset
+        int32_t personality = 0;
+    };
+    static constexpr uint32_t PERSONALITY_COUNT = 6;
+    static constexpr uint8_t MASK_HERO = 0x01;
+    static constexpr uint8_t MASK_CROWD = 0x02;   // Shifted left by the member's personality
+    static constexpr uint32_t PARALLEL_FILL_MIN_MEMBERS = 2048;
+    static constexpr uint32_t FILL_CHUNK_MEMBERS = 512;   // Members per fill task
+    uint32_t crowdSize = 1;
+    uint32_t instancesPerClippy = 0;
+    std::vector<CrowdMember> crowd;
+    std::unique_ptr<WorkStealingPool> fillPool;   // Crowds of PARALLEL_FILL_MIN_MEMBERS and up; created once
+    
+    // Matches InstanceShading in closesthit.rchit (std430)
+    struct InstanceShading {
+        glm::vec4 tint{1.0f, 1.0f, 1.0f, 0.0f};   // a = blend over the personality base colour
+        uint32_t material = 0;                     // ClippyGeometry::PartMaterial
+        int32_t personalityMode = -1;              // -1 = the UBO personality (hero)
+        uint32_t padding[2] = {0, 0};
+    };
+    VkBuffer instanceShadingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory instanceShadingMemory = VK_NULL_HANDLE;
     VkBuffer topLevelASBuffer;
     VkDeviceMemory topLevelASMemory;
     
+    // Batches the one-time builds; its scratch arena also backs the per-frame refits
+    std::unique_ptr<AccelerationStructureBuilder> asBuilder;
+    
     // Shader binding table
     VkBuffer shaderBindingTableBuffer;
     VkDeviceMemory shaderBindingTableMemory;
@@ -57,13 +222,19 @@ private:
     PFN_vkGetAccelerationStructureDeviceAddressKHR vkGetAccelerationStructureDeviceAddressKHR;
     
     void loadRayTracingFunctions();
+    void layoutCrowd();
+    void fillInstances(VkAccelerationStructureInstanceKHR* slotInstances, const glm::mat4& model, float time) const;
+    void fillInstanceRange(VkAccelerationStructureInstanceKHR* slotInstances, const glm::mat4& model, float time,
+                           uint32_t firstMember, uint32_t endMember) const;
+    void createInstanceShadingBuffer(const std::vector<ClippyGeometry::PartInstance>& instances);
+    bool loadCachedBottomLevel(BottomLevel& blas);
+    void storeBottomLevelsInCache();
+    void compactBottomLevelAS(BottomLevel& blas, VkQueryPool compactedSizeQuery, uint32_t query);
+    // Queues a copy of blas into a new device-local structure of size bytes and swaps it in
+    void copyBottomLevelAS(BottomLevel& blas, VkDeviceSize size, VkCopyAccelerationStructureModeKHR mode);
     VkDeviceAddress getBufferDeviceAddress(VkBuffer buffer);
     VkDeviceAddress getAccelerationStructureDeviceAddress(VkAccelerationStructureKHR as);
     
-    // Command buffer helpers for building BLAS
-    VkCommandBuffer beginSingleTimeCommands();
-    void endSingleTimeCommands(VkCommandBuffer commandBuffer);
-    
     VkShaderModule createShaderModule(const std::vector<char>& code);
     std::vector<char> readFile(const std::string& filename);
 };
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+// Splits the ray tracing launch into tiles so a single submit never has to trace the whole image.
+// Tiles are grouped into batches, one batch per frame. Each submit then carries a bounded amount
+// of work, so long renders (high resolution, many bounces or spp) stay under the driver watchdog.
+// At the start of every pass the tiles are re-costed against the screen region where rays are
+// expected to hit geometry. They are then balanced across batches (largest cost first), and each
+// batch is traced most expensive first.
+class TileScheduler {
+public:
+    struct Tile {
+        uint32_t x = 0, y = 0, width = 0, height = 0;
+        float cost = 1.0f;
+        bool resetHistory = true;   // First trace since accumulation restarted: drop the old average
+    };
+
+    // tileSize 0 = one tile covering the whole extent; tilesPerFrame 0 = every tile every frame.
+    // No-op when nothing changed, so it can be called every frame.
+    void configure(VkExtent2D extent, uint32_t tileSize, uint32_t tilesPerFrame);
+
+    // Pixel rectangle where rays are expected to hit geometry. Tiles overlapping it cost up to
+    // 1 + hitCostFactor times a tile of pure misses.
+    void setHotRegion(float minX, float minY, float maxX, float maxY, float hitCostFactor);
+
+    // Every tile drops its accumulation history the next time it is traced
+    void restartAccumulation();
+
+    // Tiles to trace this frame, most expensive first
+    const std::vector<Tile>& nextBatch();
+
+    bool isTiled() const { return tiles.size() > 1; }
+    uint32_t getBatchCount() const { return batchCount; }
+    uint64_t averagePixelsPerBatch() const;
+
+private:
+    VkExtent2D extent{0, 0};
+    uint32_t tileSize = 0;
+    uint32_t tilesPerFrame = 0;
+    uint32_t batchCount = 1;
+
+    float hotMinX = 0.0f, hotMinY = 0.0f, hotMaxX = 0.0f, hotMaxY = 0.0f;
+    float hitCostFactor = 0.0f;
+
+    std::vector<Tile> tiles;
+    std::vector<std::vector<uint32_t>> batches;   // Tile indices per batch
+    uint32_t nextBatchIndex = 0;
+    std::vector<Tile> currentBatch;
+
+    void buildTiles();
+    void buildBatches();
+    float estimateCost(const Tile& tile) const;
+};
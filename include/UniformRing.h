@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <cstdint>
+
+// Persistently mapped uniform memory shared by every pass.
+// One host-visible buffer is split into one region per frame in flight. Passes reserve a
+// block once (same relative offset in every region) and address it with a dynamic offset
+// at bind time, so descriptors never need rewriting. Writes go through a per-frame shadow
+// copy: a block whose contents did not change since that region was last written is skipped.
+class UniformRing {
+public:
+    using BlockHandle = uint32_t;
+
+    UniformRing(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t framesInFlight,
+                VkDeviceSize bytesPerFrame = 64 * 1024);
+    ~UniformRing();
+
+    UniformRing(const UniformRing&) = delete;
+    UniformRing& operator=(const UniformRing&) = delete;
+
+    // Persistent blocks - reserve during setup, before the first frame
+    BlockHandle allocateBlock(VkDeviceSize size);
+    bool write(BlockHandle block, uint32_t frameIndex, const void* data, VkDeviceSize size);
+    uint32_t dynamicOffset(BlockHandle block, uint32_t frameIndex) const;
+    VkDeviceSize blockSize(BlockHandle block) const { return blocks[block].size; }
+
+    VkBuffer getBuffer() const { return buffer; }
+
+private:
+    struct Block {
+        VkDeviceSize offset;   // Relative to the start of a frame region
+        VkDeviceSize size;
+    };
+
+    VkDevice device;
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    uint8_t* mapped = nullptr;
+
+    uint32_t framesInFlight;
+    VkDeviceSize alignment;
+    VkDeviceSize frameStride;
+    VkDeviceSize persistentEnd = 0;
+
+    std::vector<Block> blocks;
+    std::vector<std::vector<uint8_t>> shadows;   // Last contents written to each frame region
+    std::vector<std::vector<bool>> written;      // Whether a block was ever written per frame
+
+    VkDeviceSize alignUp(VkDeviceSize value) const { return (value + alignment - 1) & ~(alignment - 1); }
+};
@@ -38,6 +38,7 @@ struct UniformBufferObject {
     alignas(16) glm::vec3 personalityColorB; // Dynamic color B for personality modes
     alignas(4) float holographicStrength;  // Holographic scan effect intensity
     alignas(4) float glitchIntensity;      // Quantum glitch effect strength
+    alignas(4) int accumulationFrame;      // Frames since accumulation restarted (0 = restart)
 };
 
 // Material PBR para Clippy
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Bvh.h"
+
+// 4-wide (SSE) and 8-wide (AVX2) collapse of a binary Bvh for SIMD ray traversal.
+//
+// Every wide node stores the bounds of its children as structure-of-arrays (all min x, then all
+// min y, ...), so a single slab test checks every child against the ray at once. Leaves point at
+// packets of triangles kept as v0 / edge1 / edge2, again one array per component, so Möller-
+// Trumbore runs on a full register of triangles; unused lanes are zero-area and never hit.
+//
+// The kernel is chosen at runtime (detectIsa): the AVX2 one is compiled for that ISA only, the
+// rest of the binary keeps the baseline target. On other architectures the scalar Bvh is used.
+class WideBvh {
+public:
+    enum class Isa {
+        Scalar,   // Bvh::intersect
+        Sse,      // 4 lanes
+        Avx2      // 8 lanes
+    };
+
+    // Widest kernel the CPU and OS support
+    static Isa detectIsa();
+    static bool isSupported(Isa isa);
+    static const char* isaName(Isa isa);
+    static uint32_t laneCount(Isa isa);
+
+    // Collapses bvh, which must outlive this object (the scalar path traces it directly).
+    // Leaves of up to laneCount(isa) triangles fill exactly one packet.
+    void build(const Bvh& bvh, Isa isa);
+
+    // Same contract as Bvh::intersect: closest hit, triangle = index into the source triangles
+    bool intersect(const Bvh::Ray& ray, Bvh::Hit& hit) const;
+
+    Isa getIsa() const { return isa; }
+    size_t getNodeCount() const;
+    size_t getPacketCount() const;
+
+    // Single-threaded microbenchmark on the mesh: for each supported kernel, builds the tree and
+    // traces coherent (pinhole camera) and incoherent (random) rays, then writes Mrays/s per core
+    // and the hits that disagree with the scalar Bvh as JSON
+    static bool writeTraversalReport(const std::string& path, const std::vector<Vertex>& vertices,
+                                     const std::vector<uint32_t>& indices, uint32_t rayCount = 1u << 20);
+
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+    // Each wide level pops one node and pushes at most W, and a wide tree is no deeper than the
+    // Bvh it collapses (Bvh::MAX_DEPTH), so the stack cannot overflow
+    static constexpr uint32_t STACK_SIZE = (8 - 1) * Bvh::MAX_DEPTH + 1;
+
+    // child is a node index, or the first triangle packet when packetCount > 0; empty lanes have
+    // inverted bounds (+inf min, -inf max), which the near/far plane slab test always rejects
+    template <int W>
+    struct alignas(64) Node {
+        float minX[W], minY[W], minZ[W];
+        float maxX[W], maxY[W], maxZ[W];
+        uint32_t child[W];
+        uint32_t packetCount[W];
+    };
+
+    template <int W>
+    struct alignas(32) TrianglePacket {
+        float v0x[W], v0y[W], v0z[W];
+        float e1x[W], e1y[W], e1z[W];
+        float e2x[W], e2y[W], e2z[W];
+        uint32_t triangle[W];   // EMPTY for padding lanes
+    };
+
+    Isa isa = Isa::Scalar;
+    const Bvh* source = nullptr;
+
+    std::vector<Node<4>, Bvh::CacheAlignedAllocator<Node<4>>> nodes4;
+    std::vector<TrianglePacket<4>, Bvh::CacheAlignedAllocator<TrianglePacket<4>>> packets4;
+    std::vector<Node<8>, Bvh::CacheAlignedAllocator<Node<8>>> nodes8;
+    std::vector<TrianglePacket<8>, Bvh::CacheAlignedAllocator<TrianglePacket<8>>> packets8;
+
+    template <int W, typename NodeVector, typename PacketVector>
+    uint32_t collapse(uint32_t binaryNode, NodeVector& nodes, PacketVector& packets) const;
+
+    bool intersect4(const Bvh::Ray& ray, Bvh::Hit& hit) const;
+    bool intersect8(const Bvh::Ray& ray, Bvh::Hit& hit) const;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of persistent threads running blocking parallel-for batches.
+//
+// run() deals the task indices out in contiguous blocks, one deque per participant (the calling
+// thread is participant 0 and works too). Each participant takes from the front of its own deque,
+// so neighbouring tasks stay on one core; once it runs dry it steals from the back of the others.
+// Uneven tasks (image tiles that hit geometry next to tiles of empty sky) therefore balance out
+// without a shared counter every thread contends on.
+class WorkStealingPool {
+public:
+    using Task = std::function<void(uint32_t task, uint32_t worker)>;
+
+    // threadCount 0 = one per hardware thread; the calling thread counts as one of them
+    explicit WorkStealingPool(uint32_t threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Runs task(index, worker) for every index in [0, taskCount) and returns when all are done.
+    // worker is in [0, getThreadCount()) and unique among the threads running at the same time.
+    void run(uint32_t taskCount, const Task& task);
+
+    uint32_t getThreadCount() const { return static_cast<uint32_t>(queues.size()); }
+    // Tasks taken from another participant's deque during the last run()
+    uint32_t getLastStealCount() const { return lastSteals; }
+
+private:
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<uint32_t> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;   // One per participant, caller first
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake;   // New batch or shutdown
+    std::condition_variable done;   // Last task finished or a worker left the batch
+    const Task* current = nullptr;  // Valid while a batch runs
+    uint64_t batch = 0;
+    uint32_t busyWorkers = 0;       // Workers that may still touch current
+    bool stopping = false;
+
+    std::atomic<uint32_t> remaining{0};
+    std::atomic<uint32_t> steals{0};
+    uint32_t lastSteals = 0;
+
+    void workerLoop(uint32_t worker);
+    void drain(uint32_t worker, const Task& task);
+    bool popLocal(uint32_t worker, uint32_t& task);
+    bool steal(uint32_t worker, uint32_t& task);
+};
@@ -0,0 +1,359 @@
+#include "AccelerationStructureBuilder.h"
+#include "VulkanHelpers.h"
+#include "Logger.h"
+#include <algorithm>
+#include <stdexcept>
+
+AccelerationStructureBuilder::AccelerationStructureBuilder(VkDevice device, VkPhysicalDevice physicalDevice,
+                                                           VkCommandPool commandPool, VkQueue queue)
+    : device(device), physicalDevice(physicalDevice), commandPool(commandPool), queue(queue) {
+    vkCmdBuildAccelerationStructuresKHR = reinterpret_cast<PFN_vkCmdBuildAccelerationStructuresKHR>(
+        vkGetDeviceProcAddr(device, "vkCmdBuildAccelerationStructuresKHR"));
+    vkCmdWriteAccelerationStructuresPropertiesKHR = reinterpret_cast<PFN_vkCmdWriteAccelerationStructuresPropertiesKHR>(
+        vkGetDeviceProcAddr(device, "vkCmdWriteAccelerationStructuresPropertiesKHR"));
+    vkCmdCopyAccelerationStructureKHR = reinterpret_cast<PFN_vkCmdCopyAccelerationStructureKHR>(
+        vkGetDeviceProcAddr(device, "vkCmdCopyAccelerationStructureKHR"));
+    vkCmdCopyAccelerationStructureToMemoryKHR = reinterpret_cast<PFN_vkCmdCopyAccelerationStructureToMemoryKHR>(
+        vkGetDeviceProcAddr(device, "vkCmdCopyAccelerationStructureToMemoryKHR"));
+    vkCmdCopyMemoryToAccelerationStructureKHR = reinterpret_cast<PFN_vkCmdCopyMemoryToAccelerationStructureKHR>(
+        vkGetDeviceProcAddr(device, "vkCmdCopyMemoryToAccelerationStructureKHR"));
+    vkDestroyAccelerationStructureKHR = reinterpret_cast<PFN_vkDestroyAccelerationStructureKHR>(
+        vkGetDeviceProcAddr(device, "vkDestroyAccelerationStructureKHR"));
+
+    if (!vkCmdBuildAccelerationStructuresKHR || !vkCmdWriteAccelerationStructuresPropertiesKHR ||
+        !vkCmdCopyAccelerationStructureKHR || !vkCmdCopyAccelerationStructureToMemoryKHR ||
+        !vkCmdCopyMemoryToAccelerationStructureKHR || !vkDestroyAccelerationStructureKHR) {
+        throw std::runtime_error("failed to load acceleration structure build functions!");
+    }
+
+    VkPhysicalDeviceAccelerationStructurePropertiesKHR asProperties{};
+    asProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR;
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &asProperties;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+    scratchAlignment = std::max<VkDeviceSize>(asProperties.minAccelerationStructureScratchOffsetAlignment, 1);
+    timestampPeriodNs = properties.properties.limits.timestampPeriod;
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create acceleration structure build fence!");
+    }
+
+    if (properties.properties.limits.timestampComputeAndGraphics) {
+        VkQueryPoolCreateInfo queryPoolInfo{};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInfo.queryCount = 2;
+        if (vkCreateQueryPool(device, &queryPoolInfo, nullptr, &timestampPool) != VK_SUCCESS) {
+            timestampPool = VK_NULL_HANDLE;   // Timing is optional
+        }
+    }
+}
+
+AccelerationStructureBuilder::~AccelerationStructureBuilder() {
+    wait();
+    vkDestroyFence(device, fence, nullptr);
+    if (timestampPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, timestampPool, nullptr);
+    }
+    if (buildTimestampPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, buildTimestampPool, nullptr);
+    }
+    if (scratchBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, scratchBuffer, nullptr);
+        vkFreeMemory(device, scratchMemory, nullptr);
+    }
+}
+
+void AccelerationStructureBuilder::addBuild(const VkAccelerationStructureBuildGeometryInfoKHR& buildInfo,
+                                            const VkAccelerationStructureBuildRangeInfoKHR* ranges,
+                                            VkDeviceSize scratchSize) {
+    PendingBuild build{buildInfo, ranges, scratchSize};
+    if (buildInfo.type == VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR) {
+        topLevelBuilds.push_back(build);
+    } else {
+        bottomLevelBuilds.push_back(build);
+    }
+}
+
+void AccelerationStructureBuilder::addPropertyQuery(VkAccelerationStructureKHR accelerationStructure,
+                                                    VkQueryType queryType, VkQueryPool queryPool, uint32_t query) {
+    queries.push_back({accelerationStructure, queryType, queryPool, query});
+}
+
+void AccelerationStructureBuilder::addCopy(const VkCopyAccelerationStructureInfoKHR& copyInfo) {
+    copies.push_back(copyInfo);
+}
+
+void AccelerationStructureBuilder::addSerialize(const VkCopyAccelerationStructureToMemoryInfoKHR& copyInfo) {
+    serializations.push_back(copyInfo);
+}
+
+void AccelerationStructureBuilder::addDeserialize(const VkCopyMemoryToAccelerationStructureInfoKHR& copyInfo) {
+    deserializations.push_back(copyInfo);
+}
+
+void AccelerationStructureBuilder::retireAfterCompletion(VkAccelerationStructureKHR accelerationStructure,
+                                                         VkBuffer buffer, VkDeviceMemory memory) {
+    retiring.push_back({accelerationStructure, buffer, memory});
+}
+
+VkDeviceSize AccelerationStructureBuilder::alignScratch(VkDeviceSize size) const {
+    return (size + scratchAlignment - 1) / scratchAlignment * scratchAlignment;
+}
+
+VkDeviceSize AccelerationStructureBuilder::phaseScratchSize(const std::vector<PendingBuild>& builds) const {
+    VkDeviceSize total = 0;
+    for (const PendingBuild& build : builds) {
+        total += alignScratch(build.scratchSize);
+    }
+    return total;
+}
+
+void AccelerationStructureBuilder::reserveScratch(VkDeviceSize size) {
+    if (size <= scratchCapacity) return;
+
+    wait();   // The old arena may still be in use by the last submit
+    if (scratchBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, scratchBuffer, nullptr);
+        vkFreeMemory(device, scratchMemory, nullptr);
+    }
+
+    // Over-allocate by one alignment so the base address can be rounded up
+    VulkanHelpers::createBuffer(device, physicalDevice, size + scratchAlignment,
+                                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, scratchBuffer, scratchMemory);
+
+    VkBufferDeviceAddressInfo addressInfo{};
+    addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+    addressInfo.buffer = scratchBuffer;
+    scratchAddress = alignScratch(vkGetBufferDeviceAddress(device, &addressInfo));
+    scratchCapacity = size;
+
+    LOG_DEBUG("🧱 AS scratch arena: " << scratchCapacity << " bytes (alignment " << scratchAlignment << ")");
+}
+
+void AccelerationStructureBuilder::reserveBuildTimestamps(uint32_t buildCount) {
+    if (buildCount * 2 <= buildTimestampCapacity) return;
+
+    // Only called from submit() after wait(), so the old pool is idle
+    if (buildTimestampPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, buildTimestampPool, nullptr);
+        buildTimestampPool = VK_NULL_HANDLE;
+        buildTimestampCapacity = 0;
+    }
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = buildCount * 2;
+    if (vkCreateQueryPool(device, &queryPoolInfo, nullptr, &buildTimestampPool) != VK_SUCCESS) {
+        buildTimestampPool = VK_NULL_HANDLE;   // Timing is optional
+        return;
+    }
+    buildTimestampCapacity = queryPoolInfo.queryCount;
+}
+
+double AccelerationStructureBuilder::getBuildMs(VkAccelerationStructureKHR accelerationStructure) const {
+    auto it = buildMs.find(accelerationStructure);
+    return it != buildMs.end() ? it->second : -1.0;
+}
+
+void AccelerationStructureBuilder::recordBuilds(std::vector<PendingBuild>& builds) {
+    if (builds.empty()) return;
+    
+    if (perBuildTimestamps && buildTimestampPool != VK_NULL_HANDLE) {
+        // One build per call between timestamps; the barrier keeps the next one from overlapping
+        VkDeviceSize offset = 0;
+        for (size_t i = 0; i < builds.size(); i++) {
+            PendingBuild& build = builds[i];
+            build.buildInfo.scratchData.deviceAddress = scratchAddress + offset;
+            offset += alignScratch(build.scratchSize);
+
+            uint32_t query = static_cast<uint32_t>(timedBuilds.size()) * 2;
+            if (i > 0) recordPhaseBarrier();
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, buildTimestampPool, query);
+            vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &build.buildInfo, &build.ranges);
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, buildTimestampPool, query + 1);
+            timedBuilds.push_back(build.buildInfo.dstAccelerationStructure);
+        }
+        builds.clear();
+        return;
+    }
+
+    std::vector<VkAccelerationStructureBuildGeometryInfoKHR> buildInfos;
+    std::vector<const VkAccelerationStructureBuildRangeInfoKHR*> ranges;
+    VkDeviceSize offset = 0;
+    for (PendingBuild& build : builds) {
+        build.buildInfo.scratchData.deviceAddress = scratchAddress + offset;
+        offset += alignScratch(build.scratchSize);
+        buildInfos.push_back(build.buildInfo);
+        ranges.push_back(build.ranges);
+    }
+
+    vkCmdBuildAccelerationStructuresKHR(commandBuffer, static_cast<uint32_t>(buildInfos.size()),
+                                        buildInfos.data(), ranges.data());
+    builds.clear();
+}
+
+void AccelerationStructureBuilder::recordPhaseBarrier() {
+    // Results of the previous phase become readable, and its scratch slices can be reused
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+    barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR |
+                            VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                         VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void AccelerationStructureBuilder::submit() {
+    if (bottomLevelBuilds.empty() && topLevelBuilds.empty() && queries.empty() && copies.empty() &&
+        serializations.empty() && deserializations.empty()) return;
+
+    wait();
+    reserveScratch(std::max(phaseScratchSize(bottomLevelBuilds), phaseScratchSize(topLevelBuilds)));
+    if (perBuildTimestamps && timestampPool != VK_NULL_HANDLE) {
+        reserveBuildTimestamps(static_cast<uint32_t>(bottomLevelBuilds.size() + topLevelBuilds.size()));
+    }
+
+    size_t buildCount = bottomLevelBuilds.size() + topLevelBuilds.size();
+    size_t copyCount = copies.size() + serializations.size() + deserializations.size();
+    bool hostReadback = !serializations.empty();
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = commandPool;
+    allocInfo.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate acceleration structure build command buffer!");
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    if (perBuildTimestamps && buildTimestampPool != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(commandBuffer, buildTimestampPool, 0, buildTimestampCapacity);
+    }
+
+    bool needsBarrier = !bottomLevelBuilds.empty();
+    recordBuilds(bottomLevelBuilds);
+
+    if (!queries.empty()) {
+        if (needsBarrier) recordPhaseBarrier();
+        needsBarrier = false;
+        for (const PendingQuery& pending : queries) {
+            vkCmdResetQueryPool(commandBuffer, pending.queryPool, pending.query, 1);
+            vkCmdWriteAccelerationStructuresPropertiesKHR(commandBuffer, 1, &pending.accelerationStructure,
+                                                          pending.queryType,
+                                                          pending.queryPool, pending.query);
+        }
+        queries.clear();
+    }
+
+    if (copyCount > 0) {
+        if (needsBarrier) recordPhaseBarrier();
+        for (const VkCopyAccelerationStructureInfoKHR& copyInfo : copies) {
+            vkCmdCopyAccelerationStructureKHR(commandBuffer, &copyInfo);
+        }
+        for (const VkCopyAccelerationStructureToMemoryInfoKHR& copyInfo : serializations) {
+            vkCmdCopyAccelerationStructureToMemoryKHR(commandBuffer, &copyInfo);
+        }
+        for (const VkCopyMemoryToAccelerationStructureInfoKHR& copyInfo : deserializations) {
+            vkCmdCopyMemoryToAccelerationStructureKHR(commandBuffer, &copyInfo);
+        }
+        copies.clear();
+        serializations.clear();
+        deserializations.clear();
+        needsBarrier = true;
+    }
+
+    if (!topLevelBuilds.empty()) {
+        if (needsBarrier) recordPhaseBarrier();
+        topLevelTimed = timestampPool != VK_NULL_HANDLE;
+        if (topLevelTimed) {
+            vkCmdResetQueryPool(commandBuffer, timestampPool, 0, 2);
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool, 0);
+        }
+        recordBuilds(topLevelBuilds);
+        if (topLevelTimed) {
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampPool, 1);
+        }
+    }
+
+    if (hostReadback) {
+        // Serialized blobs are read through mapped memory once the fence signals
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR | VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                             VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    vkEndCommandBuffer(commandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    vkResetFences(device, 1, &fence);
+    if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit acceleration structure builds!");
+    }
+
+    inFlight.insert(inFlight.end(), retiring.begin(), retiring.end());
+    retiring.clear();
+
+    LOG_DEBUG("🧱 AS batch submitted: " << buildCount << " build(s), " << copyCount << " copy(ies)");
+}
+
+void AccelerationStructureBuilder::wait() {
+    if (commandBuffer == VK_NULL_HANDLE) return;
+
+    vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+    vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+    commandBuffer = VK_NULL_HANDLE;
+
+    if (topLevelTimed) {
+        uint64_t timestamps[2] = {};
+        if (vkGetQueryPoolResults(device, timestampPool, 0, 2, sizeof(timestamps), timestamps, sizeof(uint64_t),
+                                  VK_QUERY_RESULT_64_BIT) == VK_SUCCESS && timestamps[1] >= timestamps[0]) {
+            lastTopLevelBuildMs = (timestamps[1] - timestamps[0]) * timestampPeriodNs * 1e-6;
+        }
+        topLevelTimed = false;
+    }
+    
+    if (!timedBuilds.empty()) {
+        std::vector<uint64_t> timestamps(timedBuilds.size() * 2);
+        if (vkGetQueryPoolResults(device, buildTimestampPool, 0, static_cast<uint32_t>(timestamps.size()),
+                                  timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t),
+                                  VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+            for (size_t i = 0; i < timedBuilds.size(); i++) {
+                uint64_t begin = timestamps[i * 2];
+                uint64_t end = timestamps[i * 2 + 1];
+                if (end >= begin) {
+                    buildMs[timedBuilds[i]] = (end - begin) * timestampPeriodNs * 1e-6;
+                }
+            }
+        }
+        timedBuilds.clear();
+    }
+
+    for (const RetiredStructure& retired : inFlight) {
+        vkDestroyAccelerationStructureKHR(device, retired.accelerationStructure, nullptr);
+        vkDestroyBuffer(device, retired.buffer, nullptr);
+        vkFreeMemory(device, retired.memory, nullptr);
+    }
+    inFlight.clear();
+}
@@ -0,0 +1,161 @@
+#include "AccelerationStructureCache.h"
+#include "Logger.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+AccelerationStructureCache::AccelerationStructureCache(VkDevice device, const std::string& path)
+    : device(device), path(path) {
+    vkGetDeviceAccelerationStructureCompatibilityKHR =
+        reinterpret_cast<PFN_vkGetDeviceAccelerationStructureCompatibilityKHR>(
+            vkGetDeviceProcAddr(device, "vkGetDeviceAccelerationStructureCompatibilityKHR"));
+
+    if (vkGetDeviceAccelerationStructureCompatibilityKHR) {
+        load();
+    }
+}
+
+void AccelerationStructureCache::load() {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        LOG_INFO("Acceleration structure cache " << path << " not found (cold start)");
+        return;
+    }
+
+    file.seekg(0, std::ios::end);
+    uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+
+    uint32_t header[3] = {};
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        header[0] != FILE_MAGIC || header[1] != FILE_VERSION) {
+        LOG_WARN("⚠️  Acceleration structure cache " << path << " is not a valid cache - ignoring it");
+        return;
+    }
+
+    uint32_t rejected = 0;
+    for (uint32_t i = 0; i < header[2]; i++) {
+        uint64_t key = 0;
+        uint64_t size = 0;
+        if (!file.read(reinterpret_cast<char*>(&key), sizeof(key)) ||
+            !file.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+            LOG_WARN("⚠️  Acceleration structure cache " << path << " is truncated - ignoring the rest");
+            break;
+        }
+
+        // A corrupt size must not turn into a huge allocation: it has to fit in what is left
+        uint64_t remaining = fileSize - static_cast<uint64_t>(file.tellg());
+        if (size > remaining || size > MAX_ENTRY_SIZE) {
+            LOG_WARN("⚠️  Acceleration structure cache " << path << " has a corrupt entry size (" << size
+                     << " bytes, " << remaining << " left) - ignoring the rest");
+            break;
+        }
+
+        std::vector<uint8_t> data(size);
+        if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size))) {
+            LOG_WARN("⚠️  Acceleration structure cache " << path << " is truncated - ignoring the rest");
+            break;
+        }
+
+        if (!isCompatible(data)) {
+            rejected++;
+            continue;
+        }
+        entries[key].data = std::move(data);
+    }
+
+    LOG_INFO("✅ Acceleration structure cache loaded: " << entries.size() << " entries from " << path
+             << (rejected > 0 ? " (" + std::to_string(rejected) + " built by another GPU/driver dropped)" : ""));
+}
+
+bool AccelerationStructureCache::isCompatible(const std::vector<uint8_t>& data) const {
+    if (data.size() < SERIALIZED_HEADER_SIZE) {
+        return false;
+    }
+
+    // The version data is the driver UUID followed by the compatibility ID
+    VkAccelerationStructureVersionInfoKHR versionInfo{};
+    versionInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_VERSION_INFO_KHR;
+    versionInfo.pVersionData = data.data();
+
+    VkAccelerationStructureCompatibilityKHR compatibility = VK_ACCELERATION_STRUCTURE_COMPATIBILITY_INCOMPATIBLE_KHR;
+    vkGetDeviceAccelerationStructureCompatibilityKHR(device, &versionInfo, &compatibility);
+    return compatibility == VK_ACCELERATION_STRUCTURE_COMPATIBILITY_COMPATIBLE_KHR;
+}
+
+const std::vector<uint8_t>* AccelerationStructureCache::find(uint64_t key) {
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return nullptr;
+    }
+    it->second.used = true;
+    return &it->second.data;
+}
+
+void AccelerationStructureCache::store(uint64_t key, std::vector<uint8_t> data) {
+    Entry& entry = entries[key];
+    entry.data = std::move(data);
+    entry.used = true;
+    dirty = true;
+}
+
+VkDeviceSize AccelerationStructureCache::deserializedSize(const std::vector<uint8_t>& data) {
+    uint64_t size = 0;
+    if (data.size() >= SERIALIZED_HEADER_SIZE) {
+        std::memcpy(&size, data.data() + 2 * VK_UUID_SIZE + sizeof(uint64_t), sizeof(size));
+    }
+    return size;
+}
+
+uint64_t AccelerationStructureCache::hash(const void* data, size_t size, uint64_t seed) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t value = seed;
+    for (size_t i = 0; i < size; i++) {
+        value ^= bytes[i];
+        value *= 0x100000001b3ull;
+    }
+    return value;
+}
+
+bool AccelerationStructureCache::save() const {
+    if (!dirty) {
+        return true;
+    }
+
+    uint32_t entryCount = 0;
+    for (const auto& [key, entry] : entries) {
+        if (entry.used) entryCount++;
+    }
+
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            LOG_WARN("⚠️  Could not write acceleration structure cache to " << tempPath);
+            return false;
+        }
+
+        uint32_t header[3] = {FILE_MAGIC, FILE_VERSION, entryCount};
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        for (const auto& [key, entry] : entries) {
+            if (!entry.used) continue;
+            uint64_t size = entry.data.size();
+            file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+            file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            file.write(reinterpret_cast<const char*>(entry.data.data()), static_cast<std::streamsize>(size));
+        }
+        if (!file) {
+            LOG_WARN("⚠️  Could not write acceleration structure cache to " << tempPath);
+            return false;
+        }
+    }
+
+    std::remove(path.c_str());   // rename() does not replace an existing file on Windows
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        LOG_WARN("⚠️  Could not move acceleration structure cache into place at " << path);
+        return false;
+    }
+
+    LOG_INFO("💾 Acceleration structure cache saved: " << entryCount << " entries to " << path);
+    return true;
+}
@@ -0,0 +1,66 @@
+#include "AccelerationStructureReport.h"
+#include "Bvh.h"
+#include "Json.h"
+#include "Logger.h"
+#include <fstream>
+
+static void writeBvhStats(std::ostream& out, const Bvh::BuildStats& stats) {
+    out << "{\"nodes\": " << stats.nodeCount << ", \"leaves\": " << stats.leafCount
+        << ", \"maxDepth\": " << stats.maxDepth << ", \"sahCost\": " << stats.sahCost
+        << ", \"buildMs\": " << stats.buildMs << ", \"leafDepthHistogram\": [";
+    for (size_t depth = 0; depth < stats.leafDepthHistogram.size(); depth++) {
+        out << (depth > 0 ? ", " : "") << stats.leafDepthHistogram[depth];
+    }
+    out << "]}";
+}
+
+bool AccelerationStructureReport::write(const std::string& path, const std::string& deviceName,
+                                        const std::vector<RayTracingPipeline::AccelerationStructureStats>& structures,
+                                        const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                                        const std::vector<ClippyGeometry::Part>& parts) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        LOG_ERROR("❌ Could not write acceleration structure report to " << path);
+        return false;
+    }
+
+    out << "{\n";
+    out << "  \"device\": " << Json::quote(deviceName) << ",\n";
+    out << "  \"structures\": [\n";
+    for (size_t i = 0; i < structures.size(); i++) {
+        const RayTracingPipeline::AccelerationStructureStats& s = structures[i];
+        out << "    {\"name\": " << Json::quote(s.name) << ", \"type\": \"" << (s.topLevel ? "tlas" : "blas")
+            << "\", \"source\": \"" << s.source << "\", \"primitives\": " << s.primitiveCount
+            << ", \"degenerateTriangles\": " << s.degenerateTriangles
+            << ", \"buildBytes\": " << s.buildSize << ", \"compactedBytes\": " << s.finalSize
+            << ", \"buildScratchBytes\": " << s.buildScratchSize << ", \"updateScratchBytes\": " << s.updateScratchSize
+            << ", \"gpuBuildMs\": " << (s.buildMs >= 0.0 ? std::to_string(s.buildMs) : "null");
+
+        std::string bvhSummary;
+        if (!s.topLevel && i < parts.size()) {
+            // The part's own vertex range; its indices are already relative to it
+            const ClippyGeometry::Part& part = parts[i];
+            std::vector<Vertex> partVertices(vertices.begin() + part.firstVertex,
+                                             vertices.begin() + part.firstVertex + part.vertexCount);
+            std::vector<uint32_t> partIndices(indices.begin() + part.firstIndex,
+                                              indices.begin() + part.firstIndex + part.indexCount);
+            Bvh bvh;
+            bvh.build(partVertices, partIndices);
+            out << ", \"cpuBvh\": ";
+            writeBvhStats(out, bvh.getStats());
+            bvhSummary = ", CPU BVH " + std::to_string(bvh.getStats().nodeCount) + " nodes, depth " +
+                         std::to_string(bvh.getStats().maxDepth) + ", SAH " + std::to_string(bvh.getStats().sahCost);
+        }
+        out << "}" << (i + 1 < structures.size() ? ",\n" : "\n");
+
+        LOG_INFO("   " << (s.topLevel ? "TLAS" : "BLAS") << " '" << s.name << "': " << s.primitiveCount
+                 << " primitives (" << s.degenerateTriangles << " degenerate), " << s.buildSize << " -> "
+                 << s.finalSize << " bytes, scratch " << s.buildScratchSize << ", "
+                 << (s.buildMs >= 0.0 ? std::to_string(s.buildMs) + " ms GPU" : std::string(s.source)) << bvhSummary);
+    }
+    out << "  ]\n";
+    out << "}\n";
+
+    LOG_INFO("📊 Acceleration structure report written to " << path);
+    return true;
+}
@@ -0,0 +1,208 @@
+#include "Benchmark.h"
+#include "Logger.h"
+#include "Json.h"
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+Benchmark::Benchmark(const Options& options) : options(options) {
+    if (!options.scriptPath.empty()) {
+        loadScript(options.scriptPath);
+    }
+
+    LOG_INFO("📈 Benchmark: " << options.warmupFrames << " warmup + " << options.frames << " frames, dt "
+             << options.timestep << "s" << (options.scriptPath.empty() ? "" : ", script ") << options.scriptPath);
+}
+
+void Benchmark::loadScript(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open benchmark script: " + path);
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream in(line);
+        float time;
+        std::string command;
+        if (!(in >> time >> command)) {
+            continue;   // Blank or comment-only line
+        }
+
+        bool ok = false;
+        if (command == "camera") {
+            CameraKey key{time, glm::vec3(0.0f), glm::vec3(0.0f)};
+            ok = static_cast<bool>(in >> key.position.x >> key.position.y >> key.position.z
+                                      >> key.target.x >> key.target.y >> key.target.z);
+            if (ok) cameraKeys.push_back(key);
+        } else if (command == "personality") {
+            int mode;
+            ok = static_cast<bool>(in >> mode) && mode >= 0 && mode <= 5;
+            if (ok) personalityKeys.push_back({time, mode});
+        } else if (command == "rtx") {
+            std::string value;
+            ok = static_cast<bool>(in >> value) && (value == "on" || value == "off");
+            if (ok) rtxKeys.push_back({time, value == "on" ? 1 : 0});
+        }
+
+        if (!ok) {
+            throw std::runtime_error("invalid benchmark script line " + std::to_string(lineNumber) + ": " + line);
+        }
+    }
+
+    auto byTime = [](const auto& a, const auto& b) { return a.time < b.time; };
+    std::stable_sort(cameraKeys.begin(), cameraKeys.end(), byTime);
+    std::stable_sort(personalityKeys.begin(), personalityKeys.end(), byTime);
+    std::stable_sort(rtxKeys.begin(), rtxKeys.end(), byTime);
+
+    LOG_INFO("   Script: " << cameraKeys.size() << " camera, " << personalityKeys.size() << " personality, "
+             << rtxKeys.size() << " rtx keys");
+}
+
+int Benchmark::stepValueAt(const std::vector<StepKey>& keys, float time) {
+    int value = -1;
+    for (const StepKey& key : keys) {
+        if (key.time > time) break;
+        value = key.value;
+    }
+    return value;
+}
+
+Benchmark::ScriptState Benchmark::evaluate(float time) const {
+    ScriptState state;
+    state.personalityMode = stepValueAt(personalityKeys, time);
+    state.rtxEnabled = stepValueAt(rtxKeys, time);
+
+    if (!cameraKeys.empty()) {
+        state.hasCamera = true;
+        auto next = std::find_if(cameraKeys.begin(), cameraKeys.end(),
+                                 [time](const CameraKey& key) { return key.time > time; });
+        if (next == cameraKeys.begin()) {
+            state.cameraPos = next->position;
+            state.cameraTarget = next->target;
+        } else if (next == cameraKeys.end()) {
+            state.cameraPos = cameraKeys.back().position;
+            state.cameraTarget = cameraKeys.back().target;
+        } else {
+            const CameraKey& prev = *(next - 1);
+            float t = (time - prev.time) / std::max(next->time - prev.time, 1e-6f);
+            state.cameraPos = glm::mix(prev.position, next->position, t);
+            state.cameraTarget = glm::mix(prev.target, next->target, t);
+        }
+    }
+    return state;
+}
+
+void Benchmark::sampleDeviceMemory(VkPhysicalDevice physicalDevice, bool memoryBudgetSupported) {
+    if (!memoryBudgetSupported) return;
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+    budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    VkPhysicalDeviceMemoryProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    properties.pNext = &budget;
+    vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &properties);
+
+    VkDeviceSize used = 0;
+    for (uint32_t i = 0; i < properties.memoryProperties.memoryHeapCount; i++) {
+        if (properties.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            used += budget.heapUsage[i];
+        }
+    }
+
+    peakDeviceBytes = std::max(peakDeviceBytes, used);
+    deviceMemoryKnown = true;
+}
+
+Benchmark::Percentiles Benchmark::computePercentiles(std::vector<float> samples) {
+    Percentiles p;
+    p.count = samples.size();
+    if (samples.empty()) return p;
+
+    std::sort(samples.begin(), samples.end());
+    auto rank = [&samples](double q) {
+        size_t index = static_cast<size_t>(q * (samples.size() - 1) + 0.5);
+        return static_cast<double>(samples[std::min(index, samples.size() - 1)]);
+    };
+
+    p.min = samples.front();
+    p.max = samples.back();
+    p.avg = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    p.p50 = rank(0.50);
+    p.p90 = rank(0.90);
+    p.p99 = rank(0.99);
+    return p;
+}
+
+static void writePercentiles(std::ostream& out, const char* name, const Benchmark::Percentiles& p, bool last = false) {
+    out << "  \"" << name << "\": {\"count\": " << p.count << ", \"min\": " << p.min << ", \"avg\": " << p.avg
+        << ", \"p50\": " << p.p50 << ", \"p90\": " << p.p90 << ", \"p99\": " << p.p99 << ", \"max\": " << p.max
+        << "}" << (last ? "\n" : ",\n");
+}
+
+bool Benchmark::writeReport(const std::string& deviceName, VkExtent2D extent, uint64_t primaryRaysPerFrame) const {
+    std::ofstream out(options.reportPath);
+    if (!out.is_open()) {
+        LOG_ERROR("❌ Could not write benchmark report to " << options.reportPath);
+        return false;
+    }
+
+    Percentiles cpu = computePercentiles(cpuFrameMs);
+    Percentiles gpu = computePercentiles(gpuFrameMs);
+    Percentiles traceRays = computePercentiles(gpuTraceRaysMs);
+    Percentiles tlasUpdate = computePercentiles(gpuTlasUpdateMs);
+    Percentiles instanceFill = computePercentiles(cpuInstanceFillMs);
+
+    // Primary rays only: secondary/shadow rays depend on the shaders and are not counted
+    double raysPerSecond = traceRays.avg > 0.0 ? primaryRaysPerFrame / (traceRays.avg * 1e-3) : 0.0;
+
+    long peakRssKB = -1;
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+        peakRssKB = usage.ru_maxrss / 1024;   // Bytes on macOS
+#else
+        peakRssKB = usage.ru_maxrss;          // Kilobytes on Linux
+#endif
+    }
+#endif
+
+    out << "{\n";
+    out << "  \"device\": " << Json::quote(deviceName) << ",\n";
+    out << "  \"resolution\": [" << extent.width << ", " << extent.height << "],\n";
+    out << "  \"frames\": " << options.frames << ",\n";
+    out << "  \"warmupFrames\": " << options.warmupFrames << ",\n";
+    out << "  \"timestep\": " << options.timestep << ",\n";
+    out << "  \"script\": " << Json::quote(options.scriptPath) << ",\n";
+    writePercentiles(out, "cpuFrameMs", cpu);
+    writePercentiles(out, "gpuFrameMs", gpu);
+    writePercentiles(out, "gpuTraceRaysMs", traceRays);
+    out << "  \"tlasInstances\": " << tlasInstances << ",\n";
+    out << "  \"tlasBuildMs\": " << tlasBuildMs << ",\n";
+    writePercentiles(out, "gpuTlasUpdateMs", tlasUpdate);
+    writePercentiles(out, "cpuInstanceFillMs", instanceFill);
+    out << "  \"primaryRaysPerSecond\": " << raysPerSecond << ",\n";
+    out << "  \"peakHostRssMB\": " << (peakRssKB >= 0 ? std::to_string(peakRssKB / 1024.0) : "null") << ",\n";
+    out << "  \"peakDeviceMemoryMB\": "
+        << (deviceMemoryKnown ? std::to_string(peakDeviceBytes / (1024.0 * 1024.0)) : "null") << "\n";
+    out << "}\n";
+
+    LOG_INFO("📈 Benchmark report written to " << options.reportPath);
+    LOG_INFO("   CPU frame ms  p50 " << cpu.p50 << "  p99 " << cpu.p99);
+    LOG_INFO("   GPU frame ms  p50 " << gpu.p50 << "  p99 " << gpu.p99);
+    LOG_INFO("   TLAS " << tlasInstances << " instances: build " << tlasBuildMs << " ms, update p50 "
+             << tlasUpdate.p50 << " ms, CPU fill p50 " << instanceFill.p50 << " ms");
+    return true;
+}
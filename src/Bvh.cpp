@@ -0,0 +1,390 @@
+#include "Bvh.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <future>
+#include <thread>
+
+float Bvh::Bounds::area() const {
+    glm::vec3 extent = max - min;
+    if (extent.x < 0.0f) return 0.0f;   // Empty
+    return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+void Bvh::build(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) {
+    build(vertices, indices, BuildOptions{});
+}
+
+void Bvh::build(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                const BuildOptions& buildOptions) {
+    auto buildStart = std::chrono::high_resolution_clock::now();
+    options = buildOptions;
+    options.binCount = std::max(options.binCount, 2u);
+    options.maxLeafSize = std::max(options.maxLeafSize, 1u);
+
+    uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    triangles.resize(triangleCount);
+    triangleBounds.resize(triangleCount);
+    triangleCentroids.resize(triangleCount);
+    triangleOrder.resize(triangleCount);
+
+    for (uint32_t i = 0; i < triangleCount; i++) {
+        Triangle& triangle = triangles[i];
+        triangle.v0 = vertices[indices[i * 3 + 0]].pos;
+        triangle.v1 = vertices[indices[i * 3 + 1]].pos;
+        triangle.v2 = vertices[indices[i * 3 + 2]].pos;
+
+        Bounds bounds;
+        bounds.grow(triangle.v0);
+        bounds.grow(triangle.v1);
+        bounds.grow(triangle.v2);
+        triangleBounds[i] = bounds;
+        triangleCentroids[i] = (triangle.v0 + triangle.v1 + triangle.v2) * (1.0f / 3.0f);
+        triangleOrder[i] = i;
+    }
+
+    // A binary tree over N leaves has at most 2N - 1 nodes, plus the unused slot 1
+    nodes.assign(std::max(2u * triangleCount + 1u, 2u), Node{});
+    std::atomic<uint32_t> nodesUsed{2};
+
+    Node& root = nodes[0];
+    root.leftOrFirst = 0;
+    root.count = triangleCount;
+    if (triangleCount > 0) {
+        updateNodeBounds(root);
+        buildNode(0, 0, nodesUsed);
+    }
+    nodes.resize(nodesUsed.load());
+
+    triangleBounds.clear();
+    triangleBounds.shrink_to_fit();
+    triangleCentroids.clear();
+    triangleCentroids.shrink_to_fit();
+
+    stats = BuildStats{};
+    stats.triangleCount = triangleCount;
+    stats.buildMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - buildStart).count();
+    if (triangleCount > 0) {
+        gatherStats(0, 0);
+        stats.sahCost = computeSahCost();
+    }
+}
+
+void Bvh::updateNodeBounds(Node& node) const {
+    Bounds bounds;
+    for (uint32_t i = 0; i < node.count; i++) {
+        bounds.grow(triangleBounds[triangleOrder[node.leftOrFirst + i]]);
+    }
+    node.boundsMin = bounds.min;
+    node.boundsMax = bounds.max;
+}
+
+Bvh::Split Bvh::findBestSplit(const Node& node) const {
+    // Bins span the centroid bounds, which are tighter than the node bounds
+    Bounds centroidBounds;
+    for (uint32_t i = 0; i < node.count; i++) {
+        centroidBounds.grow(triangleCentroids[triangleOrder[node.leftOrFirst + i]]);
+    }
+
+    struct Bin {
+        Bounds bounds;
+        uint32_t count = 0;
+    };
+    const uint32_t binCount = options.binCount;
+    std::vector<Bin> bins(binCount);
+    std::vector<float> leftArea(binCount - 1), rightArea(binCount - 1);
+    std::vector<uint32_t> leftCount(binCount - 1), rightCount(binCount - 1);
+
+    Split best;
+    for (int axis = 0; axis < 3; axis++) {
+        float axisMin = centroidBounds.min[axis];
+        float axisMax = centroidBounds.max[axis];
+        if (axisMax <= axisMin) continue;
+
+        std::fill(bins.begin(), bins.end(), Bin{});
+        float scale = binCount / (axisMax - axisMin);
+        for (uint32_t i = 0; i < node.count; i++) {
+            uint32_t triangle = triangleOrder[node.leftOrFirst + i];
+            uint32_t bin = std::min(binCount - 1,
+                                    static_cast<uint32_t>((triangleCentroids[triangle][axis] - axisMin) * scale));
+            bins[bin].count++;
+            bins[bin].bounds.grow(triangleBounds[triangle]);
+        }
+
+        // Sweep from both ends so every plane is evaluated in O(bins)
+        Bounds leftBounds, rightBounds;
+        uint32_t leftSum = 0, rightSum = 0;
+        for (uint32_t i = 0; i < binCount - 1; i++) {
+            leftSum += bins[i].count;
+            leftBounds.grow(bins[i].bounds);
+            leftCount[i] = leftSum;
+            leftArea[i] = leftBounds.area();
+
+            rightSum += bins[binCount - 1 - i].count;
+            rightBounds.grow(bins[binCount - 1 - i].bounds);
+            rightCount[binCount - 2 - i] = rightSum;
+            rightArea[binCount - 2 - i] = rightBounds.area();
+        }
+
+        float binWidth = (axisMax - axisMin) / binCount;
+        for (uint32_t i = 0; i < binCount - 1; i++) {
+            if (leftCount[i] == 0 || rightCount[i] == 0) continue;
+            float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+            if (cost < best.cost) {
+                best.axis = axis;
+                best.position = axisMin + binWidth * (i + 1);
+                best.cost = cost;
+            }
+        }
+    }
+    return best;
+}
+
+void Bvh::buildNode(uint32_t nodeIndex, uint32_t depth, std::atomic<uint32_t>& nodesUsed) {
+    Node& node = nodes[nodeIndex];
+    if (node.count <= options.maxLeafSize || depth >= MAX_DEPTH) return;
+
+    Split split = findBestSplit(node);
+    if (split.axis < 0) return;   // All centroids coincide: keep as a leaf
+
+    // Compare against not splitting, in the same units (area-weighted triangle tests)
+    glm::vec3 extent = node.boundsMax - node.boundsMin;
+    float nodeArea = 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    float splitCost = options.traversalCost * nodeArea + options.intersectionCost * split.cost;
+    float leafCost = options.intersectionCost * node.count * nodeArea;
+    if (splitCost >= leafCost) return;
+
+    // In-place partition of this node's triangle range
+    uint32_t first = node.leftOrFirst;
+    auto begin = triangleOrder.begin() + first;
+    auto middle = std::partition(begin, begin + node.count, [&](uint32_t triangle) {
+        return triangleCentroids[triangle][split.axis] < split.position;
+    });
+    uint32_t i = first + static_cast<uint32_t>(middle - begin);
+
+    uint32_t leftCount = i - first;
+    if (leftCount == 0 || leftCount == node.count) return;
+
+    uint32_t leftIndex = nodesUsed.fetch_add(2);
+    Node& left = nodes[leftIndex];
+    Node& right = nodes[leftIndex + 1];
+    left.leftOrFirst = first;
+    left.count = leftCount;
+    right.leftOrFirst = i;
+    right.count = node.count - leftCount;
+    node.leftOrFirst = leftIndex;
+    node.count = 0;
+
+    updateNodeBounds(left);
+    updateNodeBounds(right);
+
+    // Big left subtrees become tasks; the right one continues on this thread
+    if (options.parallel && left.count >= options.parallelMinTriangles &&
+        right.count >= options.parallelMinTriangles) {
+        std::future<void> leftTask = std::async(std::launch::async, &Bvh::buildNode, this, leftIndex, depth + 1,
+                                                std::ref(nodesUsed));
+        buildNode(leftIndex + 1, depth + 1, nodesUsed);
+        leftTask.get();
+    } else {
+        buildNode(leftIndex, depth + 1, nodesUsed);
+        buildNode(leftIndex + 1, depth + 1, nodesUsed);
+    }
+}
+
+void Bvh::gatherStats(uint32_t nodeIndex, uint32_t depth) {
+    const Node& node = nodes[nodeIndex];
+    stats.nodeCount++;
+    stats.maxDepth = std::max(stats.maxDepth, depth);
+    if (node.isLeaf()) {
+        stats.leafCount++;
+        if (stats.leafDepthHistogram.size() <= depth) {
+            stats.leafDepthHistogram.resize(depth + 1, 0);
+        }
+        stats.leafDepthHistogram[depth]++;
+        return;
+    }
+    gatherStats(node.leftOrFirst, depth + 1);
+    gatherStats(node.leftOrFirst + 1, depth + 1);
+}
+
+float Bvh::computeSahCost() const {
+    if (nodes.empty() || triangles.empty()) return 0.0f;
+
+    auto area = [](const Node& node) {
+        glm::vec3 extent = node.boundsMax - node.boundsMin;
+        return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    };
+    float rootArea = area(nodes[0]);
+    if (rootArea <= 0.0f) return 0.0f;
+
+    float cost = 0.0f;
+    std::vector<uint32_t> stack = {0};
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        float relativeArea = area(node) / rootArea;
+        if (node.isLeaf()) {
+            cost += options.intersectionCost * node.count * relativeArea;
+        } else {
+            cost += options.traversalCost * relativeArea;
+            stack.push_back(node.leftOrFirst);
+            stack.push_back(node.leftOrFirst + 1);
+        }
+    }
+    return cost;
+}
+
+// Slab test; returns the entry distance or +inf on a miss
+static float intersectBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::vec3& origin,
+                             const glm::vec3& inverseDirection, float tMax) {
+    glm::vec3 t0 = (boundsMin - origin) * inverseDirection;
+    glm::vec3 t1 = (boundsMax - origin) * inverseDirection;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+    return entry <= exit ? entry : std::numeric_limits<float>::infinity();
+}
+
+// Möller-Trumbore
+static bool intersectTriangle(const Bvh::Triangle& triangle, const Bvh::Ray& ray, float tMax,
+                              float& t, float& u, float& v) {
+    glm::vec3 edge1 = triangle.v1 - triangle.v0;
+    glm::vec3 edge2 = triangle.v2 - triangle.v0;
+    glm::vec3 p = glm::cross(ray.direction, edge2);
+    float determinant = glm::dot(edge1, p);
+    if (std::abs(determinant) < 1e-12f) return false;
+
+    float inverseDeterminant = 1.0f / determinant;
+    glm::vec3 s = ray.origin - triangle.v0;
+    u = glm::dot(s, p) * inverseDeterminant;
+    if (u < 0.0f || u > 1.0f) return false;
+
+    glm::vec3 q = glm::cross(s, edge1);
+    v = glm::dot(ray.direction, q) * inverseDeterminant;
+    if (v < 0.0f || u + v > 1.0f) return false;
+
+    t = glm::dot(edge2, q) * inverseDeterminant;
+    return t > 0.0f && t < tMax;
+}
+
+bool Bvh::intersect(const Ray& ray, Hit& hit) const {
+    if (triangles.empty()) return false;
+
+    glm::vec3 inverseDirection = 1.0f / ray.direction;   // IEEE inf for axis-parallel rays
+    float closest = std::min(ray.tMax, hit.t);
+    bool found = false;
+
+    uint32_t stack[MAX_DEPTH];   // Holds at most one entry per level above the current node
+    uint32_t stackSize = 0;
+    uint32_t nodeIndex = 0;
+    if (intersectBounds(nodes[0].boundsMin, nodes[0].boundsMax, ray.origin, inverseDirection, closest) ==
+        std::numeric_limits<float>::infinity()) {
+        return false;
+    }
+
+    while (true) {
+        const Node& node = nodes[nodeIndex];
+        if (node.isLeaf()) {
+            for (uint32_t i = 0; i < node.count; i++) {
+                uint32_t triangle = triangleOrder[node.leftOrFirst + i];
+                float t, u, v;
+                if (intersectTriangle(triangles[triangle], ray, closest, t, u, v)) {
+                    closest = t;
+                    hit.t = t;
+                    hit.u = u;
+                    hit.v = v;
+                    hit.triangle = triangle;
+                    found = true;
+                }
+            }
+        } else {
+            // Visit the nearer child first; the farther one waits on the stack
+            uint32_t nearChild = node.leftOrFirst;
+            uint32_t farChild = node.leftOrFirst + 1;
+            float nearT = intersectBounds(nodes[nearChild].boundsMin, nodes[nearChild].boundsMax, ray.origin, inverseDirection, closest);
+            float farT = intersectBounds(nodes[farChild].boundsMin, nodes[farChild].boundsMax, ray.origin, inverseDirection, closest);
+            if (farT < nearT) {
+                std::swap(nearChild, farChild);
+                std::swap(nearT, farT);
+            }
+            if (nearT != std::numeric_limits<float>::infinity()) {
+                if (farT != std::numeric_limits<float>::infinity()) {
+                    stack[stackSize++] = farChild;
+                }
+                nodeIndex = nearChild;
+                continue;
+            }
+        }
+
+        if (stackSize == 0) break;
+        nodeIndex = stack[--stackSize];
+    }
+    return found;
+}
+
+bool Bvh::writeScalingReport(const std::string& path, const std::vector<Vertex>& vertices,
+                             const std::vector<uint32_t>& indices, uint32_t maxReplicas) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        LOG_ERROR("❌ Could not write BVH report to " << path);
+        return false;
+    }
+
+    // Replicas sit on a square grid one mesh diameter apart
+    float radius = 0.0f;
+    for (const Vertex& vertex : vertices) {
+        radius = std::max(radius, glm::length(vertex.pos));
+    }
+    float spacing = std::max(radius * 2.0f, 1e-3f);
+
+    out << "{\n";
+    out << "  \"threads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "  \"sizes\": [\n";
+    bool firstEntry = true;
+    for (uint32_t replicas = 1; replicas <= std::max(maxReplicas, 1u); replicas *= 4) {
+        uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(replicas))));
+        std::vector<Vertex> sceneVertices;
+        std::vector<uint32_t> sceneIndices;
+        sceneVertices.reserve(vertices.size() * replicas);
+        sceneIndices.reserve(indices.size() * replicas);
+        for (uint32_t r = 0; r < replicas; r++) {
+            glm::vec3 offset((r % side) * spacing, (r / side) * spacing, 0.0f);
+            uint32_t base = static_cast<uint32_t>(sceneVertices.size());
+            for (Vertex vertex : vertices) {
+                vertex.pos += offset;
+                sceneVertices.push_back(vertex);
+            }
+            for (uint32_t index : indices) {
+                sceneIndices.push_back(base + index);
+            }
+        }
+
+        Bvh parallelBvh;
+        parallelBvh.build(sceneVertices, sceneIndices);
+        BuildOptions serialOptions;
+        serialOptions.parallel = false;
+        Bvh serialBvh;
+        serialBvh.build(sceneVertices, sceneIndices, serialOptions);
+
+        const BuildStats& s = parallelBvh.getStats();
+        out << (firstEntry ? "" : ",\n");
+        out << "    {\"replicas\": " << replicas << ", \"triangles\": " << s.triangleCount
+            << ", \"nodes\": " << s.nodeCount << ", \"leaves\": " << s.leafCount << ", \"maxDepth\": " << s.maxDepth
+            << ", \"sahCost\": " << s.sahCost << ", \"buildMs\": " << s.buildMs
+            << ", \"buildMsSingleThread\": " << serialBvh.getStats().buildMs << "}";
+        firstEntry = false;
+
+        LOG_INFO("🌲 BVH " << s.triangleCount << " triangles: " << s.buildMs << " ms ("
+                 << serialBvh.getStats().buildMs << " ms single-threaded), SAH " << s.sahCost
+                 << ", " << s.nodeCount << " nodes, depth " << s.maxDepth);
+    }
+    out << "\n  ]\n";
+    out << "}\n";
+
+    LOG_INFO("🌲 BVH report written to " << path);
+    return true;
+}
@@ -1,15 +1,114 @@
 #include "ClippyGeometry.h"
+#include "Logger.h"
+#include "AccelerationStructureCache.h"
 #include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <iostream>
+
+void ClippyGeometry::generateClippyParts(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                                         std::vector<Part>& parts, std::vector<PartInstance>& instances) {
+    vertices.clear();
+    indices.clear();
+    parts.clear();
+    instances.clear();
+    
+    // El cuerpo de alambre: all sections share the model frame
+    beginPart(parts, "wire", vertices, indices);
+    createWire(vertices, indices);
+    endPart(parts, vertices, indices);
+    instances.push_back({0, glm::mat4(1.0f), MATERIAL_WIRE});
+    
+    // Unit spheres, placed and scaled by the eye instances
+    uint32_t eyePart = static_cast<uint32_t>(parts.size());
+    beginPart(parts, "eye", vertices, indices);
+    createEyeSphere(vertices, indices, glm::vec3(0.0f), 1.0f, 16, glm::vec3(0.0f, 0.0f, 0.0f));
+    endPart(parts, vertices, indices);
+    
+    uint32_t highlightPart = static_cast<uint32_t>(parts.size());
+    beginPart(parts, "eyeHighlight", vertices, indices);
+    createEyeSphere(vertices, indices, glm::vec3(0.0f), 1.0f, 12, glm::vec3(1.0f, 1.0f, 1.0f));
+    endPart(parts, vertices, indices);
+    
+    // ¡Añadir los ojitos de Clippy! 👀
+    createClippyEyes(instances, eyePart, highlightPart);
+    
+    LOG_INFO("Clippy parts created: " << parts.size() << " parts, " << instances.size() << " instances, "
+             << vertices.size() << " vertices, " << indices.size() << " indices");
+}
 
 void ClippyGeometry::generateClippy(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
-    const glm::vec3 goldColor(1.0f, 0.843f, 0.0f);
-    const float wireRadius = 0.08f;
+    std::vector<Vertex> partVertices;
+    std::vector<uint32_t> partIndices;
+    std::vector<Part> parts;
+    std::vector<PartInstance> instances;
+    generateClippyParts(partVertices, partIndices, parts, instances);
     
     vertices.clear();
     indices.clear();
     
+    for (const PartInstance& instance : instances) {
+        const Part& part = parts[instance.part];
+        glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(instance.transform)));
+        uint32_t baseVertex = static_cast<uint32_t>(vertices.size());
+        
+        for (uint32_t i = 0; i < part.vertexCount; i++) {
+            Vertex vertex = partVertices[part.firstVertex + i];
+            vertex.pos = glm::vec3(instance.transform * glm::vec4(vertex.pos, 1.0f));
+            vertex.normal = glm::normalize(normalMatrix * vertex.normal);
+            vertices.push_back(vertex);
+        }
+        for (uint32_t i = 0; i < part.indexCount; i++) {
+            indices.push_back(baseVertex + partIndices[part.firstIndex + i]);
+        }
+    }
+    
+    LOG_INFO("Clippy geometry created: " << vertices.size() 
+             << " vertices, " << indices.size() << " indices");
+}
+
+void ClippyGeometry::beginPart(std::vector<Part>& parts, const char* name,
+                               const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) {
+    Part part;
+    part.name = name;
+    part.firstVertex = static_cast<uint32_t>(vertices.size());
+    part.firstIndex = static_cast<uint32_t>(indices.size());
+    parts.push_back(part);
+}
+
+void ClippyGeometry::endPart(std::vector<Part>& parts,
+                             const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    Part& part = parts.back();
+    part.vertexCount = static_cast<uint32_t>(vertices.size()) - part.firstVertex;
+    part.indexCount = static_cast<uint32_t>(indices.size()) - part.firstIndex;
+    
+    // The create* helpers emit absolute indices: rebase them on the part
+    for (uint32_t i = part.firstIndex; i < part.firstIndex + part.indexCount; i++) {
+        indices[i] -= part.firstVertex;
+    }
+    
+    // Degenerate triangles never produce hits but still cost BVH nodes and intersection tests
+    part.degenerateTriangles = 0;
+    for (uint32_t i = part.firstIndex; i + 2 < part.firstIndex + part.indexCount; i += 3) {
+        uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        if (a == b || b == c || a == c) {
+            part.degenerateTriangles++;
+            continue;
+        }
+        const glm::vec3& p0 = vertices[part.firstVertex + a].pos;
+        glm::vec3 normal = glm::cross(vertices[part.firstVertex + b].pos - p0, vertices[part.firstVertex + c].pos - p0);
+        if (glm::dot(normal, normal) < 1e-14f) {
+            part.degenerateTriangles++;
+        }
+    }
+    
+    part.contentHash = AccelerationStructureCache::hash(&vertices[part.firstVertex], sizeof(Vertex) * part.vertexCount);
+    part.contentHash = AccelerationStructureCache::hash(&indices[part.firstIndex], sizeof(uint32_t) * part.indexCount,
+                                                        part.contentHash);
+}
+
+void ClippyGeometry::createWire(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    const glm::vec3 goldColor(1.0f, 0.843f, 0.0f);
+    const float wireRadius = 0.08f;
+    
     // Crear la forma icónica del clip con alta resolución
     const int segments = 64; // Alta calidad para ray tracing
     
@@ -101,12 +200,6 @@ void ClippyGeometry::generateClippy(std::vector<Vertex>& vertices, std::vector<u
             }
         }
     }
-    
-    // ¡Añadir los ojitos de Clippy! 👀
-    createClippyEyes(vertices, indices, goldColor);
-    
-    std::cout << "Clippy geometry created: " << vertices.size() 
-              << " vertices, " << indices.size() << " indices" << std::endl;
 }
 
 void ClippyGeometry::createTorusSection(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
@@ -212,31 +305,28 @@ void ClippyGeometry::createBendSection(std::vector<Vertex>& vertices, std::vecto
     // This is a placeholder for future geometric complexity
 }
 
-void ClippyGeometry::createClippyEyes(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, 
-                                      glm::vec3 baseColor) {
+void ClippyGeometry::createClippyEyes(std::vector<PartInstance>& instances, uint32_t eyePart, uint32_t highlightPart) {
     // Posición de los ojos en el Clippy
     glm::vec3 leftEyePos(-0.15f, 0.3f, 0.08f);   // Ojo izquierdo
     glm::vec3 rightEyePos(0.15f, 0.3f, 0.08f);   // Ojo derecho
     
     float eyeRadius = 0.08f;
-    int eyeSegments = 16;
     
-    // Color negro para los ojos
-    glm::vec3 eyeColor(0.0f, 0.0f, 0.0f);
-    // Pequeño brillo blanco
-    glm::vec3 highlightColor(1.0f, 1.0f, 1.0f);
+    auto place = [](glm::vec3 center, float radius) {
+        return glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(radius));
+    };
     
     // Crear ojo izquierdo
-    createEyeSphere(vertices, indices, leftEyePos, eyeRadius, eyeSegments, eyeColor);
+    instances.push_back({eyePart, place(leftEyePos, eyeRadius), MATERIAL_EYE});
     // Highlight más grande y visible en el ojo izquierdo
-    createEyeSphere(vertices, indices, leftEyePos + glm::vec3(0.025f, 0.025f, 0.06f), 
-                    eyeRadius * 0.5f, 12, highlightColor);
+    instances.push_back({highlightPart, place(leftEyePos + glm::vec3(0.025f, 0.025f, 0.06f), eyeRadius * 0.5f),
+                         MATERIAL_HIGHLIGHT});
     
     // Crear ojo derecho  
-    createEyeSphere(vertices, indices, rightEyePos, eyeRadius, eyeSegments, eyeColor);
+    instances.push_back({eyePart, place(rightEyePos, eyeRadius), MATERIAL_EYE});
     // Highlight más grande y visible en el ojo derecho
-    createEyeSphere(vertices, indices, rightEyePos + glm::vec3(-0.025f, 0.025f, 0.06f), 
-                    eyeRadius * 0.5f, 12, highlightColor);
+    instances.push_back({highlightPart, place(rightEyePos + glm::vec3(-0.025f, 0.025f, 0.06f), eyeRadius * 0.5f),
+                         MATERIAL_HIGHLIGHT});
 }
 
 void ClippyGeometry::createEyeSphere(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
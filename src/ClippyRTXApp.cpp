@@ -1,11 +1,15 @@
 #include "ClippyRTXApp.h"
-#include <iostream>
+#include "Logger.h"
+#include "AccelerationStructureReport.h"
+#include <glm/gtc/matrix_inverse.hpp>
 #include <stdexcept>
 #include <cstring>
 #include <set>
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <cstdio>
+#include <filesystem>
 
 // Validation layers para debug
 const std::vector<const char*> validationLayers = {
@@ -50,12 +54,48 @@ void DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT
 }
 
 void ClippyRTXApp::run() {
-    initWindow();
+    if (!headless) {
+        initWindow();
+    }
     initVulkan();
-    mainLoop();
+    if (benchmark) {
+        benchmarkLoop();
+    } else if (headless) {
+        headlessLoop();
+    } else {
+        mainLoop();
+    }
     cleanup();
 }
 
+void ClippyRTXApp::setFramesInFlight(uint32_t count) {
+    framesInFlight = std::clamp(count, 1u, MAX_FRAMES_IN_FLIGHT);
+}
+
+void ClippyRTXApp::setHeadless(const HeadlessOptions& options) {
+    headless = true;
+    headlessOptions = options;
+    headlessOptions.width = std::max(options.width, 1u);
+    headlessOptions.height = std::max(options.height, 1u);
+    windowWidth = static_cast<int>(headlessOptions.width);
+    windowHeight = static_cast<int>(headlessOptions.height);
+    outputFinalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+}
+
+void ClippyRTXApp::setBenchmark(const Benchmark::Options& options) {
+    benchmark = std::make_unique<Benchmark>(options);
+}
+
+void ClippyRTXApp::setTracing(uint32_t tileSize, uint32_t tilesPerFrame) {
+    traceTileSize = tileSize;
+    traceTilesPerFrame = tilesPerFrame;
+}
+
+void ClippyRTXApp::setAnimatedBLAS(bool enabled, uint32_t rebuildInterval) {
+    animatedBLAS = enabled;
+    blasRebuildInterval = std::max(1u, rebuildInterval);
+}
+
 void ClippyRTXApp::initWindow() {
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
@@ -63,6 +103,8 @@ void ClippyRTXApp::initWindow() {
     window = glfwCreateWindow(WIDTH, HEIGHT, "Clippy RTX - Vulkan Ray Tracing", nullptr, nullptr);
     glfwSetWindowUserPointer(window, this);
     glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+    glfwSetWindowSizeCallback(window, windowSizeCallback);
+    glfwGetWindowSize(window, &windowWidth, &windowHeight);
     glfwSetKeyCallback(window, keyCallback);
     glfwSetMouseButtonCallback(window, mouseButtonCallback);
     glfwSetCursorPosCallback(window, cursorPositionCallback);
@@ -73,6 +115,12 @@ void ClippyRTXApp::framebufferResizeCallback(GLFWwindow* window, int width, int
     app->framebufferResized = true;
 }
 
+void ClippyRTXApp::windowSizeCallback(GLFWwindow* window, int width, int height) {
+    auto app = reinterpret_cast<ClippyRTXApp*>(glfwGetWindowUserPointer(window));
+    app->windowWidth = width;
+    app->windowHeight = height;
+}
+
 void ClippyRTXApp::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
     auto app = reinterpret_cast<ClippyRTXApp*>(glfwGetWindowUserPointer(window));
     
@@ -80,53 +128,61 @@ void ClippyRTXApp::keyCallback(GLFWwindow* window, int key, int scancode, int ac
         switch(key) {
             case GLFW_KEY_SPACE:
                 app->rtxEnabled = !app->rtxEnabled;
-                std::cout << "RTX " << (app->rtxEnabled ? "ON" : "OFF") << std::endl;
+                LOG_INFO("RTX " << (app->rtxEnabled ? "ON" : "OFF"));
                 break;
             case GLFW_KEY_1:
                 // IDLE - trigger greeting message
                 if (app->clippyUI) {
                     app->clippyUI->showPersonalityMessage(0);
                 }
-                std::cout << "Clippy: SALUDAR (IDLE)" << std::endl;
+                LOG_INFO("Clippy: SALUDAR (IDLE)");
                 break;
             case GLFW_KEY_2:
                 // EXCITED
                 if (app->clippyUI) {
                     app->clippyUI->showPersonalityMessage(1);
                 }
-                std::cout << "Clippy: EXCITED" << std::endl;
+                LOG_INFO("Clippy: EXCITED");
                 break;
             case GLFW_KEY_3:
                 // QUANTUM
                 if (app->clippyUI) {
                     app->clippyUI->showPersonalityMessage(2);
                 }
-                std::cout << "Clippy: QUANTUM" << std::endl;
+                LOG_INFO("Clippy: QUANTUM");
                 break;
             case GLFW_KEY_4:
                 // PARTY
                 if (app->clippyUI) {
                     app->clippyUI->showPersonalityMessage(3);
                 }
-                std::cout << "Clippy: PARTY" << std::endl;
+                LOG_INFO("Clippy: PARTY");
                 break;
             case GLFW_KEY_5:
                 // HELPING
                 if (app->clippyUI) {
                     app->clippyUI->showPersonalityMessage(4);
                 }
-                std::cout << "Clippy: HELPING" << std::endl;
+                LOG_INFO("Clippy: HELPING");
                 break;
             case GLFW_KEY_6:
                 // THINKING
                 if (app->clippyUI) {
                     app->clippyUI->showPersonalityMessage(5);
                 }
-                std::cout << "Clippy: THINKING" << std::endl;
+                LOG_INFO("Clippy: THINKING");
                 break;
             case GLFW_KEY_R:
                 app->currentAnimationMode = AnimationMode::IDLE;
-                std::cout << "Mode: RESET TO IDLE" << std::endl;
+                LOG_INFO("Mode: RESET TO IDLE");
+                break;
+            case GLFW_KEY_A:
+                app->accumulationEnabled = !app->accumulationEnabled;
+                LOG_INFO("Accumulation " << (app->accumulationEnabled ? "ON" : "OFF"));
+                break;
+            case GLFW_KEY_P:
+                app->animationPaused = !app->animationPaused;
+                LOG_INFO("Animation " << (app->animationPaused ? "PAUSED" : "RESUMED"));
                 break;
             case GLFW_KEY_ESCAPE:
                 glfwSetWindowShouldClose(window, GLFW_TRUE);
@@ -142,7 +198,7 @@ void ClippyRTXApp::mouseButtonCallback(GLFWwindow* window, int button, int actio
         if (action == GLFW_PRESS) {
             app->mousePressed = true;
             app->currentAnimationMode = AnimationMode::EXCITED;
-            std::cout << "Clippy clicked! Mode: EXCITED" << std::endl;
+            LOG_INFO("Clippy clicked! Mode: EXCITED");
         } else if (action == GLFW_RELEASE) {
             app->mousePressed = false;
         }
@@ -158,7 +214,7 @@ void ClippyRTXApp::cursorPositionCallback(GLFWwindow* window, double xpos, doubl
 
 void ClippyRTXApp::updateAnimationMode() {
     // Auto-return to IDLE after some time for most modes
-    static float modeTimer = 0.0f;
+    float& modeTimer = animationModeTimer;
     modeTimer += deltaTime;
     
     switch(currentAnimationMode) {
@@ -205,10 +261,17 @@ void ClippyRTXApp::handleMouseInteraction() {
 void ClippyRTXApp::initVulkan() {
     createInstance();
     setupDebugMessenger();
-    createSurface();
+    if (!headless) {
+        createSurface();
+    }
     pickPhysicalDevice();
     createLogicalDevice();
-    createSwapChain();
+    pipelineCache = std::make_unique<PipelineCache>(device, physicalDevice, "pipeline_cache.bin");
+    if (headless) {
+        createHeadlessTarget();
+    } else {
+        createSwapChain();
+    }
     createImageViews();
     createRenderPass();
     createUIRenderPass();
@@ -223,27 +286,47 @@ void ClippyRTXApp::initVulkan() {
     createClippyGeometry();
     createVertexBuffer();
     createIndexBuffer();
+    createPartBuffers();
     createUniformBuffers();
     createDescriptorPool();
     createDescriptorSets();
     createCommandBuffers();
     createSyncObjects();
     
+    // The CPU reference of the image comparison traces a single Clippy in the rest pose only
+    if (imageComparison && headless && animatedBLAS) {
+        LOG_INFO("Image comparison: animated BLAS off, the CPU reference traces the rest pose");
+        animatedBLAS = false;
+    }
+    if (imageComparison && headless && crowdSize > 1) {
+        LOG_INFO("Image comparison: crowd of " << crowdSize << " reduced to 1, the CPU reference traces one Clippy");
+        crowdSize = 1;
+    }
+    
     // Si la GPU soporta RTX, crear estructuras de aceleración
     if (checkRayTracingSupport()) {
         setupRayTracing();
+    } else if (cpuFallback) {
+        LOG_WARN("Ray Tracing not supported - falling back to the CPU path tracer");
+        setupCpuPathTracer();
     } else {
-        std::cout << "Ray Tracing not supported - falling back to rasterization" << std::endl;
+        LOG_WARN("Ray Tracing not supported - falling back to rasterization");
         rtxEnabled = false;
     }
     
-    // Setup UI system
-    setupUI();
+    if (imageComparison && headless) {
+        setupReferenceTracer();
+    }
+    
+    // Setup UI system (ImGui needs the GLFW window)
+    if (!headless) {
+        setupUI();
+    }
     
     // DISABLED POST-PROCESSING TO DEBUG GOLD COLOR
     // setupPostProcessing();
     
-    std::cout << "All initialization completed, ready to start main loop!" << std::endl;
+    LOG_INFO("All initialization completed, ready to start main loop!");
 }
 
 bool ClippyRTXApp::checkRayTracingSupport() {
@@ -271,7 +354,7 @@ bool ClippyRTXApp::checkRayTracingSupport() {
         }
         if (!found) {
             hasRayTracingExtensions = false;
-            std::cout << "Missing RT extension: " << requiredExt << std::endl;
+            LOG_WARN("Missing RT extension: " << requiredExt);
             break;
         }
     }
@@ -299,34 +382,124 @@ bool ClippyRTXApp::checkRayTracingSupport() {
 
 void ClippyRTXApp::setupRayTracing() {
     rayTracingPipeline = std::make_unique<RayTracingPipeline>(device, physicalDevice, commandPool, graphicsQueue);
-    rayTracingPipeline->createPipeline(descriptorSetLayout);
-    rayTracingPipeline->createAccelerationStructures(vertexBuffer, indexBuffer, 
-                                                     static_cast<uint32_t>(vertices.size()),
-                                                     static_cast<uint32_t>(indices.size()));
+    rayTracingPipeline->createPipeline(descriptorSetLayout, pipelineCache->get());
+    rayTracingPipeline->setBLASCompaction(blasCompaction);
+    rayTracingPipeline->setInstanceSlots(framesInFlight);
+    rayTracingPipeline->setCrowdSize(crowdSize);
+    if (hostASBuildsSupported) {
+        rayTracingPipeline->setHostBuilds(&partVertices, &partIndices);
+    }
+    rayTracingPipeline->setBuildTimestamps(!asReportPath.empty());
+    if (animatedBLAS) {
+        // Only the wire deforms (part 0, first in the vertex buffer); the eyes stay rigid instances
+        const ClippyGeometry::Part& wire = clippyParts[0];
+        std::vector<Vertex> wireVertices(partVertices.begin() + wire.firstVertex,
+                                         partVertices.begin() + wire.firstVertex + wire.vertexCount);
+        deformationPass = std::make_unique<DeformationPass>(device, physicalDevice, commandPool, graphicsQueue,
+                                                            partVertexBuffer, wireVertices, *uniformRing,
+                                                            sizeof(UniformBufferObject), pipelineCache->get());
+        rayTracingPipeline->setAnimatedGeometry(0, deformationPass->getPositionBuffer(),
+                                                DeformationPass::POSITION_STRIDE, blasRebuildInterval);
+    }
+    
+    // Only needed while the acceleration structures are created; saved right away
+    std::unique_ptr<AccelerationStructureCache> asCache;
+    if (asCacheEnabled) {
+        asCache = std::make_unique<AccelerationStructureCache>(device, "as_cache.bin");
+        rayTracingPipeline->setAccelerationStructureCache(asCache.get());
+    }
+    rayTracingPipeline->createAccelerationStructures(partVertexBuffer, partIndexBuffer,
+                                                     clippyParts, clippyPartInstances);
+    if (asCache) {
+        rayTracingPipeline->setAccelerationStructureCache(nullptr);
+        asCache->save();
+    }
+    if (!asReportPath.empty()) {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        AccelerationStructureReport::write(asReportPath, properties.deviceName,
+                                           rayTracingPipeline->getAccelerationStructureStats(),
+                                           partVertices, partIndices, clippyParts);
+    }
     rayTracingPipeline->createShaderBindingTable();
     
     // Update descriptor sets with TLAS for ray tracing
     updateDescriptorSetsWithTLAS();
     
-    std::cout << "Ray Tracing pipeline initialized successfully!" << std::endl;
+    LOG_INFO("Ray Tracing pipeline initialized successfully!");
+}
+
+// No ray tracing hardware: the same shading runs on the CPU against the rest pose of the parts
+void ClippyRTXApp::setupCpuPathTracer() {
+    cpuPathTracer = std::make_unique<CpuPathTracer>(cpuTraceThreads);
+    cpuPathTracer->setPacketTracing(cpuTracePackets);
+    cpuPathTracer->setWavefront(cpuTraceWavefront);
+    cpuPathTracer->setScene(partVertices, partIndices, clippyParts, clippyPartInstances);
+    createCpuTraceUploadBuffers();
+    
+    LOG_INFO("CPU path tracer initialized on " << cpuPathTracer->getThreadCount() << " thread(s)");
+}
+
+// Image comparison: a second CPU tracer renders the same uniforms as the device every frame, so
+// its running average restarts exactly when the device's does
+void ClippyRTXApp::setupReferenceTracer() {
+    if (cpuPathTracer) {
+        LOG_WARN("⚠️  Image comparison on the CPU fallback compares the CPU path tracer with itself");
+    }
+    referenceTracer = std::make_unique<CpuPathTracer>(cpuTraceThreads);
+    referenceTracer->setScene(partVertices, partIndices, clippyParts, clippyPartInstances);
+    std::filesystem::create_directories(std::filesystem::path(headlessOptions.outputDir) / "reference");
+    
+    LOG_INFO("🖼️  CPU reference for image comparison on " << referenceTracer->getThreadCount() << " thread(s)");
+}
+
+// Runs after the frame is submitted (and, in a benchmark, after its CPU time is recorded), so the
+// reference render and the PPM dump never count towards the frame being measured
+void ClippyRTXApp::traceReference() {
+    if (!referencePending) {
+        return;
+    }
+    referencePending = false;
+    
+    referenceTracer->render(referenceUniforms, swapChainExtent.width, swapChainExtent.height);
+    if (isSavedHeadlessFrame()) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "frame_%05u.ppm", headlessFrame);
+        referenceTracer->writePPM((std::filesystem::path(headlessOptions.outputDir) / "reference" / name).string());
+    }
+}
+
+void ClippyRTXApp::compareWithReference() {
+    std::filesystem::path outputDir(headlessOptions.outputDir);
+    comparePassed = ImageCompare::compareDirectories((outputDir / "reference").string(), outputDir.string(),
+                                                     (outputDir / "compare").string(),
+                                                     (outputDir / "image_compare.json").string(), compareThresholds);
 }
 
 void ClippyRTXApp::createClippyGeometry() {
     // Now restore the full Clippy geometry
     ClippyGeometry::generateClippy(vertices, indices);
-    std::cout << "Clippy geometry restored: " << vertices.size() 
-              << " vertices, " << indices.size() << " indices" << std::endl;
+    LOG_INFO("Clippy geometry restored: " << vertices.size() 
+             << " vertices, " << indices.size() << " indices");
+    
+    // Ray tracing keeps the parts separate (one BLAS each, eyes instanced)
+    ClippyGeometry::generateClippyParts(partVertices, partIndices, clippyParts, clippyPartInstances);
+    
+    clippyBoundingRadius = 0.0f;
+    for (const Vertex& vertex : vertices) {
+        clippyBoundingRadius = std::max(clippyBoundingRadius, glm::length(vertex.pos));
+    }
 }
 
 void ClippyRTXApp::mainLoop() {
-    std::cout << "Entering main loop..." << std::endl;
+    LOG_INFO("Entering main loop...");
     
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
         
         // Calcular delta time
         float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
+        deltaTime = animationPaused ? 0.0f : currentFrame - lastFrame;
         lastFrame = currentFrame;
         totalTime += deltaTime;
         frameCount++;
@@ -343,118 +516,229 @@ void ClippyRTXApp::mainLoop() {
     vkDeviceWaitIdle(device);
 }
 
-void ClippyRTXApp::drawFrame() {
-    // Debug output removed
-    
-    vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
-    
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, 
-        imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+void ClippyRTXApp::headlessLoop() {
+    LOG_INFO("Rendering " << headlessOptions.frameCount << " headless frames ("
+             << headlessOptions.width << "x" << headlessOptions.height << ")...");
+    
+    for (headlessFrame = 0; headlessFrame < headlessOptions.frameCount; headlessFrame++) {
+        stepFixedFrame(1.0f / 60.0f);
+        if (referenceTracer) {
+            traceReference();
+        }
+        
+        LOG_INFO_EVERY_MS(1000, "   frame " << headlessFrame + 1 << "/" << headlessOptions.frameCount);
+    }
     
-    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        recreateSwapChain();
-        return;
-    } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-        throw std::runtime_error("failed to acquire swap chain image!");
+    vkDeviceWaitIdle(device);
+    headlessTarget->flush();
+    if (referenceTracer) {
+        compareWithReference();
+    }
+}
+
+// Fixed timestep: the same frame number always shows the same animation state
+void ClippyRTXApp::stepFixedFrame(float timestep) {
+    deltaTime = timestep;
+    totalTime += deltaTime;
+    frameCount++;
+    
+    if (benchmark) {
+        applyBenchmarkScript();
     }
     
-    updateUniformBuffer(currentFrame);
+    updateAnimationMode();
+    updatePostProcessing();
     
-    // Proper fence synchronization for RTX performance
-    vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    drawFrame();
+}
+
+void ClippyRTXApp::applyBenchmarkScript() {
+    Benchmark::ScriptState state = benchmark->evaluate(totalTime);
     
-    if (imagesInFlight[imageIndex] != VK_NULL_HANDLE) {
-        vkWaitForFences(device, 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
-    }
-    imagesInFlight[imageIndex] = inFlightFences[currentFrame];
+    cameraScripted = state.hasCamera;
+    scriptedCameraPos = state.cameraPos;
+    scriptedCameraTarget = state.cameraTarget;
     
-    vkResetFences(device, 1, &inFlightFences[currentFrame]);
+    if (state.personalityMode >= 0) {
+        personalityScripted = true;
+        personalityMode = state.personalityMode;
+    }
+    if (state.rtxEnabled >= 0) {
+        rtxEnabled = state.rtxEnabled == 1 && (rayTracingPipeline || cpuPathTracer);
+    }
+}
+
+void ClippyRTXApp::benchmarkLoop() {
+    const Benchmark::Options& options = benchmark->getOptions();
+    uint32_t totalFrames = benchmark->totalFrames();
+    headlessOptions.frameCount = totalFrames;  // Headless frame saving counts the whole run
+    
+    LOG_INFO("📈 Running benchmark (" << swapChainExtent.width << "x" << swapChainExtent.height
+             << (headless ? ", headless" : "") << ")...");
+    
+    for (headlessFrame = 0; headlessFrame < totalFrames; headlessFrame++) {
+        if (!headless) {
+            glfwPollEvents();
+            if (glfwWindowShouldClose(window)) {
+                LOG_WARN("⚠️  Benchmark aborted: window closed");
+                break;
+            }
+        }
+        
+        // GPU results arrive framesInFlight frames late, so the last warmup frames may
+        // land in the capture too - negligible against N measured frames
+        if (headlessFrame == options.warmupFrames) {
+            gpuProfiler->captureScope("frame", &benchmark->gpuFrameSamples());
+            gpuProfiler->captureScope("traceRays", &benchmark->gpuTraceRaysSamples());
+            gpuProfiler->captureScope("tlasUpdate", &benchmark->gpuTlasUpdateSamples());
+        }
+        
+        auto frameStart = std::chrono::steady_clock::now();
+        stepFixedFrame(options.timestep);
+        double cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        
+        if (headlessFrame >= options.warmupFrames) {
+            benchmark->recordCpuFrame(cpuMs);
+            benchmark->sampleDeviceMemory(physicalDevice, memoryBudgetSupported);
+            if (rayTracingPipeline) {
+                benchmark->recordInstanceFill(rayTracingPipeline->getLastInstanceFillMs());
+            }
+        }
+        if (referenceTracer) {
+            traceReference();
+        }
+        
+        LOG_INFO_EVERY_MS(1000, "   frame " << headlessFrame + 1 << "/" << totalFrames);
+    }
     
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    vkDeviceWaitIdle(device);
+    gpuProfiler->collectAll();
+    gpuProfiler->captureScope("frame", nullptr);
+    gpuProfiler->captureScope("traceRays", nullptr);
+    gpuProfiler->captureScope("tlasUpdate", nullptr);
+    if (headlessTarget) {
+        headlessTarget->flush();
+    }
+    if (referenceTracer) {
+        compareWithReference();
+    }
     
-    VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = waitSemaphores;
-    submitInfo.pWaitDstStageMask = waitStages;
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    // traceRays covers one tile batch per frame when the launch is spread over several frames
+    uint64_t primaryRaysPerFrame = tileScheduler.averagePixelsPerBatch() * currentSamplesPerPixel;
+    if (rayTracingPipeline) {
+        benchmark->setTLASStats(rayTracingPipeline->getInstanceCount(), rayTracingPipeline->getTLASBuildMs());
+    }
+    benchmark->writeReport(properties.deviceName, swapChainExtent, primaryRaysPerFrame);
+}
+
+void ClippyRTXApp::drawFrame() {
+    // The watchdog saw VK_ERROR_DEVICE_LOST: nothing submitted from here on would ever complete
+    if (gpuWatchdog && gpuWatchdog->deviceLost()) {
+        throw std::runtime_error("GPU device lost (reported by the watchdog) - stopping after frame "
+                                 + std::to_string(frameCount) + "!");
+    }
     
-    // Create fresh command buffer for each frame
+    // Single CPU wait point: the GPU must have finished the last frame that used this slot
+    // (its command pool, uniform buffer and descriptor set). With N frames in flight this
+    // only blocks when the CPU is N frames ahead of the GPU.
+    uint64_t slotValue = frameSlotTimelineValues[currentFrame];
+    if (slotValue > 0) {
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &frameTimeline;
+        waitInfo.pValues = &slotValue;
+        
+        if (vkWaitSemaphores(device, &waitInfo, UINT64_MAX) != VK_SUCCESS) {
+            throw std::runtime_error("failed to wait for frame timeline semaphore!");
+        }
+    }
     
-    // For now, let's just submit an empty command buffer to test the pipeline
-    VkCommandBuffer tempCmdBuffer;
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.commandPool = commandPool;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = 1;
+    uint32_t imageIndex;
+    VkResult result = VK_SUCCESS;
+    if (headless) {
+        // One offscreen image per slot: the wait above also covers its pending readback
+        imageIndex = static_cast<uint32_t>(currentFrame);
+        headlessTarget->collect(imageIndex);
+    } else {
+        result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, 
+            imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+        
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            recreateSwapChain();
+            return;
+        } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+            throw std::runtime_error("failed to acquire swap chain image!");
+        }
+    }
     
-    if (vkAllocateCommandBuffers(device, &allocInfo, &tempCmdBuffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate temporary command buffer!");
+    updateUniformBuffer(currentFrame);
+    if (postProcessing) {
+        postProcessing->updateUniforms(currentFrame, totalTime);
     }
     
+    // Nothing in this slot's pool is still in use: reset the whole pool and
+    // re-record the pre-allocated primary buffer
+    vkResetCommandPool(device, frameCommandPools[currentFrame], 0);
+    VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
+    
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     
-    if (vkBeginCommandBuffer(tempCmdBuffer, &beginInfo) != VK_SUCCESS) {
-        throw std::runtime_error("failed to begin recording temporary command buffer!");
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording command buffer!");
     }
     
+    // Collects this slot's timestamps from N frames ago and resets its queries
+    gpuProfiler->beginFrame(commandBuffer, currentFrame);
+    gpuProfiler->beginScope(commandBuffer, "frame");
+    
     // 🔥 PURE RTX RENDERING - REAL RAY TRACING! 🔥
     if (rtxEnabled && rayTracingPipeline) {
-        std::cout << "🔥 EXECUTING REAL RAY TRACING DISPATCH WITH TLAS! 🔥" << std::endl;
-        std::cout << "   - Resolution: " << swapChainExtent.width << "x" << swapChainExtent.height << std::endl;
+        LOG_TRACE("🔥 EXECUTING REAL RAY TRACING DISPATCH WITH TLAS! 🔥");
+        LOG_TRACE("   - Resolution: " << swapChainExtent.width << "x" << swapChainExtent.height);
+        
+        if (deformationPass) {
+            GpuProfiler::Scope scope(gpuProfiler.get(), commandBuffer, "blasRefit");
+            recordBLASUpdate(commandBuffer);
+        }
+        {
+            GpuProfiler::Scope scope(gpuProfiler.get(), commandBuffer, "tlasUpdate");
+            rayTracingPipeline->recordInstanceUpdate(commandBuffer, static_cast<uint32_t>(currentFrame),
+                                                     instanceTransform, instanceTime);
+        }
         
         // Step 1: Execute ray tracing OUTSIDE render pass (writes to storage images)
-        rayTracingPipeline->traceRays(tempCmdBuffer, swapChainExtent.width, swapChainExtent.height, 
-                                     descriptorSets[currentFrame]);
+        prepareRTStorageImages(commandBuffer);
+        {
+            GpuProfiler::Scope scope(gpuProfiler.get(), commandBuffer, "traceRays");
+            rayTracingPipeline->traceRays(commandBuffer, swapChainExtent.width, swapChainExtent.height, 
+                                         descriptorSets[currentFrame],
+                                         uniformRing->dynamicOffset(sceneUniformBlock, currentFrame),
+                                         tileScheduler.nextBatch());
+        }
         
         // Step 2: Copy RT output image to swapchain image for display
-        copyRTOutputToSwapchain(tempCmdBuffer, imageIndex);
-        
-        // Step 3: Transition image layout for UI rendering
-        VkImageMemoryBarrier uiLayoutTransition{};
-        uiLayoutTransition.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        uiLayoutTransition.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-        uiLayoutTransition.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-        uiLayoutTransition.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        uiLayoutTransition.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        uiLayoutTransition.image = swapChainImages[imageIndex];
-        uiLayoutTransition.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        uiLayoutTransition.subresourceRange.baseMipLevel = 0;
-        uiLayoutTransition.subresourceRange.levelCount = 1;
-        uiLayoutTransition.subresourceRange.baseArrayLayer = 0;
-        uiLayoutTransition.subresourceRange.layerCount = 1;
-        uiLayoutTransition.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        uiLayoutTransition.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-        
-        vkCmdPipelineBarrier(tempCmdBuffer,
-                           VK_PIPELINE_STAGE_TRANSFER_BIT,
-                           VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                           0, 0, nullptr, 0, nullptr, 1, &uiLayoutTransition);
-        
-        // Step 4: Add render pass for UI overlay on top of RTX (PRESERVE RTX!)
-        VkRenderPassBeginInfo renderPassInfo{};
-        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassInfo.renderPass = renderPass;  // Use main render pass (ImGui compatible)
-        renderPassInfo.framebuffer = swapChainFramebuffers[imageIndex];  // Use main framebuffers
-        renderPassInfo.renderArea.offset = {0, 0};
-        renderPassInfo.renderArea.extent = swapChainExtent;
-        // Use a dummy clear value but the render pass will LOAD content anyway
-        VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
-        renderPassInfo.clearValueCount = 1;
-        renderPassInfo.pClearValues = &clearColor;
+        {
+            GpuProfiler::Scope scope(gpuProfiler.get(), commandBuffer, "copyToSwapchain");
+            copyRTOutputToSwapchain(commandBuffer, imageIndex);
+        }
         
-        // RTX path: No UI overlay - pure RTX experience
+        // RTX path: No UI overlay - pure RTX experience. The copy leaves the output image
+        // in its final layout (PRESENT_SRC, or TRANSFER_SRC when headless)
         // UI is handled by rasterization path when RTX is disabled
         
-        // End the command buffer for RTX path
-        if (vkEndCommandBuffer(tempCmdBuffer) != VK_SUCCESS) {
-            throw std::runtime_error("failed to end RTX command buffer!");
+        gpuProfiler->endScope(commandBuffer);  // frame
+    } else if (rtxEnabled && cpuPathTracer) {
+        // CPU path tracer: the frame was traced in updateUniformBuffer, only the upload is recorded
+        {
+            GpuProfiler::Scope scope(gpuProfiler.get(), commandBuffer, "cpuTraceUpload");
+            recordCpuTraceUpload(commandBuffer, imageIndex);
         }
-        std::cout << "✅ RTX command buffer completed successfully!" << std::endl;
+        gpuProfiler->endScope(commandBuffer);  // frame
     } else {
         // Fallback Rasterization Path
         std::array<VkClearValue, 2> clearValues{};
@@ -470,10 +754,11 @@ void ClippyRTXApp::drawFrame() {
         renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
         renderPassInfo.pClearValues = clearValues.data();
         
-        vkCmdBeginRenderPass(tempCmdBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        gpuProfiler->beginScope(commandBuffer, "raster");
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
         
         // Traditional rasterization
-        vkCmdBindPipeline(tempCmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
         
         VkViewport viewport{};
         viewport.x = 0.0f;
@@ -482,95 +767,108 @@ void ClippyRTXApp::drawFrame() {
         viewport.height = static_cast<float>(swapChainExtent.height);
         viewport.minDepth = 0.0f;
         viewport.maxDepth = 1.0f;
-        vkCmdSetViewport(tempCmdBuffer, 0, 1, &viewport);
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
         
         VkRect2D scissor{};
         scissor.offset = {0, 0};
         scissor.extent = swapChainExtent;
-        vkCmdSetScissor(tempCmdBuffer, 0, 1, &scissor);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
         
         VkBuffer vertexBuffers[] = {vertexBuffer};
         VkDeviceSize offsets[] = {0};
-        vkCmdBindVertexBuffers(tempCmdBuffer, 0, 1, vertexBuffers, offsets);
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
         
-        vkCmdBindIndexBuffer(tempCmdBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
         
-        vkCmdBindDescriptorSets(tempCmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, 
-                               &descriptorSets[currentFrame], 0, nullptr);
+        uint32_t uniformOffset = uniformRing->dynamicOffset(sceneUniformBlock, currentFrame);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, 
+                               &descriptorSets[currentFrame], 1, &uniformOffset);
         
-        vkCmdDrawIndexed(tempCmdBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
         
         // UI OVERLAY - preserve RTX content
-        renderUI(tempCmdBuffer);
-        
-        vkCmdEndRenderPass(tempCmdBuffer);
-        
-        // End command buffer for rasterization path
-        if (vkEndCommandBuffer(tempCmdBuffer) != VK_SUCCESS) {
-            throw std::runtime_error("failed to record rasterization command buffer!");
+        {
+            GpuProfiler::Scope scope(gpuProfiler.get(), commandBuffer, "ui");
+            renderUI(commandBuffer);
         }
-        std::cout << "✅ Rasterization command buffer completed successfully!" << std::endl;
+        
+        vkCmdEndRenderPass(commandBuffer);
+        gpuProfiler->endScope(commandBuffer);  // raster
+        gpuProfiler->endScope(commandBuffer);  // frame
     }
     
-    // Command buffer ready
+    // Headless: copy the finished image to this slot's readback buffer (written to disk
+    // when the slot is reused, never waited on here)
+    if (headless && isSavedHeadlessFrame()) {
+        headlessTarget->recordReadback(commandBuffer, imageIndex, headlessFrame);
+    }
     
-    submitInfo.commandBufferCount = 1;
-    // Use the temporary command buffer instead of the problematic one
-    submitInfo.pCommandBuffers = &tempCmdBuffer;
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+    LOG_TRACE("✅ " << (rtxEnabled && rayTracingPipeline ? "RTX" : "Rasterization")
+              << " command buffer completed successfully!");
     
-    VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = signalSemaphores;
+    // Submit: wait for the acquired image, signal the present semaphore for this image
+    // and advance the frame timeline. Headless only signals the timeline.
+    uint64_t signalValue = ++frameTimelineValue;
+    uint32_t waitCount = headless ? 0 : 1;
+    uint32_t signalCount = headless ? 1 : 2;
     
-    vkResetFences(device, 1, &inFlightFences[currentFrame]);
+    VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
+    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+    uint64_t waitValues[] = {0};  // Binary semaphore: value ignored
     
-    // 🔧 ENHANCED GPU HANG DETECTION WITH TIMEOUT MONITORING
-    #ifdef ENABLE_RAY_TRACING_DEBUG
-    auto submitStartTime = std::chrono::high_resolution_clock::now();
-    std::cout << "⏱️  Submitting command buffer with timeout monitoring..." << std::endl;
-    #endif
+    VkSemaphore signalSemaphores[] = {frameTimeline, VK_NULL_HANDLE};
+    uint64_t signalValues[] = {signalValue, 0};
+    if (!headless) {
+        signalSemaphores[1] = renderFinishedSemaphores[imageIndex];
+    }
     
-    VkResult submitResult = vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]);
+    VkTimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineSubmitInfo.waitSemaphoreValueCount = waitCount;
+    timelineSubmitInfo.pWaitSemaphoreValues = waitValues;
+    timelineSubmitInfo.signalSemaphoreValueCount = signalCount;
+    timelineSubmitInfo.pSignalSemaphoreValues = signalValues;
+    
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineSubmitInfo;
+    submitInfo.waitSemaphoreCount = waitCount;
+    submitInfo.pWaitSemaphores = waitSemaphores;
+    submitInfo.pWaitDstStageMask = waitStages;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = signalCount;
+    submitInfo.pSignalSemaphores = signalSemaphores;
+    
+    VkResult submitResult = vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
     if (submitResult != VK_SUCCESS) {
-        #ifdef ENABLE_RAY_TRACING_DEBUG
-        std::cerr << "💥 QUEUE SUBMIT FAILED with result: " << submitResult << std::endl;
+        LOG_ERROR("💥 QUEUE SUBMIT FAILED with result: " << submitResult);
         if (submitResult == VK_ERROR_DEVICE_LOST) {
-            std::cerr << "🚨 DEVICE LOST - Possible GPU hang or driver crash!" << std::endl;
+            LOG_ERROR("🚨 DEVICE LOST - Possible GPU hang or driver crash!");
         }
-        #endif
         throw std::runtime_error("failed to submit draw command buffer!");
     }
     
-    #ifdef ENABLE_RAY_TRACING_DEBUG
-    auto submitEndTime = std::chrono::high_resolution_clock::now();
-    auto submitDuration = std::chrono::duration_cast<std::chrono::milliseconds>(submitEndTime - submitStartTime);
-    std::cout << "✅ Command buffer submitted in " << submitDuration.count() << "ms" << std::endl;
-    
-    // Monitor fence wait time with timeout
-    auto fenceWaitStart = std::chrono::high_resolution_clock::now();
-    VkResult fenceResult = vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, 2000000000); // 2 second timeout
-    auto fenceWaitEnd = std::chrono::high_resolution_clock::now();
-    auto fenceWaitDuration = std::chrono::duration_cast<std::chrono::milliseconds>(fenceWaitEnd - fenceWaitStart);
-    
-    if (fenceResult == VK_TIMEOUT) {
-        std::cerr << "⚠️  FENCE TIMEOUT after 2 seconds - Possible GPU hang!" << std::endl;
-        std::cerr << "   Ray tracing dispatch might be stuck in infinite loop" << std::endl;
-        std::cerr << "   Check shader recursion limits and termination conditions" << std::endl;
-        // Don't throw - let it continue and see validation layer output
-    } else if (fenceResult == VK_SUCCESS) {
-        std::cout << "🔄 GPU work completed in " << fenceWaitDuration.count() << "ms" << std::endl;
-        if (fenceWaitDuration.count() > 500) {
-            std::cout << "⚠️  High GPU execution time - monitoring for hangs" << std::endl;
-        }
-    } else {
-        std::cerr << "💥 FENCE WAIT FAILED with result: " << fenceResult << std::endl;
+    frameSlotTimelineValues[currentFrame] = signalValue;
+    
+    // Hang detection runs on the watchdog thread; the render loop moves straight on to
+    // recording the next frame while the GPU executes this one
+    if (gpuWatchdog) {
+        gpuWatchdog->frameSubmitted(signalValue);
+    }
+    
+    if (headless) {
+        currentFrame = (currentFrame + 1) % framesInFlight;
+        return;
     }
-    #endif
     
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
+    presentInfo.pWaitSemaphores = &renderFinishedSemaphores[imageIndex];
     
     VkSwapchainKHR swapChains[] = {swapChain};
     presentInfo.swapchainCount = 1;
@@ -586,7 +884,7 @@ void ClippyRTXApp::drawFrame() {
         throw std::runtime_error("failed to present swap chain image!");
     }
     
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    currentFrame = (currentFrame + 1) % framesInFlight;
 }
 
 void ClippyRTXApp::updateUniformBuffer(uint32_t currentImage) {
@@ -666,24 +964,39 @@ void ClippyRTXApp::updateUniformBuffer(uint32_t currentImage) {
         cameraHeight,
         cos(totalTime * cameraSpeed) * cameraRadius
     );
+    glm::vec3 cameraTarget = glm::vec3(0.0f, 0.0f, 0.0f);
     
-    ubo.view = glm::lookAt(cameraPos, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-    ubo.proj = glm::perspective(glm::radians(60.0f), 
-        swapChainExtent.width / static_cast<float>(swapChainExtent.height), 0.1f, 100.0f);
-    ubo.proj[1][1] *= -1;
+    // Benchmark script overrides the orbit
+    if (cameraScripted) {
+        cameraPos = scriptedCameraPos;
+        cameraTarget = scriptedCameraTarget;
+    }
+    
+    ubo.view = glm::lookAt(cameraPos, cameraTarget, glm::vec3(0.0f, 1.0f, 0.0f));
+    if (ubo.view != cachedView) {
+        cachedView = ubo.view;
+        cachedViewInverse = glm::affineInverse(ubo.view);  // lookAt is rigid: no general 4x4 inverse needed
+    }
     
-    ubo.viewInverse = glm::inverse(ubo.view);
-    ubo.projInverse = glm::inverse(ubo.proj);
+    // Projection only depends on the swapchain extent
+    if (swapChainExtent.width != cachedProjExtent.width || swapChainExtent.height != cachedProjExtent.height) {
+        cachedProjExtent = swapChainExtent;
+        cachedProj = glm::perspective(glm::radians(60.0f), 
+            swapChainExtent.width / static_cast<float>(swapChainExtent.height), 0.1f, 100.0f);
+        cachedProj[1][1] *= -1;
+        cachedProjInverse = glm::inverse(cachedProj);
+    }
+    ubo.proj = cachedProj;
+    
+    ubo.viewInverse = cachedViewInverse;
+    ubo.projInverse = cachedProjInverse;
     ubo.cameraPos = cameraPos;
     ubo.time = totalTime;
     ubo.metallic = clippyMaterial.metallic;
     ubo.roughness = clippyMaterial.roughness;
     ubo.rtxEnabled = rtxEnabled ? 1 : 0;
     
-    // New advanced fields
-    int windowWidth, windowHeight;
-    glfwGetWindowSize(window, &windowWidth, &windowHeight);
-    
+    // New advanced fields (window size cached by windowSizeCallback)
     ubo.mousePos = glm::vec2(
         static_cast<float>(mouseX) / static_cast<float>(windowWidth),
         1.0f - static_cast<float>(mouseY) / static_cast<float>(windowHeight)
@@ -711,15 +1024,14 @@ void ClippyRTXApp::updateUniformBuffer(uint32_t currentImage) {
     ubo.subsurfaceScattering = 0.4f;  // SSS strength (40% for subtle effect)
     ubo.subsurfaceRadius = 0.8f;      // SSS penetration distance
     
-    // 🎭 PERSONALITY SYSTEM INITIALIZATION
-    static int personalityMode = 0; // Start in IDLE mode
-    static float modeTimer = 0.0f;
-    modeTimer += 0.016f; // ~60fps timer
-    
-    // Mode switching logic (demo automatic mode changes)
-    if (modeTimer > 8.0f) { // Change mode every 8 seconds for demo
-        personalityMode = (personalityMode + 1) % 6; // Cycle through 6 modes
-        modeTimer = 0.0f;
+    // 🎭 PERSONALITY SYSTEM - advances with the frame delta (fixed timestep in benchmark/headless)
+    // Mode switching logic (demo automatic mode changes) unless a benchmark script drives it
+    if (!personalityScripted) {
+        personalityTimer += deltaTime;
+        if (personalityTimer > 8.0f) { // Change mode every 8 seconds for demo
+            personalityMode = (personalityMode + 1) % 6; // Cycle through 6 modes
+            personalityTimer = 0.0f;
+        }
     }
     
     ubo.personalityMode = personalityMode;
@@ -797,34 +1109,122 @@ void ClippyRTXApp::updateUniformBuffer(uint32_t currentImage) {
         ubo.glowIntensity = 3.0f + sin(totalTime * 10.0f) * 0.5f;
     }
     
-    void* data;
-    vkMapMemory(device, uniformBuffersMemory[currentImage], 0, sizeof(ubo), 0, &data);
-    memcpy(data, &ubo, sizeof(ubo));
-    vkUnmapMemory(device, uniformBuffersMemory[currentImage]);
+    currentSamplesPerPixel = static_cast<uint32_t>(ubo.samplesPerPixel);
+    instanceTransform = ubo.model;
+    instanceTime = ubo.time;
+    deformAnimationStrength = ubo.animationStrength;
+    deformGlitchIntensity = ubo.glitchIntensity;
+    updateAccumulation(ubo);
+    updateTraceTiles(ubo);
+    uniformRing->write(sceneUniformBlock, currentImage, &ubo, sizeof(ubo));
+    
+    // This slot's upload buffer is free again: the timeline wait for the slot already happened
+    if (rtxEnabled && cpuPathTracer) {
+        cpuPathTracer->render(ubo, swapChainExtent.width, swapChainExtent.height);
+        std::memcpy(cpuTraceUploadMapped[currentImage], cpuPathTracer->getPixels().data(),
+               cpuPathTracer->getPixels().size());
+    }
+    
+    // Rasterized frames get no reference and fail the comparison; traceReference renders it
+    // outside the timed frame
+    if (rtxEnabled && referenceTracer) {
+        referenceUniforms = ubo;
+        referencePending = true;
+    }
+}
+
+// 🧮 Progressive accumulation: raygen averages this frame into rtAccumulationImage with weight
+// 1/(n+1). Anything that moves the image restarts the average, otherwise old frames would ghost.
+void ClippyRTXApp::updateAccumulation(UniformBufferObject& ubo) {
+    bool extentChanged = swapChainExtent.width != accumulationExtent.width ||
+                         swapChainExtent.height != accumulationExtent.height;
+    bool restart = !accumulationEnabled || !rtxEnabled || (rayTracingPipeline && rtStorageImagesNeedInit) ||
+                   extentChanged ||
+                   ubo.view != accumulationView || ubo.model != accumulationModel ||
+                   personalityMode != accumulationPersonality;
+    
+    if (restart) {
+        accumulationFrame = 0;
+        accumulationView = ubo.view;
+        accumulationModel = ubo.model;
+        accumulationPersonality = personalityMode;
+        accumulationExtent = swapChainExtent;
+    }
+    
+    ubo.accumulationFrame = static_cast<int>(accumulationFrame);
+    if (accumulationEnabled && rtxEnabled) {
+        accumulationFrame++;
+    }
+    
+    LOG_DEBUG_EVERY_MS(2000, "🧮 Accumulated frames: " << accumulationFrame);
+}
+
+// Keeps the tile layout in sync with the extent and points the cost estimate at Clippy's
+// projected bounding sphere: tiles over the model trace bounces and shadows, the rest only miss
+void ClippyRTXApp::updateTraceTiles(const UniformBufferObject& ubo) {
+    tileScheduler.configure(swapChainExtent, traceTileSize, traceTilesPerFrame);
+    if (ubo.accumulationFrame == 0) {
+        tileScheduler.restartAccumulation();
+    }
+    if (!tileScheduler.isTiled()) return;
+    
+    glm::vec4 center = ubo.proj * ubo.view * ubo.model * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    if (center.w <= 0.0f) {
+        tileScheduler.setHotRegion(0.0f, 0.0f, 0.0f, 0.0f, 0.0f);   // Behind the camera: all misses
+        return;
+    }
+    
+    float width = static_cast<float>(swapChainExtent.width);
+    float height = static_cast<float>(swapChainExtent.height);
+    glm::vec2 ndc = glm::vec2(center) / center.w;
+    glm::vec2 screen = (ndc * 0.5f + 0.5f) * glm::vec2(width, height);
+    float radius = clippyBoundingRadius * std::abs(ubo.proj[1][1]) / center.w * 0.5f * height;
+    
+    tileScheduler.setHotRegion(screen.x - radius, screen.y - radius, screen.x + radius, screen.y + radius,
+                               static_cast<float>(ubo.maxBounces + 2));
+}
+
+// 🦴 Deforms Clippy on the GPU and refits the BLAS to it. A refit keeps the tree of the last full
+// build, so a new personality (different motion) rebuilds right away, and strong animations that
+// stretch the boxes far from the rest pose rebuild more often than the regular interval.
+void ClippyRTXApp::recordBLASUpdate(VkCommandBuffer commandBuffer) {
+    float displacement = DeformationPass::maxDisplacement(personalityMode, deformAnimationStrength,
+                                                          deformGlitchIntensity, clippyBoundingRadius);
+    bool largeDeformation = displacement > 0.1f * clippyBoundingRadius &&
+                            framesSinceBLASRebuild >= std::max(1u, blasRebuildInterval / 4);
+    bool forceRebuild = personalityMode != blasBuiltPersonality || largeDeformation;
+    
+    deformationPass->record(commandBuffer, uniformRing->dynamicOffset(sceneUniformBlock, currentFrame));
+    if (rayTracingPipeline->recordGeometryUpdate(commandBuffer, forceRebuild)) {
+        framesSinceBLASRebuild = 0;
+        blasBuiltPersonality = personalityMode;
+    } else {
+        framesSinceBLASRebuild++;
+    }
 }
 
 void ClippyRTXApp::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
-    std::cout << "Starting recordCommandBuffer..." << std::endl;
+    LOG_DEBUG("Starting recordCommandBuffer...");
     
     // Check if command buffer is valid
     if (commandBuffer == VK_NULL_HANDLE) {
-        std::cout << "ERROR: Command buffer is null!" << std::endl;
+        LOG_ERROR("ERROR: Command buffer is null!");
         return;
     }
-    std::cout << "Command buffer is valid (not null)" << std::endl;
+    LOG_DEBUG("Command buffer is valid (not null)");
     
     // Don't reset - use ONE_TIME_SUBMIT instead
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     
-    std::cout << "About to begin command buffer..." << std::endl;
+    LOG_DEBUG("About to begin command buffer...");
     
     if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
         throw std::runtime_error("failed to begin recording command buffer!");
     }
     
-    std::cout << "Command buffer begin successful!" << std::endl;
+    LOG_DEBUG("Command buffer begin successful!");
     
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -845,8 +1245,8 @@ void ClippyRTXApp::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t i
     // Debug: Print render area
     static bool debugRenderArea = false;
     if (!debugRenderArea) {
-        std::cout << "Render area: " << renderPassInfo.renderArea.extent.width 
-                  << "x" << renderPassInfo.renderArea.extent.height << std::endl;
+        LOG_DEBUG("Render area: " << renderPassInfo.renderArea.extent.width 
+                 << "x" << renderPassInfo.renderArea.extent.height);
         debugRenderArea = true;
     }
     
@@ -856,7 +1256,7 @@ void ClippyRTXApp::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t i
         // For now, fall back to rasterization
     }
     
-    std::cout << "About to bind graphics pipeline..." << std::endl;
+    LOG_DEBUG("About to bind graphics pipeline...");
     
     // Rasterization rendering
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
@@ -881,13 +1281,14 @@ void ClippyRTXApp::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t i
     
     vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
     
+    uint32_t uniformOffset = uniformRing->dynamicOffset(sceneUniformBlock, currentFrame);
     vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, 
-                           &descriptorSets[currentFrame], 0, nullptr);
+                           &descriptorSets[currentFrame], 1, &uniformOffset);
     
     // Debug output
     static bool debugPrinted = false;
     if (!debugPrinted) {
-        std::cout << "Drawing " << indices.size() << " indices..." << std::endl;
+        LOG_DEBUG("Drawing " << indices.size() << " indices...");
         debugPrinted = true;
     }
     
@@ -968,10 +1369,14 @@ bool ClippyRTXApp::checkValidationLayerSupport() {
 }
 
 std::vector<const char*> ClippyRTXApp::getRequiredExtensions() {
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    std::vector<const char*> extensions;
     
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    // Headless needs no surface extensions (and GLFW is never initialized)
+    if (!headless) {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
     
     if (enableValidationLayers) {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -990,7 +1395,7 @@ void ClippyRTXApp::populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateI
                                 VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
                                 VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | 
                                 VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
-    std::cout << "🔧 Enhanced Ray Tracing Debug Mode ENABLED" << std::endl;
+    LOG_INFO("🔧 Enhanced Ray Tracing Debug Mode ENABLED");
     #else
     createInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | 
                                 VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
@@ -1031,7 +1436,7 @@ void ClippyRTXApp::pickPhysicalDevice() {
     vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
     
     for (const auto& device : devices) {
-        if (VulkanHelpers::isDeviceSuitable(device, surface, deviceExtensions)) {
+        if (VulkanHelpers::isDeviceSuitable(device, surface, getDeviceExtensions())) {
             physicalDevice = device;
             msaaSamples = VulkanHelpers::getMaxUsableSampleCount(physicalDevice);
             break;
@@ -1073,10 +1478,23 @@ void ClippyRTXApp::createLogicalDevice() {
     asFeatures.accelerationStructure = VK_TRUE;
     asFeatures.pNext = &rtFeatures;
     
+    // Optional: CPU builds through deferred host operations (few drivers expose them)
+    hostASBuildsSupported = hostASBuilds && HostAccelerationStructureBuilder::isSupported(physicalDevice);
+    asFeatures.accelerationStructureHostCommands = hostASBuildsSupported ? VK_TRUE : VK_FALSE;
+    if (hostASBuilds && !hostASBuildsSupported) {
+        LOG_INFO("accelerationStructureHostCommands not supported - building acceleration structures on the GPU");
+    }
+    
+    // Timeline semaphores (Vulkan 1.2 core) drive the frame loop
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    timelineFeatures.timelineSemaphore = VK_TRUE;
+    timelineFeatures.pNext = &asFeatures;
+    
     VkPhysicalDeviceBufferDeviceAddressFeaturesKHR bufferDeviceAddressFeatures{};
     bufferDeviceAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES_KHR;
     bufferDeviceAddressFeatures.bufferDeviceAddress = VK_TRUE;
-    bufferDeviceAddressFeatures.pNext = &asFeatures;
+    bufferDeviceAddressFeatures.pNext = &timelineFeatures;
     
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -1087,8 +1505,15 @@ void ClippyRTXApp::createLogicalDevice() {
     
     createInfo.pEnabledFeatures = &deviceFeatures;
     
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    std::vector<const char*> enabledExtensions = getDeviceExtensions();
+    
+    // Optional: heap usage for the benchmark report
+    memoryBudgetSupported = VulkanHelpers::checkDeviceExtensionSupport(physicalDevice, {VK_EXT_MEMORY_BUDGET_EXTENSION_NAME});
+    if (memoryBudgetSupported) {
+        enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
     
     if (enableValidationLayers) {
         createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -1105,6 +1530,33 @@ void ClippyRTXApp::createLogicalDevice() {
     vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
 }
 
+std::vector<const char*> ClippyRTXApp::getDeviceExtensions() const {
+    std::vector<const char*> extensions = deviceExtensions;
+    if (headless) {
+        extensions.erase(std::remove_if(extensions.begin(), extensions.end(), [](const char* name) {
+            return strcmp(name, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0;
+        }), extensions.end());
+    }
+    return extensions;
+}
+
+// Offscreen images take the place of the swapchain images; everything downstream
+// (image views, render passes, framebuffers, RTX copy) uses them unchanged
+void ClippyRTXApp::createHeadlessTarget() {
+    swapChainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    swapChainExtent = {headlessOptions.width, headlessOptions.height};
+    
+    headlessTarget = std::make_unique<HeadlessTarget>(device, physicalDevice, swapChainExtent, swapChainImageFormat,
+                                                      framesInFlight, headlessOptions.outputDir);
+    swapChainImages = headlessTarget->getImages();
+}
+
+// Every saveEvery-th frame, or just the last one
+bool ClippyRTXApp::isSavedHeadlessFrame() const {
+    if (headlessOptions.saveEvery > 0) return headlessFrame % headlessOptions.saveEvery == 0;
+    return headlessFrame + 1 == headlessOptions.frameCount;
+}
+
 // Placeholder implementations for remaining methods
 void ClippyRTXApp::createSwapChain() {
     SwapChainSupportDetails swapChainSupport = VulkanHelpers::querySwapChainSupport(physicalDevice, surface);
@@ -1117,7 +1569,7 @@ void ClippyRTXApp::createSwapChain() {
         if (availableFormat.format == VK_FORMAT_R8G8B8A8_SRGB && 
             availableFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
             surfaceFormat = availableFormat;
-            std::cout << "✅ Selected RGB format (cross-platform compatible)" << std::endl;
+            LOG_INFO("✅ Selected RGB format (cross-platform compatible)");
             break;
         }
     }
@@ -1127,7 +1579,7 @@ void ClippyRTXApp::createSwapChain() {
         if (availableFormat.format == VK_FORMAT_R8G8B8A8_UNORM && 
             availableFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
             surfaceFormat = availableFormat;
-            std::cout << "✅ Selected RGB UNORM format" << std::endl;
+            LOG_INFO("✅ Selected RGB UNORM format");
             break;
         }
     }
@@ -1140,7 +1592,7 @@ void ClippyRTXApp::createSwapChain() {
             if (availableFormat.format == VK_FORMAT_B8G8R8A8_SRGB && 
                 availableFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
                 surfaceFormat = availableFormat;
-                std::cout << "⚠️  Fallback to BGR format (will need color correction)" << std::endl;
+                LOG_WARN("⚠️  Fallback to BGR format (will need color correction)");
                 break;
             }
         }
@@ -1186,7 +1638,8 @@ void ClippyRTXApp::createSwapChain() {
     createInfo.imageColorSpace = surfaceFormat.colorSpace;
     createInfo.imageExtent = extent;
     createInfo.imageArrayLayers = 1;
-    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // Transfer destination for the RT output copy and the CPU trace upload
+    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
     
     QueueFamilyIndices indices = VulkanHelpers::findQueueFamilies(physicalDevice, surface);
     uint32_t queueFamilyIndices[] = {indices.graphicsFamily.value(), indices.presentFamily.value()};
@@ -1216,11 +1669,11 @@ void ClippyRTXApp::createSwapChain() {
     swapChainExtent = extent;
     
     // DEBUG: Show what format we're using
-    std::cout << "🎨 Swapchain format: " << swapChainImageFormat << std::endl;
+    LOG_INFO("🎨 Swapchain format: " << swapChainImageFormat);
     if (swapChainImageFormat == VK_FORMAT_B8G8R8A8_SRGB || swapChainImageFormat == VK_FORMAT_B8G8R8A8_UNORM) {
-        std::cout << "   -> BGR format detected - will need color correction in shaders" << std::endl;
+        LOG_INFO("   -> BGR format detected - will need color correction in shaders");
     } else if (swapChainImageFormat == VK_FORMAT_R8G8B8A8_SRGB || swapChainImageFormat == VK_FORMAT_R8G8B8A8_UNORM) {
-        std::cout << "   -> RGB format detected - colors will display correctly" << std::endl;
+        LOG_INFO("   -> RGB format detected - colors will display correctly");
     }
 }
 
@@ -1263,7 +1716,7 @@ void ClippyRTXApp::createRenderPass() {
     colorAttachmentResolve.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachmentResolve.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachmentResolve.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachmentResolve.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachmentResolve.finalLayout = outputFinalLayout;
     
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
@@ -1317,7 +1770,7 @@ void ClippyRTXApp::createUIRenderPass() {
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;  // Ready for ImGui rendering
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.finalLayout = outputFinalLayout;
     
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
@@ -1349,7 +1802,7 @@ void ClippyRTXApp::createUIRenderPass() {
         throw std::runtime_error("failed to create UI render pass!");
     }
     
-    std::cout << "UI overlay render pass created successfully (preserves RTX content)" << std::endl;
+    LOG_INFO("UI overlay render pass created successfully (preserves RTX content)");
 }
 
 // All Vulkan pipeline implementations are now in VulkanPipelineImplementations.cpp
@@ -1362,7 +1815,7 @@ void ClippyRTXApp::setupUI() {
     // Initialize ImGui
     clippyUI->initImGui(window, instance, physicalDevice, graphicsQueue, 
                        VulkanHelpers::findQueueFamilies(physicalDevice, surface).graphicsFamily.value(), 
-                       static_cast<uint32_t>(swapChainImages.size()));
+                       static_cast<uint32_t>(swapChainImages.size()), pipelineCache->get());
     
     // Initialize with welcome message
     clippyUI->showMessage(ClippyUI::MessageType::GREETING, "¡Hola! Soy Clippy RTX con personalidad");
@@ -1410,6 +1863,11 @@ void ClippyRTXApp::updateUI() {
     }
     
     clippyUI->update(deltaTime, mouseX, mouseY, mousePressed);
+    
+    // GPU timings refresh a few times per second - the percentiles sort each history
+    if (gpuProfiler && frameCount % 30 == 0) {
+        clippyUI->setGpuTimings(gpuProfiler->getStats());
+    }
 }
 
 void ClippyRTXApp::renderUI(VkCommandBuffer commandBuffer) {
@@ -1420,10 +1878,11 @@ void ClippyRTXApp::renderUI(VkCommandBuffer commandBuffer) {
 
 // Post Processing Implementation
 void ClippyRTXApp::setupPostProcessing() {
-    std::cout << "Initializing PostProcessing..." << std::endl;
+    LOG_INFO("Initializing PostProcessing...");
     
     try {
-        postProcessing = std::make_unique<PostProcessing>(device, physicalDevice, renderPass, swapChainExtent);
+        postProcessing = std::make_unique<PostProcessing>(device, physicalDevice, renderPass, swapChainExtent,
+                                                          framesInFlight, *uniformRing, pipelineCache->get());
         
         // ULTRA PRO EFFECTS ACTIVATED! 🔥
         postProcessing->enableTonemap(false); // DISABLED TO DEBUG GOLD COLOR
@@ -1443,10 +1902,10 @@ void ClippyRTXApp::setupPostProcessing() {
         postProcessing->setChromaticAberration(0.003f); // Subtle CA
         postProcessing->setFilmGrain(0.08f);    // Film grain texture
         
-        std::cout << "PostProcessing initialized successfully!" << std::endl;
+        LOG_INFO("PostProcessing initialized successfully!");
     } catch (const std::exception& e) {
-        std::cout << "PostProcessing failed to initialize: " << e.what() << std::endl;
-        std::cout << "Continuing without post-processing effects..." << std::endl;
+        LOG_WARN("PostProcessing failed to initialize: " << e.what());
+        LOG_WARN("Continuing without post-processing effects...");
         postProcessing = nullptr;
     }
 }
@@ -1515,8 +1974,6 @@ void ClippyRTXApp::updatePostProcessing() {
         postProcessing->setExposure(1.0f);
         postProcessing->setContrast(1.0f);
     }
-    
-    postProcessing->updateUniforms(currentFrame, totalTime);
 }
 
 void ClippyRTXApp::cleanup() {
@@ -1525,21 +1982,51 @@ void ClippyRTXApp::cleanup() {
     clippyUI.reset();
     postProcessing.reset();
     rayTracingPipeline.reset();
+    deformationPass.reset();
+    destroyCpuTraceUploadBuffers();
+    cpuPathTracer.reset();
+    referenceTracer.reset();
     
     vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
     
+    uniformRing.reset();
+    
+    vkDestroyBuffer(device, partIndexBuffer, nullptr);
+    vkFreeMemory(device, partIndexBufferMemory, nullptr);
+    vkDestroyBuffer(device, partVertexBuffer, nullptr);
+    vkFreeMemory(device, partVertexBufferMemory, nullptr);
+    
     vkDestroyBuffer(device, indexBuffer, nullptr);
     vkFreeMemory(device, indexBufferMemory, nullptr);
     
     vkDestroyBuffer(device, vertexBuffer, nullptr);
     vkFreeMemory(device, vertexBufferMemory, nullptr);
     
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
-        vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
-        vkDestroyFence(device, inFlightFences[i], nullptr);
+    gpuWatchdog.reset();
+    headlessTarget.reset();
+    
+    if (gpuProfiler) {
+        gpuProfiler->writeCsv("gpu_profile.csv");
+        gpuProfiler.reset();
+    }
+    
+    // Every pipeline has been created by now: persist what the driver compiled for the next launch
+    if (pipelineCache) {
+        pipelineCache->save();
+        pipelineCache.reset();
     }
     
+    for (VkSemaphore semaphore : renderFinishedSemaphores) {
+        vkDestroySemaphore(device, semaphore, nullptr);
+    }
+    for (VkSemaphore semaphore : imageAvailableSemaphores) {
+        vkDestroySemaphore(device, semaphore, nullptr);
+    }
+    vkDestroySemaphore(device, frameTimeline, nullptr);
+    
+    for (VkCommandPool framePool : frameCommandPools) {
+        vkDestroyCommandPool(device, framePool, nullptr);
+    }
     vkDestroyCommandPool(device, commandPool, nullptr);
     
     vkDestroyDevice(device, nullptr);
@@ -1548,9 +2035,13 @@ void ClippyRTXApp::cleanup() {
         DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
     }
     
-    vkDestroySurfaceKHR(instance, surface, nullptr);
+    if (surface != VK_NULL_HANDLE) {
+        vkDestroySurfaceKHR(instance, surface, nullptr);
+    }
     vkDestroyInstance(instance, nullptr);
     
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    if (window) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
 }
\ No newline at end of file
@@ -1,5 +1,5 @@
 #include "ClippyUI.h"
-#include <iostream>
+#include "Logger.h"
 #include <algorithm>
 
 ClippyUI::ClippyUI(VkDevice device, VkRenderPass renderPass, VkDescriptorPool descriptorPool, 
@@ -15,7 +15,7 @@ ClippyUI::ClippyUI(VkDevice device, VkRenderPass renderPass, VkDescriptorPool de
     state.isVisible = true;
     state.currentPersonalityMode = 0;
     
-    std::cout << "ClippyUI initialized with resolution " << width << "x" << height << std::endl;
+    LOG_INFO("ClippyUI initialized with resolution " << width << "x" << height);
 }
 
 ClippyUI::~ClippyUI() {
@@ -23,7 +23,8 @@ ClippyUI::~ClippyUI() {
 }
 
 void ClippyUI::initImGui(GLFWwindow* window, VkInstance instance, VkPhysicalDevice physicalDevice, 
-                         VkQueue graphicsQueue, uint32_t queueFamily, uint32_t imageCount) {
+                         VkQueue graphicsQueue, uint32_t queueFamily, uint32_t imageCount,
+                         VkPipelineCache pipelineCache) {
     // Store the graphics queue for later use
     this->graphicsQueue = graphicsQueue;
     // Setup ImGui context
@@ -69,7 +70,7 @@ void ClippyUI::initImGui(GLFWwindow* window, VkInstance instance, VkPhysicalDevi
     pool_info.pPoolSizes = pool_sizes;
     
     if (vkCreateDescriptorPool(device, &pool_info, nullptr, &imguiDescriptorPool) != VK_SUCCESS) {
-        std::cout << "[ClippyUI] Failed to create ImGui descriptor pool!" << std::endl;
+        LOG_ERROR("[ClippyUI] Failed to create ImGui descriptor pool!");
         return;
     }
     
@@ -82,7 +83,7 @@ void ClippyUI::initImGui(GLFWwindow* window, VkInstance instance, VkPhysicalDevi
     init_info.Device = device;
     init_info.QueueFamily = queueFamily;
     init_info.Queue = graphicsQueue;
-    init_info.PipelineCache = VK_NULL_HANDLE;
+    init_info.PipelineCache = pipelineCache;
     init_info.DescriptorPool = imguiDescriptorPool;  // Use ImGui-specific pool
     init_info.Subpass = 0;
     init_info.MinImageCount = imageCount;
@@ -135,17 +136,21 @@ void ClippyUI::initImGui(GLFWwindow* window, VkInstance instance, VkPhysicalDevi
     ImGui_ImplVulkan_DestroyFontsTexture();
     
     imguiInitialized = true;
-    std::cout << "[ClippyUI] ImGui initialized successfully with fonts uploaded" << std::endl;
+    LOG_INFO("[ClippyUI] ImGui initialized successfully with fonts uploaded");
 }
 
 void ClippyUI::showMessage(MessageType type, const std::string& message) {
+    // updateUI re-sends the current message every frame: only log actual changes
+    bool changed = state.currentMessage != message;
+    
     state.currentMessageType = type;
     state.currentMessage = message;
     state.messageTimer = 0.0f;
     state.isVisible = true;
     
-    // Log message for debugging
-    std::cout << "[ClippyUI] " << message << std::endl;
+    if (changed) {
+        LOG_INFO("[ClippyUI] " << message);
+    }
 }
 
 void ClippyUI::showPersonalityMessage(int personalityMode) {
@@ -203,7 +208,7 @@ void ClippyUI::cleanup() {
         imguiDescriptorPool = VK_NULL_HANDLE;
     }
     
-    std::cout << "ClippyUI cleaned up" << std::endl;
+    LOG_INFO("ClippyUI cleaned up");
 }
 
 void ClippyUI::updateAnimations(float deltaTime) {
@@ -313,6 +318,31 @@ void ClippyUI::renderImGuiOverlay() {
     ImGui::Text("ESC: Salir");
     
     ImGui::End();
+    
+    // ⏱️ GPU TIMINGS WINDOW
+    if (!gpuTimings.empty()) {
+        ImGui::SetNextWindowPos(ImVec2(width - 300, 240), ImGuiCond_Always);
+        ImGui::SetNextWindowSize(ImVec2(280, 0), ImGuiCond_Always);
+        ImGui::Begin("⏱️ GPU Timings (ms)", nullptr, controlFlags | ImGuiWindowFlags_AlwaysAutoResize);
+        
+        if (ImGui::BeginTable("gpuTimings", 4)) {
+            ImGui::TableSetupColumn("Pass");
+            ImGui::TableSetupColumn("min");
+            ImGui::TableSetupColumn("avg");
+            ImGui::TableSetupColumn("p99");
+            ImGui::TableHeadersRow();
+            for (const auto& timing : gpuTimings) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(timing.name.c_str());
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", timing.minMs);
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", timing.avgMs);
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", timing.p99Ms);
+            }
+            ImGui::EndTable();
+        }
+        
+        ImGui::End();
+    }
 }
 
 void ClippyUI::renderMessageBubble(VkCommandBuffer commandBuffer) {
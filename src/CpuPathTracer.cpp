@@ -0,0 +1,1196 @@
+#include "CpuPathTracer.h"
+#include "Logger.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+
+static const float PI = 3.14159265359f;
+
+// GLSL uint(float): negative values wrap (float -> int -> uint) instead of being undefined
+static uint32_t toUint(float value) {
+    return static_cast<uint32_t>(static_cast<int64_t>(value));
+}
+
+static uint32_t wangHash(uint32_t seed) {
+    seed = (seed ^ 61u) ^ (seed >> 16u);
+    seed *= 9u;
+    seed = seed ^ (seed >> 4u);
+    seed *= 0x27d4eb2du;
+    seed = seed ^ (seed >> 15u);
+    return seed;
+}
+
+// rngState / rnd() of the shaders; every shader invocation has its own
+struct Rng {
+    uint32_t state = 0;
+
+    float next() {
+        state = wangHash(state);
+        return static_cast<float>(state) / 4294967296.0f;
+    }
+    glm::vec2 next2() {
+        float x = next();
+        return glm::vec2(x, next());
+    }
+};
+
+static glm::vec3 cosineWeightedSample(const glm::vec3& normal, Rng& rng) {
+    glm::vec2 r = rng.next2();
+    float phi = 2.0f * PI * r.x;
+    float cosTheta = std::sqrt(r.y);
+    float sinTheta = std::sqrt(1.0f - r.y);
+
+    glm::vec3 w = normal;
+    glm::vec3 u = glm::normalize(glm::cross(std::abs(w.x) > 0.1f ? glm::vec3(0, 1, 0) : glm::vec3(1, 0, 0), w));
+    glm::vec3 v = glm::cross(w, u);
+
+    return glm::normalize(u * std::cos(phi) * sinTheta + v * std::sin(phi) * sinTheta + w * cosTheta);
+}
+
+static glm::vec3 acesToneMapping(const glm::vec3& color) {
+    const float A = 2.51f;
+    const float B = 0.03f;
+    const float C = 2.43f;
+    const float D = 0.59f;
+    const float E = 0.14f;
+    return (color * (A * color + B)) / (color * (C * color + D) + E);
+}
+
+// imageStore into an rgba8 (UNORM) image; NaN ends up black
+static uint8_t toUnorm8(float value) {
+    if (!(value > 0.0f)) return 0;
+    return static_cast<uint8_t>(std::min(value, 1.0f) * 255.0f + 0.5f);
+}
+
+static glm::vec3 personalityBaseColor(const UniformBufferObject& cam, const glm::vec3& worldPos) {
+    float mixFactor = std::sin(worldPos.y * 5.0f + cam.time * cam.animationStrength) * 0.5f + 0.5f;
+
+    switch (cam.personalityMode) {
+        case 0: // IDLE
+            mixFactor += std::sin(worldPos.x * 2.0f + cam.time) * 0.1f;
+            break;
+        case 1: // EXCITED
+            mixFactor += std::sin(cam.time * 10.0f * cam.animationStrength) * 0.3f;
+            break;
+        case 2: // QUANTUM
+            mixFactor += std::sin(cam.time * 15.0f) * std::cos(worldPos.x * 8.0f) * 0.4f;
+            break;
+        case 3: { // PARTY
+            float partyPhase = cam.time * 5.0f;
+            mixFactor = std::sin(partyPhase) * std::sin(partyPhase + worldPos.y * 10.0f) * 0.5f + 0.5f;
+            break;
+        }
+        case 4: // HELPING
+            mixFactor += std::sin(cam.time * 2.0f) * 0.2f;
+            break;
+        case 5: // THINKING
+            mixFactor += std::sin(cam.time * 0.8f + worldPos.y * 3.0f) * 0.15f;
+            break;
+    }
+
+    mixFactor = glm::clamp(mixFactor, 0.0f, 1.0f);
+    return glm::mix(cam.personalityColorA, cam.personalityColorB, mixFactor);
+}
+
+static glm::vec3 advancedSSS(const UniformBufferObject& cam, const glm::vec3& normal, const glm::vec3& lightDir,
+                             const glm::vec3& albedo) {
+    const int SSS_SAMPLES = 4;
+    glm::vec3 accumulation(0.0f);
+
+    for (int i = 0; i < SSS_SAMPLES; i++) {
+        float depth = (static_cast<float>(i) + 1.0f) / static_cast<float>(SSS_SAMPLES);
+        float penetrationDistance = cam.subsurfaceRadius * depth;
+
+        glm::vec3 layerAbsorption(std::exp(-penetrationDistance * 0.3f),
+                                  std::exp(-penetrationDistance * 0.6f),
+                                  std::exp(-penetrationDistance * 1.0f));
+        float scatteringFactor = std::exp(-depth * 2.0f);
+        float backScatter = std::max(0.0f, -glm::dot(normal, lightDir)) * (1.0f - depth * 0.5f);
+
+        accumulation += albedo * layerAbsorption * scatteringFactor * (1.0f + backScatter);
+    }
+
+    return accumulation * cam.subsurfaceScattering * 0.25f;
+}
+
+static float henyeyGreenstein(float cosTheta, float g) {
+    float g2 = g * g;
+    return (1.0f - g2) / (4.0f * PI * std::pow(1.0f + g2 - 2.0f * g * cosTheta, 1.5f));
+}
+
+static glm::vec3 volumetricScattering(const UniformBufferObject& cam, const glm::vec3& rayStart,
+                                      const glm::vec3& rayEnd, const glm::vec3& lightDir,
+                                      const glm::vec3& lightColor, Rng& rng) {
+    const int VOLUMETRIC_SAMPLES = 8;
+
+    glm::vec3 rayStep = (rayEnd - rayStart) / static_cast<float>(VOLUMETRIC_SAMPLES);
+    float stepLength = glm::length(rayStep);
+    glm::vec3 contribution(0.0f);
+
+    for (int i = 0; i < VOLUMETRIC_SAMPLES; i++) {
+        glm::vec3 samplePos = rayStart + rayStep * (static_cast<float>(i) + rng.next());
+
+        float distanceFromCamera = glm::length(samplePos - cam.cameraPos);
+        float density = cam.volumetricDensity * std::exp(-distanceFromCamera * 0.01f);
+
+        if (density > 0.001f) {
+            float cosTheta = glm::dot(glm::normalize(rayEnd - rayStart), lightDir);
+            float phase = henyeyGreenstein(cosTheta, 0.3f);
+            float heightFactor = std::exp(-std::max(0.0f, samplePos.y - 2.0f) * 0.5f);
+            contribution += lightColor * density * phase * heightFactor * stepLength * cam.volumetricScattering;
+        }
+    }
+
+    return contribution;
+}
+
+static glm::vec3 causticPattern(const UniformBufferObject& cam, const glm::vec3& origin, const glm::vec3& direction,
+                                const glm::vec3& lightDir) {
+    float pattern = std::sin(origin.x * 10.0f) * std::cos(origin.z * 8.0f) * std::sin(cam.time * 2.0f);
+    pattern = std::max(0.0f, pattern);
+
+    float wavelength = glm::dot(direction, lightDir) * 0.5f + 0.5f;
+    glm::vec3 rainbow(std::sin(wavelength * PI * 2.0f + 0.0f) * 0.5f + 0.5f,
+                      std::sin(wavelength * PI * 2.0f + 2.09f) * 0.5f + 0.5f,
+                      std::sin(wavelength * PI * 2.0f + 4.19f) * 0.5f + 0.5f);
+
+    return rainbow * pattern * cam.causticsStrength;
+}
+
+static glm::vec3 holographicEffect(const UniformBufferObject& cam, const glm::vec3& color, const glm::vec3& worldPos) {
+    if (cam.holographicStrength <= 0.0f) return color;
+
+    float scanLine = std::sin(worldPos.y * 30.0f - cam.time * 8.0f) * 0.5f + 0.5f;
+    scanLine = scanLine * scanLine;
+
+    glm::vec3 holoColor = glm::mix(color, glm::vec3(0.0f, 0.8f, 1.0f), scanLine * cam.holographicStrength * 0.3f);
+
+    float interference = std::sin(worldPos.x * 50.0f + cam.time * 12.0f) * std::sin(worldPos.z * 50.0f + cam.time * 8.0f);
+    interference = interference * 0.5f + 0.5f;
+
+    return holoColor + interference * cam.holographicStrength * 0.1f;
+}
+
+static glm::vec3 glitchEffect(const UniformBufferObject& cam, glm::vec3 color, const glm::vec3& worldPos, Rng& rng) {
+    if (cam.glitchIntensity <= 0.0f) return color;
+
+    rng.state = wangHash(toUint(worldPos.x * 1000.0f + worldPos.y * 2000.0f + worldPos.z * 3000.0f + cam.time * 1000.0f));
+
+    if (rng.next() < cam.glitchIntensity * 0.1f) {
+        float noise = rng.next() * 2.0f - 1.0f;
+        if (rng.next() > 0.7f) color.r += noise * cam.glitchIntensity * 0.5f;
+        if (rng.next() > 0.7f) color.g += noise * cam.glitchIntensity * 0.5f;
+        if (rng.next() > 0.7f) color.b += noise * cam.glitchIntensity * 0.5f;
+        color = glm::floor(color * 8.0f) / 8.0f;
+    }
+
+    return color;
+}
+
+// raygen.rgen's camera ray for one sample; consumes the pixel's rng exactly like the shader
+static void cameraRay(const UniformBufferObject& cam, const glm::vec2& imageSize, uint32_t x, uint32_t y,
+                      int actualSamples, Rng& rng, glm::vec3& origin, glm::vec3& direction) {
+    glm::vec2 jitter = (actualSamples > 1 || cam.accumulationFrame > 0) ? rng.next2() - 0.5f : glm::vec2(0.0f);
+    glm::vec2 pixelCenter = glm::vec2(static_cast<float>(x), static_cast<float>(y)) + 0.5f + jitter;
+    glm::vec2 d = pixelCenter / imageSize * 2.0f - 1.0f;
+
+    origin = glm::vec3(cam.viewInverse * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    glm::vec4 target = cam.projInverse * glm::vec4(d.x, d.y, 1.0f, 1.0f);
+    direction = glm::normalize(glm::vec3(cam.viewInverse * glm::vec4(glm::normalize(glm::vec3(target)), 0.0f)));
+
+    if (actualSamples > 1) {
+        // Depth of field: only the direction changes, towards the focus point
+        const float aperture = 0.05f;
+        const float focalDistance = 6.0f;
+        glm::vec3 focusPoint = origin + direction * focalDistance;
+        glm::vec2 apertureSample = rng.next2();
+        float angle = apertureSample.x * 2.0f * PI;
+        float radius = std::sqrt(apertureSample.y) * aperture;
+        glm::vec3 apertureOrigin = origin + glm::vec3(std::cos(angle) * radius, std::sin(angle) * radius, 0.0f);
+        direction = glm::normalize(focusPoint - apertureOrigin);
+
+        // Motion blur of the ray origin
+        float motionTime = cam.time + (rng.next() - 0.5f) * 0.02f;
+        float wave1 = std::sin(motionTime * 2.0f + origin.y * 3.0f) * 0.05f;
+        float wave2 = std::sin(motionTime * 1.5f + origin.x * 2.0f) * 0.03f;
+        float wave3 = std::cos(motionTime * 3.0f + origin.z * 4.0f) * 0.02f;
+        origin += glm::vec3(wave1 + wave2, wave3, wave1 * 0.5f + wave2 * 0.3f);
+    }
+}
+
+// Model space ray; the direction is not renormalized so t means the same in both spaces
+static Bvh::Ray modelRay(const glm::mat4& modelInverse, const glm::vec3& origin, const glm::vec3& direction,
+                         float tMin, float tMax) {
+    Bvh::Ray ray;
+    ray.origin = glm::vec3(modelInverse * glm::vec4(origin + direction * tMin, 1.0f));
+    ray.direction = glm::vec3(modelInverse * glm::vec4(direction, 0.0f));
+    ray.tMax = tMax - tMin;
+    return ray;
+}
+
+// A bounce ray for the wavefront queue, traced like trace() would
+static RayQueue::Entry bounceRay(const glm::mat4& modelInverse, const glm::vec3& origin, const glm::vec3& direction,
+                                 float tMax, uint32_t type, uint32_t parent) {
+    RayQueue::Entry entry;
+    entry.ray = modelRay(modelInverse, origin, direction, 0.001f, tMax);
+    entry.origin = origin;
+    entry.direction = direction;
+    entry.parent = parent;
+    entry.type = type;
+    return entry;
+}
+
+static uint32_t chunkEnd(uint32_t chunk, uint32_t count) {
+    return std::min((chunk + 1) * RayQueue::CHUNK_SIZE, count);
+}
+
+// Per-chunk counts to the offset of each chunk in the compacted output; returns the total
+static uint32_t prefixSum(std::vector<uint32_t>& counts) {
+    uint32_t total = 0;
+    for (uint32_t& count : counts) {
+        uint32_t chunkCount = count;
+        count = total;
+        total += chunkCount;
+    }
+    return total;
+}
+
+static bool isValidReflection(const glm::vec3& color) {
+    bool anyPositive = false;
+    for (int i = 0; i < 3; i++) {
+        if (std::isnan(color[i]) || std::isinf(color[i]) || color[i] >= 10.0f) return false;
+        anyPositive = anyPositive || color[i] > 0.0f;
+    }
+    return anyPositive;
+}
+
+static_assert(CpuPathTracer::TILE_SIZE % RayPacketTracer::PACKET_WIDTH == 0, "tiles must hold whole packets");
+
+CpuPathTracer::CpuPathTracer(uint32_t threadCount) : pool(threadCount), packetTracer(bvh) {
+}
+
+void CpuPathTracer::setScene(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                             const std::vector<ClippyGeometry::Part>& parts,
+                             const std::vector<ClippyGeometry::PartInstance>& instances) {
+    // Bake every instance into model space, as the TLAS would place it
+    std::vector<Vertex> sceneVertices;
+    std::vector<uint32_t> sceneIndices;
+    triangleMaterials.clear();
+
+    for (const ClippyGeometry::PartInstance& instance : instances) {
+        const ClippyGeometry::Part& part = parts[instance.part];
+        uint32_t baseVertex = static_cast<uint32_t>(sceneVertices.size());
+
+        for (uint32_t v = 0; v < part.vertexCount; v++) {
+            Vertex vertex = vertices[part.firstVertex + v];
+            vertex.pos = glm::vec3(instance.transform * glm::vec4(vertex.pos, 1.0f));
+            sceneVertices.push_back(vertex);
+        }
+        for (uint32_t i = 0; i < part.indexCount; i++) {
+            sceneIndices.push_back(baseVertex + indices[part.firstIndex + i]);
+        }
+        triangleMaterials.insert(triangleMaterials.end(), part.indexCount / 3, instance.material);
+    }
+
+    // Leaves as wide as the SIMD kernel, so each one is a single triangle packet
+    WideBvh::Isa isa = WideBvh::detectIsa();
+    Bvh::BuildOptions options;
+    options.maxLeafSize = std::max(WideBvh::laneCount(isa), options.maxLeafSize);
+    bvh.build(sceneVertices, sceneIndices, options);
+    wideBvh.build(bvh, isa);
+
+    const Bvh::BuildStats& stats = bvh.getStats();
+    LOG_INFO("🖥️  CPU path tracer scene: " << stats.triangleCount << " triangles, " << stats.nodeCount
+             << " BVH nodes (" << stats.buildMs << " ms), " << WideBvh::isaName(isa) << " traversal, "
+             << pool.getThreadCount() << " thread(s)");
+}
+
+void CpuPathTracer::render(const UniformBufferObject& ubo, uint32_t newWidth, uint32_t newHeight) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    bool resized = newWidth != width || newHeight != height;
+    if (resized) {
+        width = newWidth;
+        height = newHeight;
+        accumulation.assign(static_cast<size_t>(width) * height, glm::vec4(0.0f));
+        pixels.assign(static_cast<size_t>(width) * height * 4, 0);
+    }
+    bgr = ubo.isBGRFormat == 1;
+
+    Frame frame{};
+    frame.ubo = &ubo;
+    frame.modelInverse = glm::inverse(ubo.model);
+    frame.resetHistory = resized || ubo.accumulationFrame == 0;
+
+    uint32_t tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    uint32_t tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    if (wavefront) {
+        renderWavefront(frame, tilesX, tilesY);
+    } else {
+        pool.run(tilesX * tilesY, [&](uint32_t tile, uint32_t) {
+            renderTile(frame, tile, tilesX);
+        });
+    }
+
+    lastRenderMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    LOG_DEBUG_EVERY_MS(2000, "🖥️  CPU trace " << width << "x" << height << ": " << lastRenderMs << " ms, "
+                       << tilesX * tilesY << " tiles, " << pool.getLastStealCount() << " stolen");
+}
+
+void CpuPathTracer::renderTile(const Frame& frame, uint32_t tile, uint32_t tilesX) {
+    uint32_t x0 = (tile % tilesX) * TILE_SIZE;
+    uint32_t y0 = (tile / tilesX) * TILE_SIZE;
+    int actualSamples = std::max(1, frame.ubo->samplesPerPixel);
+
+    glm::vec3 colors[TILE_SIZE * TILE_SIZE] = {};
+    tracePrimaries(frame, tile, tilesX, [&](uint32_t x, uint32_t y, int, const glm::vec3& origin,
+                                            const glm::vec3& direction, const Bvh::Hit& hit) {
+        colors[(y - y0) * TILE_SIZE + (x - x0)] += hit.triangle == UINT32_MAX
+            ? sky(direction, RAY_PRIMARY)
+            : shade(frame, origin, direction, hit.t + 0.001f, hit.triangle, 0);
+    });
+
+    uint32_t x1 = std::min(x0 + TILE_SIZE, width);
+    uint32_t y1 = std::min(y0 + TILE_SIZE, height);
+    for (uint32_t y = y0; y < y1; y++) {
+        for (uint32_t x = x0; x < x1; x++) {
+            resolvePixel(frame, x, y, colors[(y - y0) * TILE_SIZE + (x - x0)] / static_cast<float>(actualSamples));
+        }
+    }
+}
+
+void CpuPathTracer::renderWavefront(const Frame& frame, uint32_t tilesX, uint32_t tilesY) {
+    uint32_t actualSamples = static_cast<uint32_t>(std::max(1, frame.ubo->samplesPerPixel));
+    sampleColors.resize(static_cast<size_t>(width) * height * actualSamples);
+    wavefrontStats = WavefrontStats{};
+    wavefrontStats.primaryRays = static_cast<uint64_t>(width) * height * actualSamples;
+
+    // Primary rays by tile as in renderTile, but hits stop at their bounce rays
+    workerPoints.resize(pool.getThreadCount());
+    for (std::vector<ShadePoint>& points : workerPoints) {
+        points.clear();
+    }
+    pool.run(tilesX * tilesY, [&](uint32_t tile, uint32_t worker) {
+        tracePrimaries(frame, tile, tilesX, [&](uint32_t x, uint32_t y, int sample, const glm::vec3& origin,
+                                                const glm::vec3& direction, const Bvh::Hit& hit) {
+            uint32_t slot = (y * width + x) * actualSamples + static_cast<uint32_t>(sample);
+            if (hit.triangle == UINT32_MAX) {
+                sampleColors[slot] = sky(direction, RAY_PRIMARY);
+                return;
+            }
+            workerPoints[worker].emplace_back();
+            ShadePoint& point = workerPoints[worker].back();
+            beginShade(frame, origin, direction, hit.t + 0.001f, hit.triangle, 0, point);
+            point.type = RAY_PRIMARY;
+            point.parent = slot;
+        });
+    });
+
+    if (bounces.empty()) {
+        bounces.emplace_back();
+    }
+    bounces[0].clear();
+    for (const std::vector<ShadePoint>& points : workerPoints) {
+        bounces[0].insert(bounces[0].end(), points.begin(), points.end());
+    }
+
+    // One queue per bounce until no point spawns a ray
+    size_t depthCount = 1;
+    while (!bounces[depthCount - 1].empty()) {
+        if (bounces.size() == depthCount) {
+            bounces.emplace_back();
+        }
+        traceBounce(frame, bounces[depthCount - 1], bounces[depthCount]);
+        depthCount++;
+    }
+
+    // Deepest first: every point hands its colour to the one that spawned it
+    for (size_t depth = depthCount; depth-- > 0;) {
+        const std::vector<ShadePoint>& points = bounces[depth];
+        uint32_t count = static_cast<uint32_t>(points.size());
+        pool.run(RayQueue::chunkCount(count), [&](uint32_t chunk, uint32_t) {
+            for (uint32_t i = chunk * RayQueue::CHUNK_SIZE; i < chunkEnd(chunk, count); i++) {
+                const ShadePoint& point = points[i];
+                glm::vec3 color = finishShade(frame, point);
+                if (depth == 0) {
+                    sampleColors[point.parent] = color;
+                } else if (point.type == RAY_REFLECTION) {
+                    bounces[depth - 1][point.parent].reflection = color;
+                } else {
+                    bounces[depth - 1][point.parent].gi = color;
+                }
+            }
+        });
+    }
+
+    pool.run(tilesX * tilesY, [&](uint32_t tile, uint32_t) {
+        uint32_t x0 = (tile % tilesX) * TILE_SIZE;
+        uint32_t y0 = (tile / tilesX) * TILE_SIZE;
+        uint32_t x1 = std::min(x0 + TILE_SIZE, width);
+        uint32_t y1 = std::min(y0 + TILE_SIZE, height);
+        for (uint32_t y = y0; y < y1; y++) {
+            for (uint32_t x = x0; x < x1; x++) {
+                const glm::vec3* samples = &sampleColors[static_cast<size_t>(y * width + x) * actualSamples];
+                glm::vec3 color(0.0f);
+                for (uint32_t sample = 0; sample < actualSamples; sample++) {
+                    color += samples[sample];
+                }
+                resolvePixel(frame, x, y, color / static_cast<float>(actualSamples));
+            }
+        }
+    });
+}
+
+void CpuPathTracer::traceBounce(const Frame& frame, std::vector<ShadePoint>& points, std::vector<ShadePoint>& next) {
+    next.clear();
+    uint32_t pointCount = static_cast<uint32_t>(points.size());
+    uint32_t pointChunks = RayQueue::chunkCount(pointCount);
+
+    // The bounce rays of every point, compacted into the queue
+    chunkOffsets.assign(pointChunks, 0);
+    pool.run(pointChunks, [&](uint32_t chunk, uint32_t) {
+        uint32_t rays = 0;
+        for (uint32_t i = chunk * RayQueue::CHUNK_SIZE; i < chunkEnd(chunk, pointCount); i++) {
+            rays += (points[i].tracesReflection ? 1 : 0) + (points[i].tracesGi ? 1 : 0);
+        }
+        chunkOffsets[chunk] = rays;
+    });
+    uint32_t rayCount = prefixSum(chunkOffsets);
+    if (rayCount == 0) return;
+
+    queue.resize(rayCount);
+    pool.run(pointChunks, [&](uint32_t chunk, uint32_t) {
+        uint32_t out = chunkOffsets[chunk];
+        for (uint32_t i = chunk * RayQueue::CHUNK_SIZE; i < chunkEnd(chunk, pointCount); i++) {
+            const ShadePoint& point = points[i];
+            glm::vec3 origin = point.worldPos + point.surfaceNormal * 0.001f;
+            if (point.tracesReflection) {
+                queue[out++] = bounceRay(frame.modelInverse, origin, point.reflectionDirection, 100.0f, RAY_REFLECTION, i);
+            }
+            if (point.tracesGi) {
+                queue[out++] = bounceRay(frame.modelInverse, origin, point.giDirection, 20.0f, RAY_GI, i);
+            }
+        }
+    });
+    wavefrontStats.secondaryRays += rayCount;
+    wavefrontStats.bounces++;
+
+    if (raySorting) {
+        auto start = std::chrono::high_resolution_clock::now();
+        const Bvh::Node& root = bvh.getNodes()[0];
+        queue.sort(pool, root.boundsMin, root.boundsMax);
+        wavefrontStats.sortMs += std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // Trace the queue; a miss is the sky, written straight into the point that cast the ray
+    uint32_t rayChunks = RayQueue::chunkCount(rayCount);
+    queueHits.resize(rayCount);
+    chunkOffsets.assign(rayChunks, 0);
+    auto start = std::chrono::high_resolution_clock::now();
+    pool.run(rayChunks, [&](uint32_t chunk, uint32_t) {
+        uint32_t hits = 0;
+        for (uint32_t i = chunk * RayQueue::CHUNK_SIZE; i < chunkEnd(chunk, rayCount); i++) {
+            const RayQueue::Entry& entry = queue[i];
+            queueHits[i] = Bvh::Hit();
+            if (wideBvh.intersect(entry.ray, queueHits[i])) {
+                hits++;
+                continue;
+            }
+            ShadePoint& parent = points[entry.parent];
+            glm::vec3 color = sky(entry.direction, static_cast<RayType>(entry.type));
+            if (entry.type == RAY_REFLECTION) {
+                parent.reflection = color;
+            } else {
+                parent.gi = color;
+            }
+        }
+        chunkOffsets[chunk] = hits;
+    });
+    wavefrontStats.secondaryTraceMs += std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    // The hits, compacted into the next bounce
+    next.resize(prefixSum(chunkOffsets));
+    pool.run(rayChunks, [&](uint32_t chunk, uint32_t) {
+        uint32_t out = chunkOffsets[chunk];
+        for (uint32_t i = chunk * RayQueue::CHUNK_SIZE; i < chunkEnd(chunk, rayCount); i++) {
+            const Bvh::Hit& hit = queueHits[i];
+            if (hit.triangle == UINT32_MAX) continue;
+            const RayQueue::Entry& entry = queue[i];
+            ShadePoint& point = next[out++];
+            beginShade(frame, entry.origin, entry.direction, hit.t + 0.001f, hit.triangle,
+                       points[entry.parent].depth + 1, point);
+            point.type = static_cast<RayType>(entry.type);
+            point.parent = entry.parent;
+        }
+    });
+}
+
+void CpuPathTracer::tracePrimaries(const Frame& frame, uint32_t tile, uint32_t tilesX, const PrimaryVisitor& visit) const {
+    const UniformBufferObject& cam = *frame.ubo;
+    int actualSamples = std::max(1, cam.samplesPerPixel);
+    glm::vec2 imageSize(static_cast<float>(width), static_cast<float>(height));
+
+    uint32_t x0 = (tile % tilesX) * TILE_SIZE;
+    uint32_t y0 = (tile / tilesX) * TILE_SIZE;
+    uint32_t x1 = std::min(x0 + TILE_SIZE, width);
+    uint32_t y1 = std::min(y0 + TILE_SIZE, height);
+
+    // One packet-sized block at a time, so both modes walk the pixels in the same order
+    const uint32_t block = RayPacketTracer::PACKET_WIDTH;
+    for (uint32_t by = y0; by < y1; by += block) {
+        for (uint32_t bx = x0; bx < x1; bx += block) {
+            uint32_t bx1 = std::min(bx + block, x1);
+            uint32_t by1 = std::min(by + block, y1);
+
+            // Every pixel has its own rng stream, whichever way its rays are traced
+            Rng rngs[RayPacketTracer::PACKET_SIZE];
+            for (uint32_t y = by; y < by1; y++) {
+                for (uint32_t x = bx; x < bx1; x++) {
+                    rngs[RayPacketTracer::rayIndex(x - bx, y - by)].state =
+                        wangHash(y * width + x + static_cast<uint32_t>(cam.frameCount) * 0x9e3779b9u);
+                }
+            }
+
+            for (int sampleIdx = 0; sampleIdx < actualSamples; sampleIdx++) {
+                RayPacketTracer::Packet packet{};
+                glm::vec3 origins[RayPacketTracer::PACKET_SIZE];
+                glm::vec3 directions[RayPacketTracer::PACKET_SIZE];
+                Bvh::Ray rays[RayPacketTracer::PACKET_SIZE];
+                for (uint32_t y = by; y < by1; y++) {
+                    for (uint32_t x = bx; x < bx1; x++) {
+                        uint32_t ray = RayPacketTracer::rayIndex(x - bx, y - by);
+                        cameraRay(cam, imageSize, x, y, actualSamples, rngs[ray], origins[ray], directions[ray]);
+                        rays[ray] = modelRay(frame.modelInverse, origins[ray], directions[ray], 0.001f, 1000.0f);
+                        packet.setRay(ray, rays[ray]);
+                    }
+                }
+
+                Bvh::Hit hits[RayPacketTracer::PACKET_SIZE];
+                if (packetTracing) {
+                    packetTracer.intersect(packet, hits);
+                } else {
+                    for (uint32_t ray = 0; ray < RayPacketTracer::PACKET_SIZE; ray++) {
+                        if (packet.activeMask & (1ull << ray)) wideBvh.intersect(rays[ray], hits[ray]);
+                    }
+                }
+
+                for (uint32_t y = by; y < by1; y++) {
+                    for (uint32_t x = bx; x < bx1; x++) {
+                        uint32_t ray = RayPacketTracer::rayIndex(x - bx, y - by);
+                        visit(x, y, sampleIdx, origins[ray], directions[ray], hits[ray]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void CpuPathTracer::resolvePixel(const Frame& frame, uint32_t x, uint32_t y, glm::vec3 color) {
+    size_t pixel = static_cast<size_t>(y) * width + x;
+
+    // Running average in HDR, before tone mapping (raygen.rgen)
+    glm::vec4& history = accumulation[pixel];
+    float accumulatedFrames = 1.0f;
+    if (!frame.resetHistory) {
+        color = glm::mix(glm::vec3(history), color, 1.0f / (history.a + 1.0f));
+        accumulatedFrames = history.a + 1.0f;
+    }
+    history = glm::vec4(color, accumulatedFrames);
+
+    color = acesToneMapping(color);
+    if (bgr) {
+        std::swap(color.r, color.b);
+    }
+
+    uint8_t* out = &pixels[pixel * 4];
+    out[0] = toUnorm8(color.r);
+    out[1] = toUnorm8(color.g);
+    out[2] = toUnorm8(color.b);
+    out[3] = 255;
+}
+
+glm::vec3 CpuPathTracer::trace(const Frame& frame, const glm::vec3& origin, const glm::vec3& direction,
+                               float tMin, float tMax, int depth, RayType rayType) const {
+    Bvh::Ray ray = modelRay(frame.modelInverse, origin, direction, tMin, tMax);
+    Bvh::Hit hit;
+    if (!wideBvh.intersect(ray, hit)) {
+        return sky(direction, rayType);
+    }
+    return shade(frame, origin, direction, hit.t + tMin, hit.triangle, depth);
+}
+
+glm::vec3 CpuPathTracer::shade(const Frame& frame, const glm::vec3& origin, const glm::vec3& direction,
+                               float hitT, uint32_t triangle, int depth) const {
+    ShadePoint point;
+    beginShade(frame, origin, direction, hitT, triangle, depth, point);
+
+    glm::vec3 bounceOrigin = point.worldPos + point.surfaceNormal * 0.001f;
+    if (point.tracesReflection) {
+        point.reflection = trace(frame, bounceOrigin, point.reflectionDirection, 0.001f, 100.0f, depth + 1, RAY_REFLECTION);
+    }
+    if (point.tracesGi) {
+        point.gi = trace(frame, bounceOrigin, point.giDirection, 0.001f, 20.0f, depth + 1, RAY_GI);
+    }
+    return finishShade(frame, point);
+}
+
+void CpuPathTracer::beginShade(const Frame& frame, const glm::vec3& origin, const glm::vec3& direction,
+                               float hitT, uint32_t triangle, int depth, ShadePoint& point) const {
+    const UniformBufferObject& cam = *frame.ubo;
+    Rng rng;
+
+    point.origin = origin;
+    point.depth = depth;
+    point.tracesReflection = false;
+    point.tracesGi = false;
+    point.reflection = glm::vec3(0.0f);
+    point.gi = glm::vec3(0.0f);
+    if (depth > 10) {
+        return;   // finishShade returns the shader's debug red
+    }
+
+    glm::vec3 worldPos = origin + direction * hitT;
+    glm::vec3 rayDir = glm::normalize(direction);
+
+    // The shader's view-facing pseudo normal, perturbed by position
+    glm::vec3 surfaceNormal = glm::normalize(-rayDir + glm::vec3(std::sin(worldPos.x * 2.0f), std::cos(worldPos.y * 2.0f),
+                                                                 std::sin(worldPos.z * 2.0f)) * 0.1f);
+
+    // Material: personality colour and finish, the eyes keep their own
+    glm::vec3 albedo = personalityBaseColor(cam, worldPos);
+    float metallic;
+    float roughness;
+    switch (cam.personalityMode) {
+        case 1: metallic = 0.98f; roughness = 0.05f; break;
+        case 2: metallic = 0.8f;  roughness = 0.15f; break;
+        case 3: metallic = 0.99f; roughness = 0.02f; break;
+        case 4: metallic = 0.85f; roughness = 0.2f;  break;
+        case 5: metallic = 0.75f; roughness = 0.3f;  break;
+        default:
+            metallic = std::max(cam.metallic, 0.9f);
+            roughness = glm::clamp(cam.roughness * 0.6f, 0.05f, 0.3f);
+            break;
+    }
+
+    ClippyGeometry::PartMaterial material = triangleMaterials[triangle];
+    if (material == ClippyGeometry::MATERIAL_EYE) {
+        albedo = glm::vec3(0.02f);
+        metallic = 0.0f;
+        roughness = 0.1f;
+    } else if (material == ClippyGeometry::MATERIAL_HIGHLIGHT) {
+        albedo = glm::vec3(1.0f);
+        metallic = 0.0f;
+        roughness = 0.3f;
+    }
+
+    glm::vec3 F0 = glm::mix(glm::vec3(0.04f), albedo, metallic);
+
+    glm::vec3 lightDir = glm::normalize(glm::vec3(0.3f, 1.0f, 0.2f));
+    glm::vec3 lightColor(3.5f, 3.0f, 2.5f);
+    glm::vec3 viewDir = glm::normalize(cam.cameraPos - worldPos);
+    glm::vec3 halfwayDir = glm::normalize(lightDir + viewDir);
+
+    float NdotL = std::max(glm::dot(surfaceNormal, lightDir), 0.0f);
+    float NdotV = std::max(glm::dot(surfaceNormal, viewDir), 0.01f);
+    float NdotH = std::max(glm::dot(surfaceNormal, halfwayDir), 0.0f);
+    float VdotH = std::max(glm::dot(viewDir, halfwayDir), 0.0f);
+
+    glm::vec3 finalColor(0.0f);
+
+    // Cook-Torrance: GGX distribution, Smith geometry, Schlick Fresnel
+    if (NdotL > 0.0f) {
+        float alpha = roughness * roughness;
+        float alpha2 = alpha * alpha;
+        float denom = NdotH * NdotH * (alpha2 - 1.0f) + 1.0f;
+        float NDF = alpha2 / std::max(PI * denom * denom, 0.0001f);
+
+        float k = (roughness + 1.0f) * (roughness + 1.0f) / 8.0f;
+        float G1L = NdotL / std::max(NdotL * (1.0f - k) + k, 0.0001f);
+        float G1V = NdotV / std::max(NdotV * (1.0f - k) + k, 0.0001f);
+        float G = G1L * G1V;
+
+        glm::vec3 F = F0 + (1.0f - F0) * std::pow(glm::clamp(1.0f - VdotH, 0.0f, 1.0f), 5.0f);
+
+        glm::vec3 specular = NDF * G * F / std::max(4.0f * NdotV * NdotL, 0.0001f);
+        glm::vec3 kD = (glm::vec3(1.0f) - F) * (1.0f - metallic);
+
+        finalColor = (kD * albedo / PI + specular) * lightColor * NdotL;
+
+        if (cam.subsurfaceScattering > 0.0f) {
+            finalColor += advancedSSS(cam, surfaceNormal, lightDir, albedo) * lightColor;
+        }
+    }
+
+    // Reflection bounce
+    if (metallic > 0.1f && depth < cam.maxBounces) {
+        point.tracesReflection = true;
+        point.reflectionDirection = glm::reflect(rayDir, surfaceNormal);
+    }
+
+    // Diffuse GI bounce
+    if (depth < cam.maxBounces - 1 && (1.0f - metallic) > 0.1f) {
+        rng.state = wangHash(toUint(worldPos.x * 1000.0f) + toUint(worldPos.y * 2000.0f) +
+                             toUint(static_cast<float>(depth) * 100.0f) + static_cast<uint32_t>(cam.frameCount));
+        point.tracesGi = true;
+        point.giDirection = cosineWeightedSample(surfaceNormal, rng);
+    }
+
+    point.worldPos = worldPos;
+    point.rayDir = rayDir;
+    point.surfaceNormal = surfaceNormal;
+    point.albedo = albedo;
+    point.directColor = finalColor;
+    point.metallic = metallic;
+    point.rngState = rng.state;
+}
+
+glm::vec3 CpuPathTracer::finishShade(const Frame& frame, const ShadePoint& point) const {
+    const UniformBufferObject& cam = *frame.ubo;
+    int depth = point.depth;
+
+    if (depth > 10) {
+        return glm::vec3(10.0f, 0.0f, 0.0f);
+    }
+
+    glm::vec3 depthDebugColor;
+    if (depth == 0) depthDebugColor = glm::vec3(0.05f, 0.0f, 0.0f);
+    else if (depth == 1) depthDebugColor = glm::vec3(0.0f, 0.05f, 0.0f);
+    else if (depth == 2) depthDebugColor = glm::vec3(0.0f, 0.0f, 0.05f);
+    else depthDebugColor = glm::vec3(0.05f, 0.05f, 0.0f);
+
+    const glm::vec3& worldPos = point.worldPos;
+    const glm::vec3& rayDir = point.rayDir;
+    const glm::vec3& surfaceNormal = point.surfaceNormal;
+    const glm::vec3& albedo = point.albedo;
+    float metallic = point.metallic;
+    glm::vec3 lightDir = glm::normalize(glm::vec3(0.3f, 1.0f, 0.2f));
+    glm::vec3 lightColor(3.5f, 3.0f, 2.5f);
+
+    glm::vec3 finalColor = point.directColor;
+
+    glm::vec3 reflectionContrib(0.0f);
+    if (point.tracesReflection) {
+        if (isValidReflection(point.reflection)) {
+            float depthFalloff = 1.0f / (1.0f + static_cast<float>(depth) * 0.5f);
+            float fresnel = std::pow(1.0f - std::max(0.0f, glm::dot(-rayDir, surfaceNormal)), 2.0f);
+            reflectionContrib = point.reflection * metallic * fresnel * depthFalloff * 0.3f;
+        } else {
+            float skyFactor = std::max(0.0f, point.reflectionDirection.y);
+            reflectionContrib = glm::mix(glm::vec3(0.1f, 0.15f, 0.3f), glm::vec3(0.3f, 0.5f, 0.8f), skyFactor) * metallic * 0.15f;
+        }
+    }
+
+    finalColor += albedo * glm::vec3(0.8f, 0.6f, 0.2f) * 0.4f;   // Golden ambient
+    finalColor += reflectionContrib;
+
+    if (point.tracesGi) {
+        float giStrength = 0.3f * (1.0f - metallic);
+        float depthFalloff = 1.0f / (1.0f + static_cast<float>(depth) * 0.5f);
+        finalColor += point.gi * albedo * giStrength * depthFalloff;
+    }
+
+    if (cam.causticsStrength > 0.0f) {
+        finalColor += causticPattern(cam, worldPos, glm::reflect(rayDir, surfaceNormal), lightDir) * 0.2f;
+    }
+
+    // Volumetric light and atmospheric perspective, primary rays only
+    Rng rng;
+    rng.state = point.rngState;
+    glm::vec3 volumetricContrib(0.0f);
+    if (cam.volumetricDensity > 0.0f && depth == 0) {
+        volumetricContrib = volumetricScattering(cam, point.origin, worldPos, lightDir, lightColor, rng);
+
+        float rayDistance = glm::length(worldPos - point.origin);
+        float atmosphericFactor = 1.0f - std::exp(-rayDistance * cam.volumetricDensity * 0.05f);
+        finalColor = glm::mix(finalColor, glm::vec3(0.5f, 0.7f, 1.0f), atmosphericFactor * 0.3f);
+    }
+    finalColor += volumetricContrib;
+
+    finalColor += albedo * 0.15f * (1.0f + std::sin(cam.time * 3.0f) * 0.3f);   // Emissive glow
+    finalColor = glm::max(finalColor, glm::vec3(0.4f, 0.3f, 0.1f));
+    finalColor += depthDebugColor;
+
+    finalColor = holographicEffect(cam, finalColor, worldPos);
+    finalColor = glitchEffect(cam, finalColor, worldPos, rng);
+
+    return finalColor / (finalColor + glm::vec3(1.2f));
+}
+
+glm::vec3 CpuPathTracer::sky(const glm::vec3& direction, RayType rayType) {
+    glm::vec3 rayDir = glm::normalize(direction);
+
+    float skyFactor = (rayDir.y + 1.0f) * 0.5f;
+    glm::vec3 horizonColor(0.8f, 0.9f, 1.0f);
+    glm::vec3 zenithColor(0.2f, 0.4f, 0.8f);
+    glm::vec3 skyColor = glm::mix(zenithColor, horizonColor, skyFactor * skyFactor);
+
+    glm::vec3 sunDir = glm::normalize(glm::vec3(0.3f, 1.0f, 0.2f));
+    float sunDot = glm::dot(rayDir, sunDir);
+    if (sunDot > 0.98f) {
+        skyColor += glm::vec3(3.0f, 2.8f, 2.0f) * (sunDot - 0.98f) * 50.0f;
+    }
+
+    float glow = std::max(0.0f, sunDot);
+    skyColor += glm::vec3(1.0f, 0.8f, 0.4f) * std::pow(glow, 4.0f) * 0.3f;
+    skyColor = glm::max(skyColor, glm::vec3(0.15f, 0.2f, 0.35f));
+
+    // GI rays see a dimmer sky
+    return rayType == RAY_GI ? skyColor * 0.5f : skyColor;
+}
+
+bool CpuPathTracer::writePPM(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        LOG_WARN("⚠️  Could not write CPU trace frame " << path);
+        return false;
+    }
+
+    file << "P6\n" << width << " " << height << "\n255\n";
+
+    std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t* src = pixels.data() + static_cast<size_t>(y) * width * 4;
+        for (uint32_t x = 0; x < width; x++) {
+            row[x * 3 + 0] = src[x * 4 + (bgr ? 2 : 0)];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + (bgr ? 0 : 2)];
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+    return file.good();
+}
+
+UniformBufferObject CpuPathTracer::defaultUniforms(float time, uint32_t frame, uint32_t width, uint32_t height) {
+    UniformBufferObject ubo{};
+
+    ubo.model = glm::rotate(glm::mat4(1.0f), time * 0.5f, glm::vec3(0.0f, 1.0f, 0.0f));
+    ubo.model = glm::translate(ubo.model, glm::vec3(0.0f, std::sin(time * 2.0f) * 0.1f, 0.0f));
+
+    glm::vec3 cameraPos(std::sin(time * 0.3f) * 5.0f, 2.0f, std::cos(time * 0.3f) * 5.0f);
+    ubo.view = glm::lookAt(cameraPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    ubo.proj = glm::perspective(glm::radians(60.0f), width / static_cast<float>(height), 0.1f, 100.0f);
+    ubo.proj[1][1] *= -1;
+    ubo.viewInverse = glm::inverse(ubo.view);
+    ubo.projInverse = glm::inverse(ubo.proj);
+    ubo.cameraPos = cameraPos;
+
+    Material material;
+    ubo.time = time;
+    ubo.metallic = material.metallic;
+    ubo.roughness = material.roughness;
+    ubo.rtxEnabled = 1;
+    ubo.resolution = glm::vec2(static_cast<float>(width), static_cast<float>(height));
+    ubo.glowIntensity = 1.0f + std::sin(time * 3.0f) * 0.3f;
+    ubo.frameCount = static_cast<int>(frame);
+    ubo.maxBounces = 2;
+    ubo.samplesPerPixel = 1;
+    ubo.isBGRFormat = 0;
+
+    ubo.volumetricDensity = 0.1f;
+    ubo.volumetricScattering = 0.8f;
+    ubo.glassRefractionIndex = 1.5f;
+    ubo.causticsStrength = 0.6f;
+    ubo.subsurfaceScattering = 0.4f;
+    ubo.subsurfaceRadius = 0.8f;
+
+    // IDLE personality
+    ubo.personalityMode = 0;
+    ubo.animationStrength = 1.0f;
+    ubo.personalityColorA = glm::vec3(1.0f, 0.843f, 0.0f);
+    ubo.personalityColorB = glm::vec3(1.0f, 0.667f, 0.0f);
+    ubo.holographicStrength = 0.2f;
+    ubo.glitchIntensity = 0.0f;
+    ubo.accumulationFrame = 0;
+    return ubo;
+}
+
+bool CpuPathTracer::writePacketReport(const std::string& path, uint32_t width, uint32_t height) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        LOG_ERROR("❌ Could not write packet tracing report to " << path);
+        return false;
+    }
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<ClippyGeometry::Part> parts;
+    std::vector<ClippyGeometry::PartInstance> instances;
+    ClippyGeometry::generateClippyParts(vertices, indices, parts, instances);
+    CpuPathTracer tracer(1);
+    tracer.setScene(vertices, indices, parts, instances);
+
+    UniformBufferObject ubo = defaultUniforms(1.0f, 0, width, height);
+    glm::mat4 modelInverse = glm::inverse(ubo.model);
+    glm::vec2 imageSize(static_cast<float>(width), static_cast<float>(height));
+    glm::vec3 sunDirection = glm::vec3(modelInverse * glm::vec4(glm::normalize(glm::vec3(0.3f, 1.0f, 0.2f)), 0.0f));
+
+    auto packetRay = [](const RayPacketTracer::Packet& packet, uint32_t i) {
+        Bvh::Ray ray;
+        ray.origin = glm::vec3(packet.originX[i], packet.originY[i], packet.originZ[i]);
+        ray.direction = glm::vec3(packet.directionX[i], packet.directionY[i], packet.directionZ[i]);
+        ray.tMax = packet.tMax[i];
+        return ray;
+    };
+
+    // Every method traces the same packet while it is in cache, each timed on its own, so the
+    // numbers compare traversal and not how the rays are stored
+    enum { SCALAR, WIDE, PACKET, SHADOW_CLOSEST, SHADOW_ANY, SHADOW_PACKET, METHOD_COUNT };
+    double seconds[METHOD_COUNT] = {};
+    auto timed = [&](int method, const std::function<void()>& work) {
+        auto start = std::chrono::high_resolution_clock::now();
+        work();
+        seconds[method] += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    };
+
+    uint64_t primaryRays = 0;
+    uint64_t shadowRays = 0;
+    uint64_t packetCount = 0;
+    uint64_t shadowPacketCount = 0;
+    uint64_t primaryHitCount = 0;
+    uint64_t occludedCount = 0;
+    uint32_t primaryMismatches = 0;
+    uint32_t shadowMismatches = 0;
+    RayPacketTracer::Stats primaryStats;
+    RayPacketTracer::Stats shadowStats;
+
+    // The default camera's primary rays in 8x8 packets (edge packets stay partial)
+    const uint32_t block = RayPacketTracer::PACKET_WIDTH;
+    for (uint32_t by = 0; by < height; by += block) {
+        for (uint32_t bx = 0; bx < width; bx += block) {
+            RayPacketTracer::Packet packet{};
+            for (uint32_t y = by; y < std::min(by + block, height); y++) {
+                for (uint32_t x = bx; x < std::min(bx + block, width); x++) {
+                    Rng rng;
+                    glm::vec3 origin, direction;
+                    cameraRay(ubo, imageSize, x, y, 1, rng, origin, direction);
+                    packet.setRay(RayPacketTracer::rayIndex(x - bx, y - by),
+                                  modelRay(modelInverse, origin, direction, 0.001f, 1000.0f));
+                }
+            }
+            packetCount++;
+            primaryRays += std::bitset<64>(packet.activeMask).count();
+
+            Bvh::Hit scalarHits[RayPacketTracer::PACKET_SIZE];
+            Bvh::Hit wideHits[RayPacketTracer::PACKET_SIZE];
+            Bvh::Hit packetHits[RayPacketTracer::PACKET_SIZE];
+            timed(SCALAR, [&] {
+                for (uint32_t i = 0; i < RayPacketTracer::PACKET_SIZE; i++) {
+                    if (packet.activeMask & (1ull << i)) tracer.bvh.intersect(packetRay(packet, i), scalarHits[i]);
+                }
+            });
+            timed(WIDE, [&] {
+                for (uint32_t i = 0; i < RayPacketTracer::PACKET_SIZE; i++) {
+                    if (packet.activeMask & (1ull << i)) tracer.wideBvh.intersect(packetRay(packet, i), wideHits[i]);
+                }
+            });
+            timed(PACKET, [&] { tracer.packetTracer.intersect(packet, packetHits, &primaryStats); });
+
+            // Shadow rays from the pixels that hit, towards closesthit.rchit's sun
+            RayPacketTracer::Packet shadow{};
+            for (uint32_t i = 0; i < RayPacketTracer::PACKET_SIZE; i++) {
+                if (!(packet.activeMask & (1ull << i))) continue;
+                const Bvh::Hit& hit = packetHits[i];
+                const Bvh::Hit& reference = scalarHits[i];
+                if ((hit.triangle == UINT32_MAX) != (reference.triangle == UINT32_MAX) ||
+                    std::abs(hit.t - reference.t) > 1e-4f * std::max(1.0f, reference.t)) {
+                    primaryMismatches++;
+                }
+                if (hit.triangle == UINT32_MAX) continue;
+
+                primaryHitCount++;
+                Bvh::Ray ray = packetRay(packet, i);
+                Bvh::Ray shadowRay;
+                shadowRay.origin = ray.origin + ray.direction * hit.t + sunDirection * 0.001f;
+                shadowRay.direction = sunDirection;
+                shadowRay.tMax = 1000.0f;
+                shadow.setRay(i, shadowRay);
+            }
+            if (shadow.activeMask == 0) continue;
+            shadowPacketCount++;
+            shadowRays += std::bitset<64>(shadow.activeMask).count();
+
+            uint64_t closestOccluded = 0;
+            uint64_t anyOccluded = 0;
+            uint64_t packetOccluded = 0;
+            timed(SHADOW_CLOSEST, [&] {
+                for (uint32_t i = 0; i < RayPacketTracer::PACKET_SIZE; i++) {
+                    Bvh::Hit hit;
+                    if ((shadow.activeMask & (1ull << i)) && tracer.wideBvh.intersect(packetRay(shadow, i), hit)) {
+                        closestOccluded |= 1ull << i;
+                    }
+                }
+            });
+            timed(SHADOW_ANY, [&] {
+                for (uint32_t i = 0; i < RayPacketTracer::PACKET_SIZE; i++) {
+                    if ((shadow.activeMask & (1ull << i)) && tracer.packetTracer.occluded(packetRay(shadow, i))) {
+                        anyOccluded |= 1ull << i;
+                    }
+                }
+            });
+            timed(SHADOW_PACKET, [&] { packetOccluded = tracer.packetTracer.occluded(shadow, &shadowStats); });
+
+            occludedCount += std::bitset<64>(packetOccluded).count();
+            shadowMismatches += static_cast<uint32_t>(std::bitset<64>(packetOccluded ^ closestOccluded).count());
+        }
+    }
+
+    double mrays[METHOD_COUNT];
+    for (int method = 0; method < METHOD_COUNT; method++) {
+        uint64_t rays = method < SHADOW_CLOSEST ? primaryRays : shadowRays;
+        mrays[method] = rays / std::max(seconds[method], 1e-9) / 1.0e6;
+    }
+    auto writeStats = [&](const RayPacketTracer::Stats& stats) {
+        out << "\"nodeVisits\": " << stats.nodeVisits << ", \"frustumCulls\": " << stats.frustumCulls
+            << ", \"splits\": " << stats.splits << ", \"singleRayTraversals\": " << stats.singleRays;
+    };
+
+    out << "{\n";
+    out << "  \"width\": " << width << ",\n";
+    out << "  \"height\": " << height << ",\n";
+    out << "  \"triangles\": " << tracer.bvh.getTriangles().size() << ",\n";
+    out << "  \"wideIsa\": \"" << WideBvh::isaName(tracer.wideBvh.getIsa()) << "\",\n";
+    out << "  \"primary\": {\"rays\": " << primaryRays << ", \"packets\": " << packetCount
+        << ", \"hitRate\": " << static_cast<double>(primaryHitCount) / std::max<uint64_t>(primaryRays, 1)
+        << ", \"scalarMraysPerSecond\": " << mrays[SCALAR] << ", \"wideMraysPerSecond\": " << mrays[WIDE]
+        << ", \"packetMraysPerSecond\": " << mrays[PACKET] << ", \"mismatches\": " << primaryMismatches << ", ";
+    writeStats(primaryStats);
+    out << "},\n";
+    out << "  \"shadow\": {\"rays\": " << shadowRays << ", \"packets\": " << shadowPacketCount
+        << ", \"occludedRate\": " << static_cast<double>(occludedCount) / std::max<uint64_t>(shadowRays, 1)
+        << ", \"closestHitMraysPerSecond\": " << mrays[SHADOW_CLOSEST]
+        << ", \"anyHitMraysPerSecond\": " << mrays[SHADOW_ANY]
+        << ", \"packetMraysPerSecond\": " << mrays[SHADOW_PACKET] << ", \"mismatches\": " << shadowMismatches << ", ";
+    writeStats(shadowStats);
+    out << "}\n";
+    out << "}\n";
+
+    LOG_INFO("📦 Primary rays: " << mrays[SCALAR] << " Mrays/s scalar, " << mrays[WIDE] << " Mrays/s "
+             << WideBvh::isaName(tracer.wideBvh.getIsa()) << ", " << mrays[PACKET] << " Mrays/s packets ("
+             << primaryMismatches << " mismatches)");
+    LOG_INFO("📦 Shadow rays: " << mrays[SHADOW_CLOSEST] << " Mrays/s closest-hit, " << mrays[SHADOW_ANY]
+             << " Mrays/s any-hit, " << mrays[SHADOW_PACKET] << " Mrays/s packets (" << shadowMismatches << " mismatches)");
+    LOG_INFO("📦 Packet tracing report written to " << path);
+    return true;
+}
+
+bool CpuPathTracer::writeWavefrontReport(const std::string& path, uint32_t width, uint32_t height, uint32_t threadCount) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        LOG_ERROR("❌ Could not write wavefront report to " << path);
+        return false;
+    }
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<ClippyGeometry::Part> parts;
+    std::vector<ClippyGeometry::PartInstance> instances;
+    ClippyGeometry::generateClippyParts(vertices, indices, parts, instances);
+    CpuPathTracer tracer(threadCount);
+    tracer.setScene(vertices, indices, parts, instances);
+
+    // The default orbit camera, where Clippy covers a few percent of the frame, and the same
+    // camera moved in until it fills it, so bounces are a real share of the work
+    struct View {
+        const char* name;
+        float distance;
+    };
+    const View views[] = {{"orbit", 0.0f}, {"closeUp", 2.0f}};
+    const int bounceCounts[] = {2, 4};
+    const uint32_t FRAMES = 5;
+
+    enum { RECURSIVE, WAVEFRONT, SORTED, CONFIG_COUNT };
+    const char* configNames[CONFIG_COUNT] = {"recursive", "wavefront", "wavefrontSorted"};
+
+    out << "{\n";
+    out << "  \"width\": " << width << ",\n";
+    out << "  \"height\": " << height << ",\n";
+    out << "  \"threads\": " << tracer.getThreadCount() << ",\n";
+    out << "  \"framesPerRun\": " << FRAMES << ",\n";
+    out << "  \"workloads\": [\n";
+
+    bool firstWorkload = true;
+    for (const View& view : views) {
+        for (int maxBounces : bounceCounts) {
+            double frameMs[CONFIG_COUNT] = {};
+            uint64_t differingBytes[CONFIG_COUNT] = {};
+            WavefrontStats stats[CONFIG_COUNT];
+            std::vector<uint8_t> reference;
+
+            for (int config = 0; config < CONFIG_COUNT; config++) {
+                tracer.setWavefront(config != RECURSIVE);
+                tracer.setRaySorting(config == SORTED);
+
+                // One untimed frame first, so every run starts with its buffers allocated
+                for (uint32_t frame = 0; frame <= FRAMES; frame++) {
+                    UniformBufferObject ubo = defaultUniforms(1.0f + frame / 60.0f, frame, width, height);
+                    ubo.maxBounces = maxBounces;
+                    if (view.distance > 0.0f) {
+                        ubo.cameraPos = glm::normalize(ubo.cameraPos) * view.distance;
+                        ubo.view = glm::lookAt(ubo.cameraPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+                        ubo.viewInverse = glm::inverse(ubo.view);
+                    }
+                    tracer.render(ubo, width, height);
+                    if (frame == 0) continue;
+
+                    frameMs[config] += tracer.getLastRenderMs() / FRAMES;
+                    if (config != RECURSIVE) {
+                        const WavefrontStats& last = tracer.getWavefrontStats();
+                        stats[config].primaryRays = last.primaryRays;
+                        stats[config].secondaryRays += last.secondaryRays / FRAMES;
+                        stats[config].bounces = std::max(stats[config].bounces, last.bounces);
+                        stats[config].sortMs += last.sortMs / FRAMES;
+                        stats[config].secondaryTraceMs += last.secondaryTraceMs / FRAMES;
+                    }
+                }
+
+                // Same image from every config (last frame)
+                if (config == RECURSIVE) {
+                    reference = tracer.getPixels();
+                } else {
+                    for (size_t i = 0; i < reference.size(); i++) {
+                        differingBytes[config] += reference[i] != tracer.getPixels()[i] ? 1 : 0;
+                    }
+                }
+            }
+
+            // The recursion traces the same rays, so the wavefront's counts stand for all three
+            uint64_t raysPerFrame = stats[WAVEFRONT].primaryRays + stats[WAVEFRONT].secondaryRays;
+            auto mrays = [](uint64_t rays, double ms) { return rays / std::max(ms, 1e-6) / 1000.0; };
+
+            out << (firstWorkload ? "" : ",\n");
+            firstWorkload = false;
+            out << "    {\"view\": \"" << view.name << "\", \"maxBounces\": " << maxBounces
+                << ", \"primaryRays\": " << stats[WAVEFRONT].primaryRays
+                << ", \"secondaryRays\": " << stats[WAVEFRONT].secondaryRays
+                << ", \"secondaryBounces\": " << stats[WAVEFRONT].bounces << ", \"configs\": [\n";
+            for (int config = 0; config < CONFIG_COUNT; config++) {
+                out << "      {\"name\": \"" << configNames[config] << "\", \"msPerFrame\": " << frameMs[config]
+                    << ", \"MraysPerSecond\": " << mrays(raysPerFrame, frameMs[config]);
+                if (config != RECURSIVE) {
+                    out << ", \"secondaryTraceMs\": " << stats[config].secondaryTraceMs
+                        << ", \"secondaryTraceMraysPerSecond\": " << mrays(stats[config].secondaryRays, stats[config].secondaryTraceMs)
+                        << ", \"sortMs\": " << stats[config].sortMs << ", \"differingBytes\": " << differingBytes[config];
+                }
+                out << "}" << (config + 1 < CONFIG_COUNT ? "," : "") << "\n";
+            }
+            out << "    ]}";
+
+            LOG_INFO("🌊 " << view.name << ", " << maxBounces << " bounces (" << stats[WAVEFRONT].secondaryRays
+                     << " secondary rays/frame): " << frameMs[RECURSIVE] << " ms recursive, " << frameMs[WAVEFRONT]
+                     << " ms wavefront, " << frameMs[SORTED] << " ms sorted (" << stats[SORTED].sortMs << " ms sort)");
+        }
+    }
+
+    out << "\n  ]\n";
+    out << "}\n";
+
+    LOG_INFO("🌊 Wavefront report written to " << path);
+    return true;
+}
@@ -0,0 +1,213 @@
+#include "DeformationPass.h"
+#include "VulkanHelpers.h"
+#include "Logger.h"
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+DeformationPass::DeformationPass(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool,
+                                 VkQueue queue, VkBuffer sourceVertices, const std::vector<Vertex>& vertices,
+                                 UniformRing& uniformRing, VkDeviceSize uniformRange, VkPipelineCache pipelineCache)
+    : device(device), vertexCount(static_cast<uint32_t>(vertices.size())) {
+    VkDeviceSize bufferSize = POSITION_STRIDE * vertexCount;
+    VulkanHelpers::createBuffer(device, physicalDevice, bufferSize,
+                                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+                                VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
+                                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, positionBuffer, positionMemory);
+
+    // Rest pose
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingMemory;
+    VulkanHelpers::createBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                stagingBuffer, stagingMemory);
+
+    void* data;
+    vkMapMemory(device, stagingMemory, 0, bufferSize, 0, &data);
+    float* positions = static_cast<float*>(data);
+    for (uint32_t i = 0; i < vertexCount; i++) {
+        positions[i * 3 + 0] = vertices[i].pos.x;
+        positions[i * 3 + 1] = vertices[i].pos.y;
+        positions[i * 3 + 2] = vertices[i].pos.z;
+    }
+    vkUnmapMemory(device, stagingMemory);
+
+    VulkanHelpers::copyBuffer(device, commandPool, queue, stagingBuffer, positionBuffer, bufferSize);
+
+    vkDestroyBuffer(device, stagingBuffer, nullptr);
+    vkFreeMemory(device, stagingMemory, nullptr);
+
+    createDescriptors(sourceVertices, uniformRing, uniformRange);
+    createPipeline(pipelineCache);
+
+    LOG_INFO("✅ Deformation pass ready: " << vertexCount << " vertices -> "
+             << POSITION_STRIDE * vertexCount << " byte position buffer");
+}
+
+DeformationPass::~DeformationPass() {
+    vkDestroyPipeline(device, pipeline, nullptr);
+    vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+    vkDestroyBuffer(device, positionBuffer, nullptr);
+    vkFreeMemory(device, positionMemory, nullptr);
+}
+
+void DeformationPass::createDescriptors(VkBuffer sourceVertices, UniformRing& uniformRing, VkDeviceSize uniformRange) {
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+    for (uint32_t i = 0; i < 2; i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    bindings[2].binding = 2;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    bindings[2].descriptorCount = 1;
+    bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create deformation descriptor set layout!");
+    }
+
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[0].descriptorCount = 2;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    poolSizes[1].descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = 1;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create deformation descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &descriptorSetLayout;
+
+    if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate deformation descriptor set!");
+    }
+
+    // One set serves every frame: the frame's uniform region is picked by the dynamic offset
+    std::array<VkDescriptorBufferInfo, 3> bufferInfos{};
+    bufferInfos[0] = {sourceVertices, 0, VK_WHOLE_SIZE};
+    bufferInfos[1] = {positionBuffer, 0, VK_WHOLE_SIZE};
+    bufferInfos[2] = {uniformRing.getBuffer(), 0, uniformRange};
+
+    std::array<VkWriteDescriptorSet, 3> writes{};
+    for (uint32_t i = 0; i < writes.size(); i++) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = descriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorType = bindings[i].descriptorType;
+        writes[i].descriptorCount = 1;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+void DeformationPass::createPipeline(VkPipelineCache pipelineCache) {
+    VkPushConstantRange pushRange{};
+    pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(uint32_t);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create deformation pipeline layout!");
+    }
+
+    auto shaderCode = VulkanHelpers::readFile("shaders/deform.comp.spv");
+    VkShaderModule shaderModule = VulkanHelpers::createShaderModule(device, shaderCode);
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = pipelineLayout;
+
+    VkResult result = vkCreateComputePipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline);
+    vkDestroyShaderModule(device, shaderModule, nullptr);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create deformation compute pipeline!");
+    }
+}
+
+void DeformationPass::record(VkCommandBuffer commandBuffer, uint32_t uniformOffset) {
+    // The previous frame's BLAS refit may still be reading the positions this dispatch overwrites
+    VkBufferMemoryBarrier refitDone{};
+    refitDone.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    refitDone.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_SHADER_READ_BIT;
+    refitDone.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    refitDone.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    refitDone.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    refitDone.buffer = positionBuffer;
+    refitDone.offset = 0;
+    refitDone.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 0, nullptr, 1, &refitDone, 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+                            0, 1, &descriptorSet, 1, &uniformOffset);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+                       0, sizeof(vertexCount), &vertexCount);
+    vkCmdDispatch(commandBuffer, (vertexCount + 63) / 64, 1, 1);
+
+    // Positions are read by the BLAS build/refit that follows
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = positionBuffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                         0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+float DeformationPass::maxDisplacement(int personalityMode, float animationStrength, float glitchIntensity,
+                                       float boundingRadius) {
+    // Sum of the per-axis wave amplitudes in deform.comp, per mode
+    float amplitude = 0.0f;
+    switch (personalityMode) {
+        case 0: amplitude = 0.03f + 0.02f; break;
+        case 1: amplitude = 0.15f + 0.08f + 0.05f; break;
+        case 2: amplitude = 0.06f + 0.04f + 0.08f + 0.03f * glitchIntensity * std::sqrt(3.0f); break;
+        case 3: amplitude = 0.12f + 0.10f + 0.08f + 0.05f * boundingRadius; break;
+        case 4: amplitude = 0.06f + 0.04f + 0.05f; break;
+        case 5: amplitude = 0.04f + 0.03f; break;
+        default: break;
+    }
+    amplitude += 0.1f;   // Mouse push along the normal
+    return amplitude * std::abs(animationStrength);
+}
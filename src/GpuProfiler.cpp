@@ -0,0 +1,202 @@
+#include "GpuProfiler.h"
+#include "Logger.h"
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+GpuProfiler::GpuProfiler(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamily,
+                         uint32_t framesInFlight, uint32_t maxScopesPerFrame)
+    : device(device), queriesPerFrame(maxScopesPerFrame * 2) {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+
+    uint32_t validBits = queueFamily < familyCount ? families[queueFamily].timestampValidBits : 0;
+    if (validBits == 0 || properties.limits.timestampPeriod == 0.0f) {
+        LOG_WARN("⚠️  GPU timestamps not supported on this queue - profiler disabled");
+        return;
+    }
+
+    timestampPeriodNs = properties.limits.timestampPeriod;
+    timestampMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = queriesPerFrame * framesInFlight;
+
+    if (vkCreateQueryPool(device, &poolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+
+    frames.resize(framesInFlight);
+    resultScratch.resize(queriesPerFrame * 2);   // value + availability per query
+
+    LOG_INFO("✅ GPU profiler ready: " << maxScopesPerFrame << " scopes/frame, period "
+             << timestampPeriodNs << " ns");
+}
+
+GpuProfiler::~GpuProfiler() {
+    if (queryPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, queryPool, nullptr);
+    }
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+    if (!isSupported()) return;
+
+    collectResults(frameIndex);
+
+    FrameSlot& slot = frames[frameIndex];
+    slot.scopes.clear();
+    slot.openScopes.clear();
+    slot.nextQuery = 0;
+    slot.hasResults = true;
+    currentSlot = frameIndex;
+
+    vkCmdResetQueryPool(commandBuffer, queryPool, frameIndex * queriesPerFrame, queriesPerFrame);
+}
+
+void GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const char* name) {
+    if (!isSupported()) return;
+
+    FrameSlot& slot = frames[currentSlot];
+    if (slot.nextQuery + 2 > queriesPerFrame) {
+        slot.openScopes.push_back(SIZE_MAX);   // Out of queries: keep the stack balanced
+        return;
+    }
+
+    RecordedScope scope{};
+    scope.scopeId = scopeIdFor(name);
+    scope.beginQuery = currentSlot * queriesPerFrame + slot.nextQuery++;
+    scope.endQuery = currentSlot * queriesPerFrame + slot.nextQuery++;
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, scope.beginQuery);
+
+    slot.openScopes.push_back(slot.scopes.size());
+    slot.scopes.push_back(scope);
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer) {
+    if (!isSupported()) return;
+
+    FrameSlot& slot = frames[currentSlot];
+    if (slot.openScopes.empty()) return;
+
+    size_t index = slot.openScopes.back();
+    slot.openScopes.pop_back();
+    if (index == SIZE_MAX) return;
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool,
+                        slot.scopes[index].endQuery);
+}
+
+void GpuProfiler::collectResults(uint32_t frameIndex) {
+    FrameSlot& slot = frames[frameIndex];
+    if (!slot.hasResults || slot.nextQuery == 0) return;
+
+    // No WAIT flag: the frame timeline guarantees completion, and if anything is still
+    // unavailable it is simply skipped instead of stalling the CPU
+    VkResult result = vkGetQueryPoolResults(device, queryPool, frameIndex * queriesPerFrame, slot.nextQuery,
+                                            resultScratch.size() * sizeof(uint64_t), resultScratch.data(),
+                                            2 * sizeof(uint64_t),
+                                            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result != VK_SUCCESS && result != VK_NOT_READY) return;
+
+    uint32_t base = frameIndex * queriesPerFrame;
+    for (const RecordedScope& scope : slot.scopes) {
+        uint32_t b = scope.beginQuery - base;
+        uint32_t e = scope.endQuery - base;
+        if (resultScratch[b * 2 + 1] == 0 || resultScratch[e * 2 + 1] == 0) continue;
+
+        uint64_t begin = resultScratch[b * 2] & timestampMask;
+        uint64_t end = resultScratch[e * 2] & timestampMask;
+        if (end < begin) continue;
+
+        float ms = static_cast<float>(static_cast<double>(end - begin) * timestampPeriodNs * 1e-6);
+
+        ScopeHistory& h = history[scope.scopeId];
+        h.samplesMs[h.head] = ms;
+        h.head = (h.head + 1) % HISTORY_SIZE;
+        h.count = std::min(h.count + 1, HISTORY_SIZE);
+        h.lastMs = ms;
+        if (h.capture) {
+            h.capture->push_back(ms);
+        }
+    }
+
+    slot.hasResults = false;
+}
+
+void GpuProfiler::collectAll() {
+    if (!isSupported()) return;
+
+    for (uint32_t i = 0; i < frames.size(); i++) {
+        collectResults(i);
+    }
+}
+
+void GpuProfiler::captureScope(const char* name, std::vector<float>* sink) {
+    history[scopeIdFor(name)].capture = sink;
+}
+
+uint32_t GpuProfiler::scopeIdFor(const char* name) {
+    auto it = scopeIds.find(name);
+    if (it != scopeIds.end()) {
+        return it->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(history.size());
+    scopeIds.emplace(name, id);
+
+    ScopeHistory h;
+    h.name = name;
+    h.samplesMs.resize(HISTORY_SIZE);
+    history.push_back(std::move(h));
+    return id;
+}
+
+std::vector<GpuProfiler::ScopeStats> GpuProfiler::getStats() const {
+    std::vector<ScopeStats> stats;
+    stats.reserve(history.size());
+
+    std::vector<float> sorted;
+    for (const ScopeHistory& h : history) {
+        ScopeStats s;
+        s.name = h.name;
+        s.samples = static_cast<uint32_t>(h.count);
+        s.lastMs = h.lastMs;
+
+        if (h.count > 0) {
+            sorted.assign(h.samplesMs.begin(), h.samplesMs.begin() + h.count);
+            std::sort(sorted.begin(), sorted.end());
+            s.minMs = sorted.front();
+            s.avgMs = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+            s.p99Ms = sorted[std::min(sorted.size() - 1, (sorted.size() * 99) / 100)];
+        }
+        stats.push_back(s);
+    }
+    return stats;
+}
+
+bool GpuProfiler::writeCsv(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        LOG_WARN("⚠️  Could not write GPU profile to " << path);
+        return false;
+    }
+
+    file << "scope,samples,last_ms,min_ms,avg_ms,p99_ms\n";
+    for (const ScopeStats& s : getStats()) {
+        file << s.name << ',' << s.samples << ',' << s.lastMs << ',' << s.minMs << ','
+             << s.avgMs << ',' << s.p99Ms << '\n';
+    }
+
+    LOG_INFO("📊 GPU profile written to " << path);
+    return true;
+}
@@ -0,0 +1,63 @@
+#include "GpuWatchdog.h"
+#include "Logger.h"
+
+GpuWatchdog::GpuWatchdog(VkDevice device, VkSemaphore timeline, uint32_t timeoutMs)
+    : device(device), timeline(timeline), timeout(timeoutMs) {
+    thread = std::thread(&GpuWatchdog::run, this);
+}
+
+GpuWatchdog::~GpuWatchdog() {
+    stopRequested.store(true, std::memory_order_release);
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void GpuWatchdog::frameSubmitted(uint64_t timelineValue) {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pending.push_back({timelineValue, std::chrono::steady_clock::now()});
+}
+
+void GpuWatchdog::run() {
+    uint64_t reportedStall = 0;   // Timeline value we already warned about
+
+    while (!stopRequested.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        uint64_t completed = 0;
+        VkResult result = vkGetSemaphoreCounterValue(device, timeline, &completed);
+        if (result != VK_SUCCESS) {
+            if (result == VK_ERROR_DEVICE_LOST && !lost.exchange(true)) {
+                LOG_ERROR("🚨 DEVICE LOST - Possible GPU hang or driver crash!");
+            }
+            continue;
+        }
+
+        PendingSubmit oldest{};
+        bool hasPending = false;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            while (!pending.empty() && pending.front().value <= completed) {
+                pending.pop_front();
+            }
+            if (!pending.empty()) {
+                oldest = pending.front();
+                hasPending = true;
+            }
+        }
+
+        if (!hasPending || oldest.value == reportedStall) {
+            continue;
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - oldest.submitTime);
+        if (elapsed > timeout) {
+            reportedStall = oldest.value;
+            LOG_WARN("⚠️  GPU frame " << oldest.value << " not finished after " << elapsed.count()
+                     << "ms - Possible GPU hang!");
+            LOG_WARN("   Ray tracing dispatch might be stuck in infinite loop");
+            LOG_WARN("   Check shader recursion limits and termination conditions");
+        }
+    }
+}
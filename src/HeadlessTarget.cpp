@@ -0,0 +1,154 @@
+#include "HeadlessTarget.h"
+#include "VulkanHelpers.h"
+#include "Logger.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+HeadlessTarget::HeadlessTarget(VkDevice device, VkPhysicalDevice physicalDevice, VkExtent2D extent, VkFormat format,
+                               uint32_t imageCount, const std::string& outputDir)
+    : device(device), extent(extent), format(format), outputDir(outputDir) {
+    images.resize(imageCount);
+    imageMemories.resize(imageCount);
+    readbacks.resize(imageCount);
+
+    VkDeviceSize frameBytes = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+
+    for (uint32_t i = 0; i < imageCount; i++) {
+        // Same usages the swapchain images get: resolve target, RTX copy destination, readback source
+        VulkanHelpers::createImage(device, physicalDevice, extent.width, extent.height, 1, VK_SAMPLE_COUNT_1_BIT,
+                                   format, VK_IMAGE_TILING_OPTIMAL,
+                                   VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                                   VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, images[i], imageMemories[i]);
+
+        Readback& readback = readbacks[i];
+        VulkanHelpers::createBuffer(device, physicalDevice, frameBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                    readback.buffer, readback.memory);
+
+        void* data = nullptr;
+        if (vkMapMemory(device, readback.memory, 0, VK_WHOLE_SIZE, 0, &data) != VK_SUCCESS) {
+            throw std::runtime_error("failed to map headless readback buffer!");
+        }
+        readback.mapped = static_cast<const uint8_t*>(data);
+    }
+
+    std::filesystem::create_directories(outputDir);
+
+    LOG_INFO("✅ Headless target created: " << imageCount << " x " << extent.width << "x" << extent.height
+             << " -> " << outputDir);
+}
+
+HeadlessTarget::~HeadlessTarget() {
+    for (Readback& readback : readbacks) {
+        if (readback.mapped) {
+            vkUnmapMemory(device, readback.memory);
+        }
+        vkDestroyBuffer(device, readback.buffer, nullptr);
+        vkFreeMemory(device, readback.memory, nullptr);
+    }
+    for (size_t i = 0; i < images.size(); i++) {
+        vkDestroyImage(device, images[i], nullptr);
+        vkFreeMemory(device, imageMemories[i], nullptr);
+    }
+}
+
+void HeadlessTarget::recordReadback(VkCommandBuffer commandBuffer, uint32_t imageIndex, uint32_t frameNumber) {
+    Readback& readback = readbacks[imageIndex];
+
+    // Make the render pass / RTX copy writes visible to the transfer
+    VkImageMemoryBarrier imageBarrier{};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image = images[imageIndex];
+    imageBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageBarrier.subresourceRange.baseMipLevel = 0;
+    imageBarrier.subresourceRange.levelCount = 1;
+    imageBarrier.subresourceRange.baseArrayLayer = 0;
+    imageBarrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;   // Tightly packed
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {extent.width, extent.height, 1};
+
+    vkCmdCopyImageToBuffer(commandBuffer, images[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           readback.buffer, 1, &region);
+
+    VkBufferMemoryBarrier hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.buffer = readback.buffer;
+    hostBarrier.offset = 0;
+    hostBarrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+
+    readback.pending = true;
+    readback.frameNumber = frameNumber;
+}
+
+void HeadlessTarget::collect(uint32_t imageIndex) {
+    Readback& readback = readbacks[imageIndex];
+    if (!readback.pending) return;
+
+    writePPM(readback);
+    readback.pending = false;
+}
+
+void HeadlessTarget::flush() {
+    for (uint32_t i = 0; i < readbacks.size(); i++) {
+        collect(i);
+    }
+}
+
+void HeadlessTarget::writePPM(const Readback& readback) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%05u.ppm", readback.frameNumber);
+    std::string path = (std::filesystem::path(outputDir) / name).string();
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        LOG_WARN("⚠️  Could not write headless frame " << path);
+        return;
+    }
+
+    // Binary PPM: no image library needed, trivially converted by any tool
+    file << "P6\n" << extent.width << " " << extent.height << "\n255\n";
+
+    bool bgr = (format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB);
+    std::vector<uint8_t> row(extent.width * 3);
+    for (uint32_t y = 0; y < extent.height; y++) {
+        const uint8_t* src = readback.mapped + static_cast<size_t>(y) * extent.width * 4;
+        for (uint32_t x = 0; x < extent.width; x++) {
+            row[x * 3 + 0] = src[x * 4 + (bgr ? 2 : 0)];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + (bgr ? 0 : 2)];
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+
+    LOG_DEBUG("💾 Headless frame written: " << path);
+}
@@ -0,0 +1,154 @@
+#include "HostAccelerationStructureBuilder.h"
+#include "Logger.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+HostAccelerationStructureBuilder::HostAccelerationStructureBuilder(VkDevice device, uint32_t workerCount)
+    : device(device), workerCount(workerCount) {
+    if (this->workerCount == 0) {
+        this->workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    vkBuildAccelerationStructuresKHR = reinterpret_cast<PFN_vkBuildAccelerationStructuresKHR>(
+        vkGetDeviceProcAddr(device, "vkBuildAccelerationStructuresKHR"));
+    vkCreateDeferredOperationKHR = reinterpret_cast<PFN_vkCreateDeferredOperationKHR>(
+        vkGetDeviceProcAddr(device, "vkCreateDeferredOperationKHR"));
+    vkDestroyDeferredOperationKHR = reinterpret_cast<PFN_vkDestroyDeferredOperationKHR>(
+        vkGetDeviceProcAddr(device, "vkDestroyDeferredOperationKHR"));
+    vkGetDeferredOperationMaxConcurrencyKHR = reinterpret_cast<PFN_vkGetDeferredOperationMaxConcurrencyKHR>(
+        vkGetDeviceProcAddr(device, "vkGetDeferredOperationMaxConcurrencyKHR"));
+    vkGetDeferredOperationResultKHR = reinterpret_cast<PFN_vkGetDeferredOperationResultKHR>(
+        vkGetDeviceProcAddr(device, "vkGetDeferredOperationResultKHR"));
+    vkDeferredOperationJoinKHR = reinterpret_cast<PFN_vkDeferredOperationJoinKHR>(
+        vkGetDeviceProcAddr(device, "vkDeferredOperationJoinKHR"));
+
+    if (!vkBuildAccelerationStructuresKHR || !vkCreateDeferredOperationKHR || !vkDestroyDeferredOperationKHR ||
+        !vkGetDeferredOperationMaxConcurrencyKHR || !vkGetDeferredOperationResultKHR || !vkDeferredOperationJoinKHR) {
+        throw std::runtime_error("failed to load host acceleration structure build functions!");
+    }
+}
+
+HostAccelerationStructureBuilder::~HostAccelerationStructureBuilder() {
+    try {
+        wait();
+    } catch (const std::exception& e) {
+        LOG_WARN("⚠️  Host acceleration structure build failed during shutdown: " << e.what());
+    }
+}
+
+bool HostAccelerationStructureBuilder::isSupported(VkPhysicalDevice physicalDevice) {
+    VkPhysicalDeviceAccelerationStructureFeaturesKHR asFeatures{};
+    asFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
+
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &asFeatures;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+    return asFeatures.accelerationStructureHostCommands == VK_TRUE;
+}
+
+void HostAccelerationStructureBuilder::addBuild(const VkAccelerationStructureBuildGeometryInfoKHR& buildInfo,
+                                                const VkAccelerationStructureBuildRangeInfoKHR* ranges,
+                                                VkDeviceSize scratchSize) {
+    PendingBuild build{};
+    build.buildInfo = buildInfo;
+    build.ranges = ranges;
+    build.scratch.resize(static_cast<size_t>(scratchSize) + SCRATCH_ALIGNMENT);
+    pending.push_back(std::move(build));
+}
+
+void HostAccelerationStructureBuilder::submit() {
+    if (pending.empty()) return;
+    wait();   // One batch in flight at a time
+
+    submitStart = std::chrono::high_resolution_clock::now();
+    inFlight = std::move(pending);
+    pending.clear();
+
+    // Start every build deferred; the call returns as soon as the work is handed over
+    uint32_t concurrency = 0;   // Stays 0 when every build completed inline
+    for (PendingBuild& build : inFlight) {
+        uintptr_t scratch = reinterpret_cast<uintptr_t>(build.scratch.data());
+        build.buildInfo.scratchData.hostAddress =
+            reinterpret_cast<void*>((scratch + SCRATCH_ALIGNMENT - 1) & ~uintptr_t(SCRATCH_ALIGNMENT - 1));
+
+        if (vkCreateDeferredOperationKHR(device, nullptr, &build.operation) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create deferred operation for a host acceleration structure build!");
+        }
+
+        build.result = vkBuildAccelerationStructuresKHR(device, build.operation, 1, &build.buildInfo, &build.ranges);
+        if (build.result == VK_OPERATION_DEFERRED_KHR) {
+            concurrency = std::max(concurrency, vkGetDeferredOperationMaxConcurrencyKHR(device, build.operation));
+        } else {
+            // VK_OPERATION_NOT_DEFERRED_KHR: finished inline; anything else is an error
+            vkDestroyDeferredOperationKHR(device, build.operation, nullptr);
+            build.operation = VK_NULL_HANDLE;
+            if (build.result == VK_OPERATION_NOT_DEFERRED_KHR) {
+                build.result = VK_SUCCESS;
+            }
+        }
+    }
+
+    uint32_t threadCount = std::min(workerCount, concurrency);
+    workerFinish.assign(threadCount, submitStart);
+    for (uint32_t worker = 0; worker < threadCount; worker++) {
+        workers.emplace_back(&HostAccelerationStructureBuilder::joinOperations, this, worker);
+    }
+
+    LOG_DEBUG("🧱 Host AS batch started: " << inFlight.size() << " build(s) on " << threadCount << " thread(s)");
+}
+
+void HostAccelerationStructureBuilder::joinOperations(uint32_t worker) {
+    // Every worker joins every operation: the driver spreads each build over whoever joins it,
+    // and THREAD_DONE means this thread has nothing more to contribute to that one
+    for (PendingBuild& build : inFlight) {
+        if (build.operation == VK_NULL_HANDLE) continue;
+
+        while (true) {
+            VkResult result = vkDeferredOperationJoinKHR(device, build.operation);
+            if (result == VK_THREAD_IDLE_KHR) {
+                std::this_thread::yield();
+                continue;
+            }
+            break;   // SUCCESS, THREAD_DONE or an error (read back in wait())
+        }
+    }
+    workerFinish[worker] = std::chrono::high_resolution_clock::now();
+}
+
+void HostAccelerationStructureBuilder::wait() {
+    if (inFlight.empty() && workers.empty()) return;
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    VkResult failure = VK_SUCCESS;
+    for (PendingBuild& build : inFlight) {
+        if (build.operation != VK_NULL_HANDLE) {
+            build.result = vkGetDeferredOperationResultKHR(device, build.operation);
+            vkDestroyDeferredOperationKHR(device, build.operation, nullptr);
+            build.operation = VK_NULL_HANDLE;
+        }
+        if (build.result != VK_SUCCESS && failure == VK_SUCCESS) {
+            failure = build.result;
+        }
+    }
+
+    auto finish = workerFinish.empty() ? std::chrono::high_resolution_clock::now() : submitStart;
+    for (const auto& workerEnd : workerFinish) {
+        finish = std::max(finish, workerEnd);
+    }
+    lastBuildMs = std::chrono::duration<double, std::milli>(finish - submitStart).count();
+    size_t buildCount = inFlight.size();
+    inFlight.clear();
+
+    if (failure != VK_SUCCESS) {
+        throw std::runtime_error("host acceleration structure build failed (VkResult " + std::to_string(failure) + ")!");
+    }
+
+    LOG_DEBUG("🧱 Host AS batch completed: " << buildCount << " build(s) in " << lastBuildMs << " ms");
+}
@@ -0,0 +1,559 @@
+#include "ImageCompare.h"
+#include "Json.h"
+#include "Logger.h"
+#include "WideBvh.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define IMAGE_COMPARE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define IMAGE_COMPARE_TARGET_AVX2
+#else
+// Only the kernels are compiled for AVX2; everything else keeps the baseline target
+#define IMAGE_COMPARE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#else
+#define IMAGE_COMPARE_X86 0
+#endif
+
+using Plane = std::vector<float>;
+
+static const float PI = 3.14159265359f;
+static const float PIXELS_PER_DEGREE = 67.0f;
+
+// D65 reference white
+static const float WHITE_X = 0.950428545f;
+static const float WHITE_Y = 1.0f;
+static const float WHITE_Z = 1.088900371f;
+
+// FLIP's colour compression and feature parameters
+static const float COLOR_EXPONENT = 0.7f;
+static const float COLOR_CUTOFF = 0.4f;
+static const float COLOR_CUTOFF_ERROR = 0.95f;
+static const float FEATURE_EXPONENT = 0.5f;
+static const float FEATURE_WIDTH = 0.082f;   // Degrees
+
+static bool useAvx2() {
+    static const bool supported = WideBvh::isSupported(WideBvh::Isa::Avx2);
+    return supported;
+}
+
+static float srgbToLinear(uint8_t value) {
+    static const std::array<float, 256> table = [] {
+        std::array<float, 256> t{};
+        for (int i = 0; i < 256; i++) {
+            float c = i / 255.0f;
+            t[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return t;
+    }();
+    return table[value];
+}
+
+static void linearToXyz(float r, float g, float b, float& x, float& y, float& z) {
+    x = 0.4124564f * r + 0.3575761f * g + 0.1804375f * b;
+    y = 0.2126729f * r + 0.7151522f * g + 0.0721750f * b;
+    z = 0.0193339f * r + 0.1191920f * g + 0.9503041f * b;
+}
+
+static void xyzToLinear(float x, float y, float z, float& r, float& g, float& b) {
+    r = 3.2404542f * x - 1.5371385f * y - 0.4985314f * z;
+    g = -0.9692660f * x + 1.8760108f * y + 0.0415560f * z;
+    b = 0.0556434f * x - 0.2040259f * y + 1.0572252f * z;
+}
+
+static float labCurve(float t) {
+    const float delta = 6.0f / 29.0f;
+    return t > delta * delta * delta ? std::cbrt(t) : t / (3.0f * delta * delta) + 4.0f / 29.0f;
+}
+
+// L*a*b* of a linear RGB colour with FLIP's Hunt adjustment (chroma fades with lightness)
+static void linearToHuntLab(float r, float g, float b, float& l, float& a, float& bb) {
+    float x, y, z;
+    linearToXyz(r, g, b, x, y, z);
+    float fx = labCurve(x / WHITE_X);
+    float fy = labCurve(y / WHITE_Y);
+    float fz = labCurve(z / WHITE_Z);
+    l = 116.0f * fy - 16.0f;
+    a = 0.01f * l * 500.0f * (fx - fy);
+    bb = 0.01f * l * 200.0f * (fy - fz);
+}
+
+static float hyab(float l1, float a1, float b1, float l2, float a2, float b2) {
+    return std::abs(l1 - l2) + std::sqrt((a1 - a2) * (a1 - a2) + (b1 - b2) * (b1 - b2));
+}
+
+// ---- Separable convolution --------------------------------------------------------------------
+
+static void convolveRowScalar(const float* padded, float* out, uint32_t width, const float* kernel, uint32_t taps) {
+    for (uint32_t x = 0; x < width; x++) {
+        float sum = 0.0f;
+        for (uint32_t k = 0; k < taps; k++) {
+            sum += kernel[k] * padded[x + k];
+        }
+        out[x] = sum;
+    }
+}
+
+static void accumulateRowScalar(const float* row, float weight, float* out, uint32_t width) {
+    for (uint32_t x = 0; x < width; x++) {
+        out[x] += weight * row[x];
+    }
+}
+
+#if IMAGE_COMPARE_X86
+
+IMAGE_COMPARE_TARGET_AVX2
+static void convolveRowAvx2(const float* padded, float* out, uint32_t width, const float* kernel, uint32_t taps) {
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m256 sum = _mm256_setzero_ps();
+        for (uint32_t k = 0; k < taps; k++) {
+            sum = _mm256_fmadd_ps(_mm256_set1_ps(kernel[k]), _mm256_loadu_ps(padded + x + k), sum);
+        }
+        _mm256_storeu_ps(out + x, sum);
+    }
+    convolveRowScalar(padded + x, out + x, width - x, kernel, taps);
+}
+
+IMAGE_COMPARE_TARGET_AVX2
+static void accumulateRowAvx2(const float* row, float weight, float* out, uint32_t width) {
+    __m256 w = _mm256_set1_ps(weight);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        _mm256_storeu_ps(out + x, _mm256_fmadd_ps(w, _mm256_loadu_ps(row + x), _mm256_loadu_ps(out + x)));
+    }
+    accumulateRowScalar(row + x, weight, out + x, width - x);
+}
+
+#endif
+
+// kernelX along the rows, then kernelY down the columns; both odd-sized and centred, edges clamped
+static void convolve(const Plane& source, Plane& result, uint32_t width, uint32_t height,
+                     const std::vector<float>& kernelX, const std::vector<float>& kernelY) {
+    bool avx2 = false;
+    auto convolveRow = convolveRowScalar;
+    auto accumulateRow = accumulateRowScalar;
+#if IMAGE_COMPARE_X86
+    avx2 = useAvx2();
+    if (avx2) {
+        convolveRow = convolveRowAvx2;
+        accumulateRow = accumulateRowAvx2;
+    }
+#endif
+    (void)avx2;
+
+    int radiusX = static_cast<int>(kernelX.size() / 2);
+    int radiusY = static_cast<int>(kernelY.size() / 2);
+
+    Plane rows(static_cast<size_t>(width) * height);
+    std::vector<float> padded(width + 2 * radiusX);
+    for (uint32_t y = 0; y < height; y++) {
+        const float* src = &source[static_cast<size_t>(y) * width];
+        for (int x = -radiusX; x < static_cast<int>(width) + radiusX; x++) {
+            padded[x + radiusX] = src[std::clamp(x, 0, static_cast<int>(width) - 1)];
+        }
+        convolveRow(padded.data(), &rows[static_cast<size_t>(y) * width], width, kernelX.data(),
+                    static_cast<uint32_t>(kernelX.size()));
+    }
+
+    result.assign(static_cast<size_t>(width) * height, 0.0f);
+    for (uint32_t y = 0; y < height; y++) {
+        float* out = &result[static_cast<size_t>(y) * width];
+        for (int k = -radiusY; k <= radiusY; k++) {
+            int sourceY = std::clamp(static_cast<int>(y) + k, 0, static_cast<int>(height) - 1);
+            accumulateRow(&rows[static_cast<size_t>(sourceY) * width], kernelY[k + radiusY], out, width);
+        }
+    }
+}
+
+static std::vector<float> gaussianKernel(float sigma, int radius) {
+    std::vector<float> kernel(2 * radius + 1);
+    float sum = 0.0f;
+    for (int x = -radius; x <= radius; x++) {
+        kernel[x + radius] = std::exp(-static_cast<float>(x * x) / (2.0f * sigma * sigma));
+        sum += kernel[x + radius];
+    }
+    for (float& weight : kernel) {
+        weight /= sum;
+    }
+    return kernel;
+}
+
+// First (edges) or second (points) derivative of a Gaussian; positive and negative weights each
+// sum to 1 in magnitude, as in FLIP
+static std::vector<float> derivativeKernel(float sigma, int radius, bool second) {
+    std::vector<float> kernel(2 * radius + 1);
+    float positive = 0.0f;
+    float negative = 0.0f;
+    for (int x = -radius; x <= radius; x++) {
+        float g = std::exp(-static_cast<float>(x * x) / (2.0f * sigma * sigma));
+        float weight = second ? (x * x / (sigma * sigma) - 1.0f) * g : -x * g;
+        kernel[x + radius] = weight;
+        (weight > 0.0f ? positive : negative) += weight;
+    }
+    for (float& weight : kernel) {
+        weight /= weight > 0.0f ? positive : -negative;
+    }
+    return kernel;
+}
+
+// ---- Squared error ---------------------------------------------------------------------------
+
+static uint64_t squaredErrorScalar(const uint8_t* a, const uint8_t* b, size_t count) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        int difference = static_cast<int>(a[i]) - static_cast<int>(b[i]);
+        total += static_cast<uint64_t>(difference * difference);
+    }
+    return total;
+}
+
+#if IMAGE_COMPARE_X86
+
+IMAGE_COMPARE_TARGET_AVX2
+static uint64_t squaredErrorAvx2(const uint8_t* a, const uint8_t* b, size_t count) {
+    // A 32-bit lane gains at most 4 * 255^2 per step; flushed to 64 bits before it can overflow
+    const size_t STEPS_PER_FLUSH = 4096;
+    size_t vectorEnd = count & ~static_cast<size_t>(31);
+    uint64_t total = 0;
+    size_t i = 0;
+    while (i < vectorEnd) {
+        size_t blockEnd = std::min(vectorEnd, i + 32 * STEPS_PER_FLUSH);
+        __m256i sums = _mm256_setzero_si256();
+        for (; i < blockEnd; i += 32) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            __m256i low = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(va)),
+                                           _mm256_cvtepu8_epi16(_mm256_castsi256_si128(vb)));
+            __m256i high = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(va, 1)),
+                                            _mm256_cvtepu8_epi16(_mm256_extracti128_si256(vb, 1)));
+            sums = _mm256_add_epi32(sums, _mm256_madd_epi16(low, low));
+            sums = _mm256_add_epi32(sums, _mm256_madd_epi16(high, high));
+        }
+        alignas(32) uint32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sums);
+        for (uint32_t lane : lanes) {
+            total += lane;
+        }
+    }
+    return total + squaredErrorScalar(a + vectorEnd, b + vectorEnd, count - vectorEnd);
+}
+
+#endif
+
+static uint64_t squaredError(const uint8_t* a, const uint8_t* b, size_t count) {
+#if IMAGE_COMPARE_X86
+    if (useAvx2()) return squaredErrorAvx2(a, b, count);
+#endif
+    return squaredErrorScalar(a, b, count);
+}
+
+// ---- FLIP-style error ------------------------------------------------------------------------
+
+// What FLIP needs of one image: Hunt-adjusted L*a*b* after the contrast sensitivity blur, and
+// the edge and point strength of its luminance
+struct FlipPlanes {
+    Plane l, a, b;
+    Plane edges, points;
+};
+
+static FlipPlanes flipPlanes(const ImageCompare::Image& image) {
+    uint32_t width = image.width;
+    uint32_t height = image.height;
+    size_t count = static_cast<size_t>(width) * height;
+
+    // YCxCz, linear in XYZ: the space FLIP filters in
+    Plane ycxcz[3];
+    Plane luminance(count);
+    for (Plane& plane : ycxcz) {
+        plane.resize(count);
+    }
+    for (size_t i = 0; i < count; i++) {
+        float x, y, z;
+        linearToXyz(srgbToLinear(image.rgb[i * 3 + 0]), srgbToLinear(image.rgb[i * 3 + 1]),
+                    srgbToLinear(image.rgb[i * 3 + 2]), x, y, z);
+        ycxcz[0][i] = 116.0f * (y / WHITE_Y) - 16.0f;
+        ycxcz[1][i] = 500.0f * (x / WHITE_X - y / WHITE_Y);
+        ycxcz[2][i] = 200.0f * (y / WHITE_Y - z / WHITE_Z);
+        luminance[i] = y / WHITE_Y;
+    }
+
+    // Contrast sensitivity per channel: sums of Gaussians a * sqrt(pi / b) * exp(-pi^2 x^2 / b),
+    // x in degrees (FLIP's achromatic, red-green and blue-yellow parameters)
+    struct CsfTerm {
+        float a, b;
+    };
+    const std::vector<CsfTerm> csf[3] = {{{1.0f, 0.0047f}}, {{1.0f, 0.0053f}}, {{34.1f, 0.04f}, {13.5f, 0.025f}}};
+    int csfRadius = static_cast<int>(std::ceil(3.0f * std::sqrt(0.04f / (2.0f * PI * PI)) * PIXELS_PER_DEGREE));
+
+    Plane filtered[3];
+    Plane term;
+    for (int channel = 0; channel < 3; channel++) {
+        // Each term is separable; their 2D weights are what the terms sum to over the kernel
+        std::vector<std::vector<float>> kernels;
+        std::vector<float> weights;
+        float totalWeight = 0.0f;
+        for (const CsfTerm& t : csf[channel]) {
+            float sigma = std::sqrt(t.b / (2.0f * PI * PI)) * PIXELS_PER_DEGREE;
+            float sum = 0.0f;
+            for (int x = -csfRadius; x <= csfRadius; x++) {
+                sum += std::exp(-static_cast<float>(x * x) / (2.0f * sigma * sigma));
+            }
+            kernels.push_back(gaussianKernel(sigma, csfRadius));
+            weights.push_back(t.a * std::sqrt(PI / t.b) * sum * sum);
+            totalWeight += weights.back();
+        }
+
+        filtered[channel].assign(count, 0.0f);
+        for (size_t k = 0; k < kernels.size(); k++) {
+            convolve(ycxcz[channel], term, width, height, kernels[k], kernels[k]);
+            float weight = weights[k] / totalWeight;
+            for (size_t i = 0; i < count; i++) {
+                filtered[channel][i] += weight * term[i];
+            }
+        }
+    }
+
+    FlipPlanes planes;
+    planes.l.resize(count);
+    planes.a.resize(count);
+    planes.b.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        // Back to linear RGB, clamped to the displayable range, then to L*a*b*
+        float y = (filtered[0][i] + 16.0f) / 116.0f * WHITE_Y;
+        float x = (filtered[1][i] / 500.0f + y / WHITE_Y) * WHITE_X;
+        float z = (y / WHITE_Y - filtered[2][i] / 200.0f) * WHITE_Z;
+        float r, g, b;
+        xyzToLinear(x, y, z, r, g, b);
+        linearToHuntLab(std::clamp(r, 0.0f, 1.0f), std::clamp(g, 0.0f, 1.0f), std::clamp(b, 0.0f, 1.0f),
+                        planes.l[i], planes.a[i], planes.b[i]);
+    }
+
+    // Edges and points of the unfiltered luminance
+    float sigma = 0.5f * FEATURE_WIDTH * PIXELS_PER_DEGREE;
+    int radius = static_cast<int>(std::ceil(3.0f * sigma));
+    std::vector<float> gaussian = gaussianKernel(sigma, radius);
+    std::vector<float> edge = derivativeKernel(sigma, radius, false);
+    std::vector<float> point = derivativeKernel(sigma, radius, true);
+
+    Plane alongX, alongY;
+    convolve(luminance, alongX, width, height, edge, gaussian);
+    convolve(luminance, alongY, width, height, gaussian, edge);
+    planes.edges.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        planes.edges[i] = std::sqrt(alongX[i] * alongX[i] + alongY[i] * alongY[i]);
+    }
+    convolve(luminance, alongX, width, height, point, gaussian);
+    convolve(luminance, alongY, width, height, gaussian, point);
+    planes.points.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        planes.points[i] = std::sqrt(alongX[i] * alongX[i] + alongY[i] * alongY[i]);
+    }
+    return planes;
+}
+
+// Magma-like ramp, black through purple and orange to pale yellow
+static void heatColor(float value, uint8_t* rgb) {
+    static const float stops[5][3] = {
+        {0.0f, 0.0f, 4.0f}, {81.0f, 18.0f, 124.0f}, {183.0f, 55.0f, 121.0f}, {252.0f, 137.0f, 97.0f}, {252.0f, 253.0f, 191.0f}};
+    float position = std::clamp(value, 0.0f, 1.0f) * 4.0f;
+    int stop = std::min(static_cast<int>(position), 3);
+    float t = position - stop;
+    for (int c = 0; c < 3; c++) {
+        rgb[c] = static_cast<uint8_t>(stops[stop][c] + (stops[stop + 1][c] - stops[stop][c]) * t + 0.5f);
+    }
+}
+
+// ---- Public interface ------------------------------------------------------------------------
+
+bool ImageCompare::readPPM(const std::string& path, Image& image) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    // P6 header: magic, width, height, max value, whitespace or # comments in between
+    std::string fields[4];
+    for (std::string& field : fields) {
+        while (file >> std::ws && file.peek() == '#') {
+            std::string comment;
+            std::getline(file, comment);
+        }
+        file >> field;
+    }
+    file.get();   // The single whitespace byte before the pixels
+    if (!file || fields[0] != "P6" || fields[3] != "255") return false;
+
+    image.width = static_cast<uint32_t>(std::strtoul(fields[1].c_str(), nullptr, 10));
+    image.height = static_cast<uint32_t>(std::strtoul(fields[2].c_str(), nullptr, 10));
+    image.rgb.resize(static_cast<size_t>(image.width) * image.height * 3);
+    file.read(reinterpret_cast<char*>(image.rgb.data()), image.rgb.size());
+    return file.gcount() == static_cast<std::streamsize>(image.rgb.size());
+}
+
+bool ImageCompare::writePPM(const std::string& path, const Image& image) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    file << "P6\n" << image.width << " " << image.height << "\n255\n";
+    file.write(reinterpret_cast<const char*>(image.rgb.data()), image.rgb.size());
+    return file.good();
+}
+
+ImageCompare::Metrics ImageCompare::compare(const Image& reference, const Image& test, Image* diff, Image* errorMap) {
+    Metrics metrics;
+    size_t count = static_cast<size_t>(reference.width) * reference.height;
+    if (count == 0) return metrics;
+
+    uint64_t sumSquared = squaredError(reference.rgb.data(), test.rgb.data(), count * 3);
+    double meanSquared = static_cast<double>(sumSquared) / (count * 3);
+    metrics.rmse = std::sqrt(meanSquared);
+    metrics.psnr = sumSquared == 0 ? MAX_PSNR
+                                   : std::min(MAX_PSNR, 10.0 * std::log10(255.0 * 255.0 / meanSquared));
+
+    if (diff) {
+        diff->width = reference.width;
+        diff->height = reference.height;
+        diff->rgb.resize(count * 3);
+        for (size_t i = 0; i < count * 3; i++) {
+            int difference = std::abs(static_cast<int>(test.rgb[i]) - static_cast<int>(reference.rgb[i]));
+            diff->rgb[i] = static_cast<uint8_t>(std::min(difference * 4, 255));
+        }
+    }
+
+    FlipPlanes ref = flipPlanes(reference);
+    FlipPlanes tst = flipPlanes(test);
+
+    // The largest colour error FLIP expects: green against blue
+    float greenL, greenA, greenB, blueL, blueA, blueB;
+    linearToHuntLab(0.0f, 1.0f, 0.0f, greenL, greenA, greenB);
+    linearToHuntLab(0.0f, 0.0f, 1.0f, blueL, blueA, blueB);
+    float maxColorError = std::pow(hyab(greenL, greenA, greenB, blueL, blueA, blueB), COLOR_EXPONENT);
+    float cutoff = COLOR_CUTOFF * maxColorError;
+
+    if (errorMap) {
+        errorMap->width = reference.width;
+        errorMap->height = reference.height;
+        errorMap->rgb.resize(count * 3);
+    }
+
+    double flipSum = 0.0;
+    float flipMax = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        float colorError = std::pow(hyab(ref.l[i], ref.a[i], ref.b[i], tst.l[i], tst.a[i], tst.b[i]), COLOR_EXPONENT);
+        colorError = colorError < cutoff
+            ? COLOR_CUTOFF_ERROR / cutoff * colorError
+            : COLOR_CUTOFF_ERROR + (colorError - cutoff) / (maxColorError - cutoff) * (1.0f - COLOR_CUTOFF_ERROR);
+
+        float featureDifference = std::max(std::abs(ref.edges[i] - tst.edges[i]), std::abs(ref.points[i] - tst.points[i]));
+        float featureError = std::pow(featureDifference / std::sqrt(2.0f), FEATURE_EXPONENT);
+
+        float flip = std::pow(std::min(colorError, 1.0f), 1.0f - std::min(featureError, 1.0f));
+        flipSum += flip;
+        flipMax = std::max(flipMax, flip);
+        if (errorMap) {
+            heatColor(flip, &errorMap->rgb[i * 3]);
+        }
+    }
+    metrics.meanFlip = flipSum / count;
+    metrics.maxFlip = flipMax;
+    return metrics;
+}
+
+bool ImageCompare::compareDirectories(const std::string& referenceDir, const std::string& testDir,
+                                      const std::string& diffDir, const std::string& reportPath,
+                                      const Thresholds& thresholds) {
+    std::vector<std::string> frames;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(testDir, error)) {
+        std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && name.rfind("frame_", 0) == 0 && entry.path().extension() == ".ppm") {
+            frames.push_back(name);
+        }
+    }
+    std::sort(frames.begin(), frames.end());
+    if (frames.empty()) {
+        LOG_ERROR("❌ No frame_*.ppm to compare in " << testDir);
+        return false;
+    }
+
+    std::filesystem::create_directories(diffDir, error);
+    std::ofstream out(reportPath);
+    if (!out.is_open()) {
+        LOG_ERROR("❌ Could not write image comparison report to " << reportPath);
+        return false;
+    }
+
+    out << "{\n";
+    out << "  \"reference\": " << Json::quote(referenceDir) << ",\n";
+    out << "  \"test\": " << Json::quote(testDir) << ",\n";
+    out << "  \"minPsnr\": " << thresholds.minPsnr << ",\n";
+    out << "  \"maxMeanFlip\": " << thresholds.maxMeanFlip << ",\n";
+    out << "  \"isa\": \"" << (useAvx2() ? "avx2" : "scalar") << "\",\n";
+    out << "  \"frames\": [\n";
+
+    bool allPassed = true;
+    for (size_t f = 0; f < frames.size(); f++) {
+        const std::string& name = frames[f];
+        out << "    {\"name\": " << Json::quote(name) << ", ";
+
+        Image reference, test;
+        if (!readPPM((std::filesystem::path(testDir) / name).string(), test)) {
+            LOG_ERROR("❌ " << name << ": unreadable test frame");
+            out << "\"error\": \"unreadable test frame\", \"passed\": false}";
+            allPassed = false;
+        } else if (!readPPM((std::filesystem::path(referenceDir) / name).string(), reference)) {
+            LOG_ERROR("❌ " << name << ": no reference frame in " << referenceDir);
+            out << "\"error\": \"no reference frame\", \"passed\": false}";
+            allPassed = false;
+        } else if (reference.width != test.width || reference.height != test.height) {
+            LOG_ERROR("❌ " << name << ": " << test.width << "x" << test.height << " against a "
+                      << reference.width << "x" << reference.height << " reference");
+            out << "\"error\": \"size mismatch\", \"passed\": false}";
+            allPassed = false;
+        } else {
+            auto start = std::chrono::high_resolution_clock::now();
+            Image diff, errorMap;
+            Metrics metrics = compare(reference, test, &diff, &errorMap);
+            double compareMs = std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - start).count();
+
+            std::string stem = std::filesystem::path(name).stem().string();
+            writePPM((std::filesystem::path(diffDir) / (stem + "_diff.ppm")).string(), diff);
+            writePPM((std::filesystem::path(diffDir) / (stem + "_flip.ppm")).string(), errorMap);
+
+            bool passed = metrics.psnr >= thresholds.minPsnr && metrics.meanFlip <= thresholds.maxMeanFlip;
+            allPassed = allPassed && passed;
+            out << "\"width\": " << test.width << ", \"height\": " << test.height << ", \"rmse\": " << metrics.rmse
+                << ", \"psnr\": " << metrics.psnr << ", \"meanFlip\": " << metrics.meanFlip
+                << ", \"maxFlip\": " << metrics.maxFlip << ", \"compareMs\": " << compareMs
+                << ", \"passed\": " << (passed ? "true" : "false") << "}";
+
+            if (passed) {
+                LOG_INFO("🖼️  " << name << ": PSNR " << metrics.psnr << " dB, mean FLIP " << metrics.meanFlip
+                         << " (" << compareMs << " ms)");
+            } else {
+                LOG_ERROR("❌ " << name << ": PSNR " << metrics.psnr << " dB (min " << thresholds.minPsnr
+                          << "), mean FLIP " << metrics.meanFlip << " (max " << thresholds.maxMeanFlip << ")");
+            }
+        }
+        out << (f + 1 < frames.size() ? ",\n" : "\n");
+    }
+
+    out << "  ],\n";
+    out << "  \"passed\": " << (allPassed ? "true" : "false") << "\n";
+    out << "}\n";
+
+    if (allPassed) {
+        LOG_INFO("✅ " << frames.size() << " frame(s) match the reference; report written to " << reportPath);
+    } else {
+        LOG_ERROR("❌ Image regression against " << referenceDir << "; diffs in " << diffDir
+                  << ", report in " << reportPath);
+    }
+    return allPassed;
+}
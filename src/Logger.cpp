@@ -0,0 +1,187 @@
+#include "Logger.h"
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+std::atomic<int> Logger::runtimeLevel{CLIPPY_LOG_LEVEL};
+
+namespace {
+
+// Bounded MPSC ring (Vyukov-style sequence numbers): producers claim a slot with one CAS,
+// the writer thread is the only consumer.
+constexpr size_t RING_CAPACITY = 1024;   // Must be a power of two
+constexpr size_t RING_MASK = RING_CAPACITY - 1;
+
+struct LogSlot {
+    std::atomic<size_t> sequence{0};
+    LogLevel level = LogLevel::Info;
+    uint16_t length = 0;
+    char text[Logger::MAX_LINE_LENGTH];
+};
+
+struct LogRing {
+    std::array<LogSlot, RING_CAPACITY> slots;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) size_t dequeuePos = 0;
+    std::atomic<uint64_t> dropped{0};
+
+    LogRing() {
+        for (size_t i = 0; i < RING_CAPACITY; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool tryPush(LogLevel level, const char* text, size_t length) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        LogSlot* slot = nullptr;
+        for (;;) {
+            slot = &slots[pos & RING_MASK];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;   // Full
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->level = level;
+        slot->length = static_cast<uint16_t>(length);
+        std::memcpy(slot->text, text, length);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Only called from the writer thread (or from shutdown once it has been joined)
+    template <typename Fn>
+    size_t drain(Fn&& fn) {
+        size_t count = 0;
+        for (;;) {
+            LogSlot& slot = slots[dequeuePos & RING_MASK];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(dequeuePos + 1) < 0) {
+                break;   // Empty
+            }
+            fn(slot.level, slot.text, slot.length);
+            slot.sequence.store(dequeuePos + RING_CAPACITY, std::memory_order_release);
+            dequeuePos++;
+            count++;
+        }
+        return count;
+    }
+};
+
+LogRing ring;
+std::thread writerThread;
+std::atomic<bool> running{false};
+std::atomic<bool> stopRequested{false};
+uint64_t reportedDrops = 0;
+
+void writeLine(LogLevel level, const char* text, size_t length) {
+    FILE* target = level >= LogLevel::Warn ? stderr : stdout;
+    std::fwrite(text, 1, length, target);
+    std::fputc('\n', target);
+}
+
+void drainAndFlush() {
+    size_t written = ring.drain(writeLine);
+
+    uint64_t dropped = ring.dropped.load(std::memory_order_relaxed);
+    if (dropped != reportedDrops) {
+        std::fprintf(stderr, "⚠️  Logger: %llu lines dropped (ring full)\n",
+                     static_cast<unsigned long long>(dropped - reportedDrops));
+        reportedDrops = dropped;
+        written++;
+    }
+
+    if (written > 0) {
+        std::fflush(stdout);
+        std::fflush(stderr);
+    }
+}
+
+void writerLoop() {
+    while (!stopRequested.load(std::memory_order_acquire)) {
+        drainAndFlush();
+        // Producers never signal (that would cost a syscall on the hot path); poll instead
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    drainAndFlush();
+}
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+void Logger::start() {
+    bool expected = false;
+    if (!running.compare_exchange_strong(expected, true)) {
+        return;
+    }
+    stopRequested.store(false, std::memory_order_release);
+    writerThread = std::thread(writerLoop);
+}
+
+void Logger::shutdown() {
+    bool expected = true;
+    if (!running.compare_exchange_strong(expected, false)) {
+        return;
+    }
+    stopRequested.store(true, std::memory_order_release);
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+    drainAndFlush();
+}
+
+void Logger::push(LogLevel level, const char* text, size_t length) {
+    if (length > MAX_LINE_LENGTH) {
+        length = MAX_LINE_LENGTH;
+    }
+
+    // Before start() / after shutdown() there is no writer thread: write synchronously
+    if (!running.load(std::memory_order_acquire)) {
+        writeLine(level, text, length);
+        std::fflush(level >= LogLevel::Warn ? stderr : stdout);
+        return;
+    }
+
+    if (!ring.tryPush(level, text, length)) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+uint64_t Logger::droppedCount() {
+    return ring.dropped.load(std::memory_order_relaxed);
+}
+
+Logger::RateLimiter::RateLimiter(uint32_t intervalMs)
+    : intervalNs(static_cast<int64_t>(intervalMs) * 1000000) {}
+
+bool Logger::RateLimiter::allow(uint32_t& suppressedSinceLast) {
+    int64_t now = nowNs();
+    int64_t next = nextAllowedNs.load(std::memory_order_relaxed);
+    if (now < next || !nextAllowedNs.compare_exchange_strong(next, now + intervalNs,
+                                                             std::memory_order_relaxed)) {
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    suppressedSinceLast = suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+Logger::Line::Line(LogLevel level)
+    : level(level), buffer(text, sizeof(text)), out(&buffer) {}
+
+Logger::Line::~Line() {
+    Logger::push(level, text, buffer.length());
+}
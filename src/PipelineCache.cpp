@@ -0,0 +1,132 @@
+#include "PipelineCache.h"
+#include "Logger.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+PipelineCache::PipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& path)
+    : device(device), path(path) {
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    std::string blob;
+    loaded = loadBlob(blob);
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = loaded ? blob.size() : 0;
+    cacheInfo.pInitialData = loaded ? blob.data() : nullptr;
+
+    VkResult result = vkCreatePipelineCache(device, &cacheInfo, nullptr, &cache);
+    if (result != VK_SUCCESS && loaded) {
+        // The driver may still reject a blob we accepted: start cold rather than fail
+        LOG_WARN("⚠️  Driver rejected pipeline cache " << path << " - starting empty");
+        loaded = false;
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData = nullptr;
+        result = vkCreatePipelineCache(device, &cacheInfo, nullptr, &cache);
+    }
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline cache!");
+    }
+
+    LOG_INFO("✅ Pipeline cache " << (loaded ? "loaded: " + std::to_string(blob.size()) + " bytes from " + path
+                                            : std::string("created empty (cold start)")));
+}
+
+PipelineCache::~PipelineCache() {
+    if (cache != VK_NULL_HANDLE) {
+        vkDestroyPipelineCache(device, cache, nullptr);
+    }
+}
+
+bool PipelineCache::loadBlob(std::string& blob) const {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    FileHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        LOG_WARN("⚠️  Pipeline cache " << path << " is truncated - ignoring it");
+        return false;
+    }
+    if (!matchesDevice(header)) {
+        LOG_INFO("Pipeline cache " << path << " was built for another GPU/driver - ignoring it");
+        return false;
+    }
+
+    blob.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (blob.size() != header.dataSize) {
+        LOG_WARN("⚠️  Pipeline cache " << path << " size mismatch - ignoring it");
+        return false;
+    }
+
+    // The driver blob starts with VkPipelineCacheHeaderVersionOne; check it agrees with our header
+    VkPipelineCacheHeaderVersionOne vkHeader{};
+    if (blob.size() < sizeof(vkHeader)) {
+        return false;
+    }
+    std::memcpy(&vkHeader, blob.data(), sizeof(vkHeader));
+    return vkHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           vkHeader.vendorID == properties.vendorID &&
+           vkHeader.deviceID == properties.deviceID &&
+           std::memcmp(vkHeader.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+bool PipelineCache::matchesDevice(const FileHeader& header) const {
+    return header.magic == FILE_MAGIC &&
+           header.version == FILE_VERSION &&
+           header.vendorID == properties.vendorID &&
+           header.deviceID == properties.deviceID &&
+           header.driverVersion == properties.driverVersion &&
+           std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+bool PipelineCache::save() const {
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(device, cache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+        return false;
+    }
+
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(device, cache, &dataSize, data.data()) != VK_SUCCESS) {
+        LOG_WARN("⚠️  Could not read pipeline cache data");
+        return false;
+    }
+
+    FileHeader header{};
+    header.magic = FILE_MAGIC;
+    header.version = FILE_VERSION;
+    header.vendorID = properties.vendorID;
+    header.deviceID = properties.deviceID;
+    header.driverVersion = properties.driverVersion;
+    std::memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+    header.dataSize = dataSize;
+
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            LOG_WARN("⚠️  Could not write pipeline cache to " << tempPath);
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(data.data(), static_cast<std::streamsize>(dataSize));
+        if (!file) {
+            LOG_WARN("⚠️  Could not write pipeline cache to " << tempPath);
+            return false;
+        }
+    }
+
+    std::remove(path.c_str());   // rename() does not replace an existing file on Windows
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        LOG_WARN("⚠️  Could not move pipeline cache into place at " << path);
+        return false;
+    }
+
+    LOG_INFO("💾 Pipeline cache saved: " << dataSize << " bytes to " << path);
+    return true;
+}
@@ -6,8 +6,10 @@
 #include <cstring>
 #include <iostream>
 
-PostProcessing::PostProcessing(VkDevice device, VkPhysicalDevice physicalDevice, VkRenderPass renderPass, VkExtent2D extent)
-    : device(device), physicalDevice(physicalDevice), renderPass(renderPass), extent(extent) {
+PostProcessing::PostProcessing(VkDevice device, VkPhysicalDevice physicalDevice, VkRenderPass renderPass, VkExtent2D extent,
+                               uint32_t framesInFlight, UniformRing& uniformRing, VkPipelineCache pipelineCache)
+    : device(device), physicalDevice(physicalDevice), renderPass(renderPass), extent(extent),
+      framesInFlight(framesInFlight), pipelineCache(pipelineCache), uniformRing(uniformRing) {
     
     // Initialize default uniforms
     uniforms.time = 0.0f;
@@ -65,18 +67,6 @@ void PostProcessing::cleanup() {
         postProcessImage = VK_NULL_HANDLE;
     }
     
-    // Clean up uniform buffers
-    for (size_t i = 0; i < uniformBuffers.size(); i++) {
-        if (uniformBuffersMapped[i]) {
-            vkUnmapMemory(device, uniformBuffersMemory[i]);
-        }
-        vkDestroyBuffer(device, uniformBuffers[i], nullptr);
-        vkFreeMemory(device, uniformBuffersMemory[i], nullptr);
-    }
-    uniformBuffers.clear();
-    uniformBuffersMemory.clear();
-    uniformBuffersMapped.clear();
-    
     // Clean up samplers
     if (colorSampler != VK_NULL_HANDLE) {
         vkDestroySampler(device, colorSampler, nullptr);
@@ -114,7 +104,7 @@ void PostProcessing::createPostProcessResources() {
     createDescriptorSetLayout();
     createDescriptorPool();
     createDescriptorSets();
-    createUniformBuffers();
+    uniformBlock = uniformRing.allocateBlock(sizeof(PostProcessUniforms));
     createSamplers();
     createBloomResources();
 }
@@ -139,7 +129,7 @@ void PostProcessing::createDescriptorSetLayout() {
     // Uniform buffer binding
     bindings[2].binding = 2;
     bindings[2].descriptorCount = 1;
-    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     bindings[2].pImmutableSamplers = nullptr;
     bindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
     
@@ -156,15 +146,15 @@ void PostProcessing::createDescriptorSetLayout() {
 void PostProcessing::createDescriptorPool() {
     std::array<VkDescriptorPoolSize, 2> poolSizes{};
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[0].descriptorCount = 4; // 2 samplers * 2 frames
-    poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSizes[1].descriptorCount = 2; // 2 frames
+    poolSizes[0].descriptorCount = framesInFlight * 2; // 2 samplers per frame
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    poolSizes[1].descriptorCount = framesInFlight;
     
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
     poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = 2; // 2 frames
+    poolInfo.maxSets = framesInFlight;
     
     if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
         throw std::runtime_error("failed to create post-process descriptor pool!");
@@ -172,36 +162,19 @@ void PostProcessing::createDescriptorPool() {
 }
 
 void PostProcessing::createDescriptorSets() {
-    std::vector<VkDescriptorSetLayout> layouts(2, descriptorSetLayout);
+    std::vector<VkDescriptorSetLayout> layouts(framesInFlight, descriptorSetLayout);
     VkDescriptorSetAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = descriptorPool;
     allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
     allocInfo.pSetLayouts = layouts.data();
     
-    descriptorSets.resize(2);
+    descriptorSets.resize(framesInFlight);
     if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate post-process descriptor sets!");
     }
 }
 
-void PostProcessing::createUniformBuffers() {
-    VkDeviceSize bufferSize = sizeof(PostProcessUniforms);
-    
-    uniformBuffers.resize(2);
-    uniformBuffersMemory.resize(2);
-    uniformBuffersMapped.resize(2);
-    
-    for (size_t i = 0; i < 2; i++) {
-        VulkanHelpers::createBuffer(device, physicalDevice, bufferSize,
-                                    VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                                    uniformBuffers[i], uniformBuffersMemory[i]);
-        
-        vkMapMemory(device, uniformBuffersMemory[i], 0, bufferSize, 0, &uniformBuffersMapped[i]);
-    }
-}
-
 void PostProcessing::createSamplers() {
     // Color sampler
     VkSamplerCreateInfo samplerInfo{};
@@ -399,7 +372,7 @@ void PostProcessing::createPostProcessPipeline() {
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
     
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &postProcessPipeline) != VK_SUCCESS) {
+    if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &postProcessPipeline) != VK_SUCCESS) {
         throw std::runtime_error("failed to create post-process graphics pipeline!");
     }
     
@@ -411,8 +384,9 @@ void PostProcessing::render(VkCommandBuffer commandBuffer, VkImageView sourceIma
     updateDescriptorSet(currentFrame, sourceImage);
     
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, postProcessPipeline);
+    uint32_t uniformOffset = uniformRing.dynamicOffset(uniformBlock, currentFrame);
     vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, 
-                           &descriptorSets[currentFrame], 0, nullptr);
+                           &descriptorSets[currentFrame], 1, &uniformOffset);
     
     // Draw full screen quad (no vertex data needed, generated in vertex shader)
     vkCmdDraw(commandBuffer, 3, 1, 0, 0);
@@ -422,7 +396,7 @@ void PostProcessing::updateUniforms(uint32_t currentFrame, float time) {
     uniforms.time = time;
     uniforms.resolution = glm::vec2(extent.width, extent.height);
     
-    memcpy(uniformBuffersMapped[currentFrame], &uniforms, sizeof(uniforms));
+    uniformRing.write(uniformBlock, currentFrame, &uniforms, sizeof(uniforms));
 }
 
 void PostProcessing::updateDescriptorSet(uint32_t currentFrame, VkImageView sourceImageView) {
@@ -458,7 +432,7 @@ void PostProcessing::updateDescriptorSet(uint32_t currentFrame, VkImageView sour
     
     // Uniform buffer
     VkDescriptorBufferInfo bufferInfo{};
-    bufferInfo.buffer = uniformBuffers[currentFrame];
+    bufferInfo.buffer = uniformRing.getBuffer();
     bufferInfo.offset = 0;
     bufferInfo.range = sizeof(PostProcessUniforms);
     
@@ -466,7 +440,7 @@ void PostProcessing::updateDescriptorSet(uint32_t currentFrame, VkImageView sour
     descriptorWrites[2].dstSet = descriptorSets[currentFrame];
     descriptorWrites[2].dstBinding = 2;
     descriptorWrites[2].dstArrayElement = 0;
-    descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     descriptorWrites[2].descriptorCount = 1;
     descriptorWrites[2].pBufferInfo = &bufferInfo;
     
@@ -0,0 +1,396 @@
+#include "RayPacketTracer.h"
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <limits>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+static uint32_t lowestRay(uint64_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long ray;
+    _BitScanForward64(&ray, mask);
+    return static_cast<uint32_t>(ray);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(mask));
+#endif
+}
+
+static uint32_t countRays(uint64_t mask) {
+    return static_cast<uint32_t>(std::bitset<64>(mask).count());
+}
+
+static uint64_t groupMask(uint32_t group) {
+    return group == 0 ? ~0ull : 0xFFFFull << ((group - 1) * RayPacketTracer::QUAD_SIZE);
+}
+
+// Bounds of the interval product [a0, a1] * [b0, b1]
+static void intervalProduct(float a0, float a1, float b0, float b1, float& low, float& high) {
+    float p0 = a0 * b0, p1 = a0 * b1, p2 = a1 * b0, p3 = a1 * b1;
+    low = std::min(std::min(p0, p1), std::min(p2, p3));
+    high = std::max(std::max(p0, p1), std::max(p2, p3));
+}
+
+// Min/max of values[0, count) with 8 independent running bounds, which the compiler keeps in one
+// vector register each; a single running min/max is a serial dependency chain
+static void valueBounds(const float* values, uint32_t count, float& low, float& high) {
+    float lows[8], highs[8];
+    for (int lane = 0; lane < 8; lane++) {
+        lows[lane] = highs[lane] = values[0];
+    }
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        for (int lane = 0; lane < 8; lane++) {
+            lows[lane] = std::min(lows[lane], values[i + lane]);
+            highs[lane] = std::max(highs[lane], values[i + lane]);
+        }
+    }
+    for (; i < count; i++) {
+        lows[0] = std::min(lows[0], values[i]);
+        highs[0] = std::max(highs[0], values[i]);
+    }
+
+    low = lows[0];
+    high = highs[0];
+    for (int lane = 1; lane < 8; lane++) {
+        low = std::min(low, lows[lane]);
+        high = std::max(high, highs[lane]);
+    }
+}
+
+void RayPacketTracer::Packet::setRay(uint32_t index, const Bvh::Ray& ray) {
+    originX[index] = ray.origin.x;
+    originY[index] = ray.origin.y;
+    originZ[index] = ray.origin.z;
+    directionX[index] = ray.direction.x;
+    directionY[index] = ray.direction.y;
+    directionZ[index] = ray.direction.z;
+    tMax[index] = ray.tMax;
+    activeMask |= 1ull << index;
+}
+
+void RayPacketTracer::intersect(const Packet& packet, Bvh::Hit hits[PACKET_SIZE], Stats* stats) const {
+    Query query;
+    query.hits = hits;
+    query.stats = stats;
+    prepare(query, packet);
+    traverse(query);
+}
+
+uint64_t RayPacketTracer::occluded(const Packet& packet, Stats* stats) const {
+    Query query;
+    query.hits = nullptr;
+    query.stats = stats;
+    prepare(query, packet);
+    traverse(query);
+    return query.occludedMask;
+}
+
+bool RayPacketTracer::occluded(const Bvh::Ray& ray) const {
+    Packet packet;
+    packet.setRay(0, ray);
+
+    Query query;
+    query.hits = nullptr;
+    query.stats = nullptr;
+    query.packet = &packet;
+    query.occludedMask = 0;
+    query.inversesReady = true;
+    query.inverseX[0] = 1.0f / ray.direction.x;
+    query.inverseY[0] = 1.0f / ray.direction.y;
+    query.inverseZ[0] = 1.0f / ray.direction.z;
+    query.closest[0] = ray.tMax;
+    if (!bvh.getTriangles().empty()) {
+        traceRay(query, 0, 0);
+    }
+    return query.occludedMask != 0;
+}
+
+void RayPacketTracer::prepare(Query& query, const Packet& packet) const {
+    query.packet = &packet;
+    query.occludedMask = 0;
+    query.inversesReady = false;
+    query.quadFrustaReady = false;
+
+    for (uint32_t i = 0; i < PACKET_SIZE; i++) {
+        query.closest[i] = query.hits ? std::min(packet.tMax[i], query.hits[i].t) : packet.tMax[i];
+    }
+    buildFrustum(query, 0);
+}
+
+// Frustum from the bounds of the group's active rays. It needs one direction sign per axis; 1 /
+// direction is then monotonic and the inverse bounds are those of the directions, so nothing here
+// divides per ray: a packet the frustum culls at the root never has to.
+void RayPacketTracer::buildFrustum(Query& query, uint32_t group) const {
+    const Packet& packet = *query.packet;
+    uint32_t first = group == 0 ? 0 : (group - 1) * QUAD_SIZE;
+    uint32_t count = group == 0 ? PACKET_SIZE : QUAD_SIZE;
+    uint64_t mask = packet.activeMask & groupMask(group);
+
+    Frustum& frustum = query.frusta[group];
+    frustum.valid = mask != 0;
+    if (!frustum.valid) return;
+
+    // Partial groups (image edges, shadow rays of the pixels that hit) are compacted first, so
+    // the bounds loops below run over contiguous active rays only
+    const float* components[7] = {packet.originX + first, packet.originY + first, packet.originZ + first,
+                                  packet.directionX + first, packet.directionY + first, packet.directionZ + first,
+                                  query.closest + first};
+    float compacted[7][PACKET_SIZE];
+    if (mask != groupMask(group)) {
+        count = 0;
+        for (uint64_t rays = mask; rays; rays &= rays - 1) {
+            uint32_t ray = lowestRay(rays) - first;
+            for (int c = 0; c < 7; c++) {
+                compacted[c][count] = components[c][ray];
+            }
+            count++;
+        }
+        for (int c = 0; c < 7; c++) {
+            components[c] = compacted[c];
+        }
+    }
+
+    for (int axis = 0; axis < 3; axis++) {
+        float directionMin, directionMax;
+        valueBounds(components[axis], count, frustum.originMin[axis], frustum.originMax[axis]);
+        valueBounds(components[3 + axis], count, directionMin, directionMax);
+        frustum.positive[axis] = directionMin > 0.0f;
+        frustum.valid = frustum.valid && (directionMin > 0.0f || directionMax < 0.0f);
+        frustum.inverseMin[axis] = 1.0f / directionMax;
+        frustum.inverseMax[axis] = 1.0f / directionMin;
+    }
+    float tMin;
+    valueBounds(components[6], count, tMin, frustum.tMax);
+}
+
+void RayPacketTracer::prepareInverses(Query& query) const {
+    const Packet& packet = *query.packet;
+    for (uint32_t i = 0; i < PACKET_SIZE; i++) {
+        query.inverseX[i] = 1.0f / packet.directionX[i];   // IEEE inf for axis-parallel rays
+        query.inverseY[i] = 1.0f / packet.directionY[i];
+        query.inverseZ[i] = 1.0f / packet.directionZ[i];
+    }
+    query.inversesReady = true;
+}
+
+// Conservative: true only if no ray of the frustum can enter the box
+static bool frustumMisses(const float* originMin, const float* originMax, const float* inverseMin,
+                          const float* inverseMax, const bool* positive, float tMax, const Bvh::Node& node) {
+    const float boundsMin[3] = {node.boundsMin.x, node.boundsMin.y, node.boundsMin.z};
+    const float boundsMax[3] = {node.boundsMax.x, node.boundsMax.y, node.boundsMax.z};
+
+    float entry = 0.0f;
+    float exit = tMax;
+    for (int axis = 0; axis < 3; axis++) {
+        float nearPlane = positive[axis] ? boundsMin[axis] : boundsMax[axis];
+        float farPlane = positive[axis] ? boundsMax[axis] : boundsMin[axis];
+        float low, high;
+        intervalProduct(nearPlane - originMax[axis], nearPlane - originMin[axis],
+                        inverseMin[axis], inverseMax[axis], low, high);
+        entry = std::max(entry, low);
+        intervalProduct(farPlane - originMax[axis], farPlane - originMin[axis],
+                        inverseMin[axis], inverseMax[axis], low, high);
+        exit = std::min(exit, high);
+    }
+    return entry > exit;
+}
+
+uint64_t RayPacketTracer::intersectBoundsMask(const Query& query, const Bvh::Node& node, uint32_t group,
+                                              uint64_t mask) const {
+    const Packet& packet = *query.packet;
+    uint32_t first = group == 0 ? 0 : (group - 1) * QUAD_SIZE;
+    uint32_t count = group == 0 ? PACKET_SIZE : QUAD_SIZE;
+
+    // Branch-free over the whole (sub-)packet so it vectorizes; inactive rays are masked after
+    uint64_t hitMask = 0;
+    for (uint32_t i = first; i < first + count; i++) {
+        float tx0 = (node.boundsMin.x - packet.originX[i]) * query.inverseX[i];
+        float tx1 = (node.boundsMax.x - packet.originX[i]) * query.inverseX[i];
+        float ty0 = (node.boundsMin.y - packet.originY[i]) * query.inverseY[i];
+        float ty1 = (node.boundsMax.y - packet.originY[i]) * query.inverseY[i];
+        float tz0 = (node.boundsMin.z - packet.originZ[i]) * query.inverseZ[i];
+        float tz1 = (node.boundsMax.z - packet.originZ[i]) * query.inverseZ[i];
+        float entry = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+        float exit = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), query.closest[i]));
+        hitMask |= static_cast<uint64_t>(entry <= exit) << i;
+    }
+    return hitMask & mask;
+}
+
+void RayPacketTracer::traverse(Query& query) const {
+    const auto& nodes = bvh.getNodes();
+    if (bvh.getTriangles().empty() || query.packet->activeMask == 0) return;
+
+    struct Entry {
+        uint32_t node;
+        uint32_t group;   // 0 = whole packet, 1-4 = sub-packet
+        uint64_t mask;
+        bool tested;      // mask already holds the rays that hit this node
+    };
+    Entry stack[STACK_SIZE];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = {0, 0, query.packet->activeMask, false};
+
+    while (stackSize > 0) {
+        Entry entry = stack[--stackSize];
+        const Bvh::Node& node = nodes[entry.node];
+        uint64_t mask = entry.mask & ~query.occludedMask;
+        if (mask == 0) continue;
+
+        if (!entry.tested) {
+            if (query.stats) query.stats->nodeVisits++;
+            const Frustum& frustum = query.frusta[entry.group];
+            if (frustum.valid && frustumMisses(frustum.originMin, frustum.originMax, frustum.inverseMin,
+                                               frustum.inverseMax, frustum.positive, frustum.tMax, node)) {
+                if (query.stats) query.stats->frustumCulls++;
+                continue;
+            }
+            if (!query.inversesReady) prepareInverses(query);
+            mask = intersectBoundsMask(query, node, entry.group, mask);
+            if (mask == 0) continue;
+        }
+
+        // Diverged: fewer than half of the (sub-)packet's rays still hit this node
+        uint32_t groupRays = countRays(query.packet->activeMask & groupMask(entry.group));
+        if (countRays(mask) * 2 < groupRays) {
+            if (entry.group == 0) {
+                if (query.stats) query.stats->splits++;
+                if (!query.quadFrustaReady) {
+                    for (uint32_t group = 1; group <= 4; group++) {
+                        buildFrustum(query, group);
+                    }
+                    query.quadFrustaReady = true;
+                }
+                for (uint32_t group = 4; group >= 1; group--) {
+                    uint64_t quadMask = mask & groupMask(group);
+                    if (quadMask) stack[stackSize++] = {entry.node, group, quadMask, true};
+                }
+            } else {
+                for (uint64_t rays = mask; rays; rays &= rays - 1) {
+                    if (query.stats) query.stats->singleRays++;
+                    traceRay(query, entry.node, lowestRay(rays));
+                }
+            }
+            continue;
+        }
+
+        if (node.isLeaf()) {
+            intersectLeaf(query, node, mask);
+            continue;
+        }
+
+        // Nearer child (along the first active ray) is pushed last so it is visited first
+        uint32_t ray = lowestRay(mask);
+        glm::vec3 direction(query.packet->directionX[ray], query.packet->directionY[ray], query.packet->directionZ[ray]);
+        const Bvh::Node& left = nodes[node.leftOrFirst];
+        const Bvh::Node& right = nodes[node.leftOrFirst + 1];
+        glm::vec3 toRight = (right.boundsMin + right.boundsMax) - (left.boundsMin + left.boundsMax);
+        uint32_t nearChild = node.leftOrFirst;
+        uint32_t farChild = node.leftOrFirst + 1;
+        if (glm::dot(toRight, direction) < 0.0f) {
+            std::swap(nearChild, farChild);
+        }
+        stack[stackSize++] = {farChild, entry.group, mask, false};
+        stack[stackSize++] = {nearChild, entry.group, mask, false};
+    }
+}
+
+// Möller-Trumbore with the triangle set up once for all rays in mask
+void RayPacketTracer::intersectLeaf(Query& query, const Bvh::Node& node, uint64_t mask) const {
+    const Packet& packet = *query.packet;
+    const auto& order = bvh.getTriangleOrder();
+    const auto& triangles = bvh.getTriangles();
+
+    for (uint32_t i = 0; i < node.count && mask; i++) {
+        uint32_t triangle = order[node.leftOrFirst + i];
+        const Bvh::Triangle& tri = triangles[triangle];
+        glm::vec3 edge1 = tri.v1 - tri.v0;
+        glm::vec3 edge2 = tri.v2 - tri.v0;
+
+        for (uint64_t rays = mask; rays; rays &= rays - 1) {
+            uint32_t ray = lowestRay(rays);
+            glm::vec3 direction(packet.directionX[ray], packet.directionY[ray], packet.directionZ[ray]);
+            glm::vec3 p = glm::cross(direction, edge2);
+            float determinant = glm::dot(edge1, p);
+            if (std::abs(determinant) < 1e-12f) continue;
+
+            float inverseDeterminant = 1.0f / determinant;
+            glm::vec3 s = glm::vec3(packet.originX[ray], packet.originY[ray], packet.originZ[ray]) - tri.v0;
+            float u = glm::dot(s, p) * inverseDeterminant;
+            if (u < 0.0f || u > 1.0f) continue;
+
+            glm::vec3 q = glm::cross(s, edge1);
+            float v = glm::dot(direction, q) * inverseDeterminant;
+            if (v < 0.0f || u + v > 1.0f) continue;
+
+            float t = glm::dot(edge2, q) * inverseDeterminant;
+            if (!(t > 0.0f && t < query.closest[ray])) continue;
+
+            if (!query.hits) {
+                // Any-hit: this ray is done
+                query.occludedMask |= 1ull << ray;
+                mask &= ~(1ull << ray);
+                continue;
+            }
+            query.closest[ray] = t;
+            query.hits[ray].t = t;
+            query.hits[ray].u = u;
+            query.hits[ray].v = v;
+            query.hits[ray].triangle = triangle;
+        }
+    }
+}
+
+// Bvh::intersect for one ray of the query, from startNode down
+void RayPacketTracer::traceRay(Query& query, uint32_t startNode, uint32_t ray) const {
+    const auto& nodes = bvh.getNodes();
+    const Packet& packet = *query.packet;
+    glm::vec3 origin(packet.originX[ray], packet.originY[ray], packet.originZ[ray]);
+    glm::vec3 inverseDirection(query.inverseX[ray], query.inverseY[ray], query.inverseZ[ray]);
+    uint64_t rayMask = 1ull << ray;
+
+    auto entryDistance = [&](const Bvh::Node& node) {
+        glm::vec3 t0 = (node.boundsMin - origin) * inverseDirection;
+        glm::vec3 t1 = (node.boundsMax - origin) * inverseDirection;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+        float entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, query.closest[ray]));
+        return entry <= exit ? entry : std::numeric_limits<float>::infinity();
+    };
+
+    uint32_t stack[Bvh::MAX_DEPTH];   // One far child per level below startNode
+    uint32_t stackSize = 0;
+    uint32_t nodeIndex = startNode;
+    if (entryDistance(nodes[nodeIndex]) == std::numeric_limits<float>::infinity()) return;
+
+    while (true) {
+        const Bvh::Node& node = nodes[nodeIndex];
+        if (node.isLeaf()) {
+            intersectLeaf(query, node, rayMask);
+            if (query.occludedMask & rayMask) return;
+        } else {
+            uint32_t nearChild = node.leftOrFirst;
+            uint32_t farChild = node.leftOrFirst + 1;
+            float nearT = entryDistance(nodes[nearChild]);
+            float farT = entryDistance(nodes[farChild]);
+            if (farT < nearT) {
+                std::swap(nearChild, farChild);
+                std::swap(nearT, farT);
+            }
+            if (nearT != std::numeric_limits<float>::infinity()) {
+                if (farT != std::numeric_limits<float>::infinity()) {
+                    stack[stackSize++] = farChild;
+                }
+                nodeIndex = nearChild;
+                continue;
+            }
+        }
+
+        if (stackSize == 0) break;
+        nodeIndex = stack[--stackSize];
+    }
+}
@@ -0,0 +1,104 @@
+#include "RayQueue.h"
+#include <algorithm>
+
+// The low 10 bits of value moved to every third bit
+static uint32_t spreadBits(uint32_t value) {
+    value &= 0x3FFu;
+    value = (value | (value << 16)) & 0x030000FFu;
+    value = (value | (value << 8)) & 0x0300F00Fu;
+    value = (value | (value << 4)) & 0x030C30C3u;
+    value = (value | (value << 2)) & 0x09249249u;
+    return value;
+}
+
+glm::vec3 RayQueue::cellScale(const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    const float cells = static_cast<float>((1u << (MORTON_BITS / 3)) - 1);
+    return cells / glm::max(boundsMax - boundsMin, glm::vec3(1e-6f));
+}
+
+uint32_t RayQueue::sortKey(const Bvh::Ray& ray, const glm::vec3& boundsMin, const glm::vec3& scale) {
+    const float cells = static_cast<float>((1u << (MORTON_BITS / 3)) - 1);
+    uint32_t cell[3];
+    for (int axis = 0; axis < 3; axis++) {
+        float position = (ray.origin[axis] - boundsMin[axis]) * scale[axis];
+        cell[axis] = static_cast<uint32_t>(std::min(std::max(position, 0.0f), cells));
+    }
+    uint32_t morton = (spreadBits(cell[0]) << 2) | (spreadBits(cell[1]) << 1) | spreadBits(cell[2]);
+
+    uint32_t octant = (ray.direction.x < 0.0f ? 4u : 0u) | (ray.direction.y < 0.0f ? 2u : 0u) |
+                      (ray.direction.z < 0.0f ? 1u : 0u);
+    return (octant << MORTON_BITS) | morton;
+}
+
+void RayQueue::sort(WorkStealingPool& pool, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    uint32_t count = size();
+    if (count < 2) return;
+
+    uint32_t chunks = chunkCount(count);
+    auto chunkRange = [count](uint32_t chunk, uint32_t& begin, uint32_t& end) {
+        begin = chunk * CHUNK_SIZE;
+        end = std::min(begin + CHUNK_SIZE, count);
+    };
+
+    items.resize(count);
+    sortedItems.resize(count);
+    histograms.resize(static_cast<size_t>(chunks) * RADIX);
+
+    glm::vec3 scale = cellScale(boundsMin, boundsMax);
+    pool.run(chunks, [&](uint32_t chunk, uint32_t) {
+        uint32_t begin, end;
+        chunkRange(chunk, begin, end);
+        for (uint32_t i = begin; i < end; i++) {
+            items[i] = SortItem{sortKey(entries[i].ray, boundsMin, scale), i};
+        }
+    });
+
+    for (uint32_t shift = 0; shift < KEY_BITS; shift += 8) {
+        pool.run(chunks, [&](uint32_t chunk, uint32_t) {
+            uint32_t* histogram = &histograms[static_cast<size_t>(chunk) * RADIX];
+            std::fill(histogram, histogram + RADIX, 0u);
+            uint32_t begin, end;
+            chunkRange(chunk, begin, end);
+            for (uint32_t i = begin; i < end; i++) {
+                histogram[(items[i].key >> shift) & (RADIX - 1)]++;
+            }
+        });
+
+        // Digit-major, chunk-minor offsets keep every pass stable. A digit every key shares
+        // would only copy the items over, so that pass is skipped.
+        bool allSame = false;
+        uint32_t offset = 0;
+        for (uint32_t digit = 0; digit < RADIX && !allSame; digit++) {
+            uint32_t digitCount = 0;
+            for (uint32_t chunk = 0; chunk < chunks; chunk++) {
+                uint32_t& bucket = histograms[static_cast<size_t>(chunk) * RADIX + digit];
+                uint32_t bucketCount = bucket;
+                bucket = offset;
+                offset += bucketCount;
+                digitCount += bucketCount;
+            }
+            allSame = digitCount == count;
+        }
+        if (allSame) continue;
+
+        pool.run(chunks, [&](uint32_t chunk, uint32_t) {
+            uint32_t* offsets = &histograms[static_cast<size_t>(chunk) * RADIX];
+            uint32_t begin, end;
+            chunkRange(chunk, begin, end);
+            for (uint32_t i = begin; i < end; i++) {
+                sortedItems[offsets[(items[i].key >> shift) & (RADIX - 1)]++] = items[i];
+            }
+        });
+        items.swap(sortedItems);
+    }
+
+    sortedEntries.resize(count);
+    pool.run(chunks, [&](uint32_t chunk, uint32_t) {
+        uint32_t begin, end;
+        chunkRange(chunk, begin, end);
+        for (uint32_t i = begin; i < end; i++) {
+            sortedEntries[i] = entries[items[i].index];
+        }
+    });
+    entries.swap(sortedEntries);
+}
@@ -1,41 +1,47 @@
 #include "RayTracingPipeline.h"
 #include "VulkanHelpers.h" 
 #include "Vertex.h"
+#include "Logger.h"
 #include <stdexcept>
-#include <iostream>
 #include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <cmath>
+#include <thread>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 
 RayTracingPipeline::RayTracingPipeline(VkDevice device, VkPhysicalDevice physicalDevice, 
                                        VkCommandPool commandPool, VkQueue graphicsQueue)
     : device(device), physicalDevice(physicalDevice), commandPool(commandPool), graphicsQueue(graphicsQueue), 
       pipeline(VK_NULL_HANDLE), pipelineLayout(VK_NULL_HANDLE),
-      bottomLevelAS(VK_NULL_HANDLE), topLevelAS(VK_NULL_HANDLE),
-      bottomLevelASBuffer(VK_NULL_HANDLE), bottomLevelASMemory(VK_NULL_HANDLE),
+      topLevelAS(VK_NULL_HANDLE),
       topLevelASBuffer(VK_NULL_HANDLE), topLevelASMemory(VK_NULL_HANDLE),
       shaderBindingTableBuffer(VK_NULL_HANDLE), shaderBindingTableMemory(VK_NULL_HANDLE) {
     loadRayTracingFunctions();
+    asBuilder = std::make_unique<AccelerationStructureBuilder>(device, physicalDevice, commandPool, graphicsQueue);
 }
 
 RayTracingPipeline::~RayTracingPipeline() {
     if (device != VK_NULL_HANDLE) {
+        hostBuilder.reset(); // Joins the host build workers
+        asBuilder.reset();   // Waits for any build still in flight, frees the scratch arena
+        
         if (pipeline != VK_NULL_HANDLE) {
             vkDestroyPipeline(device, pipeline, nullptr);
         }
         if (pipelineLayout != VK_NULL_HANDLE) {
             vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
         }
-        if (bottomLevelAS != VK_NULL_HANDLE) {
-            vkDestroyAccelerationStructureKHR(device, bottomLevelAS, nullptr);
+        for (const BottomLevel& blas : bottomLevels) {
+            vkDestroyAccelerationStructureKHR(device, blas.handle, nullptr);
+            vkDestroyBuffer(device, blas.buffer, nullptr);
+            vkFreeMemory(device, blas.memory, nullptr);
         }
         if (topLevelAS != VK_NULL_HANDLE) {
             vkDestroyAccelerationStructureKHR(device, topLevelAS, nullptr);
         }
-        if (bottomLevelASBuffer != VK_NULL_HANDLE) {
-            vkDestroyBuffer(device, bottomLevelASBuffer, nullptr);
-        }
-        if (bottomLevelASMemory != VK_NULL_HANDLE) {
-            vkFreeMemory(device, bottomLevelASMemory, nullptr);
-        }
         if (topLevelASBuffer != VK_NULL_HANDLE) {
             vkDestroyBuffer(device, topLevelASBuffer, nullptr);
         }
@@ -48,6 +54,18 @@ RayTracingPipeline::~RayTracingPipeline() {
         if (shaderBindingTableMemory != VK_NULL_HANDLE) {
             vkFreeMemory(device, shaderBindingTableMemory, nullptr);
         }
+        
+        // Instance buffer kept alive (and mapped) for the per-frame TLAS updates
+        if (instanceBuffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, instanceBuffer, nullptr);
+        }
+        if (instanceBufferMemory != VK_NULL_HANDLE) {
+            vkFreeMemory(device, instanceBufferMemory, nullptr);
+        }
+        if (instanceShadingBuffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, instanceShadingBuffer, nullptr);
+            vkFreeMemory(device, instanceShadingMemory, nullptr);
+        }
     }
 }
 
@@ -106,13 +124,20 @@ VkDeviceAddress RayTracingPipeline::getAccelerationStructureDeviceAddress(VkAcce
     return vkGetAccelerationStructureDeviceAddressKHR(device, &addressInfo);
 }
 
-void RayTracingPipeline::createPipeline(VkDescriptorSetLayout descriptorSetLayout) {
+void RayTracingPipeline::createPipeline(VkDescriptorSetLayout descriptorSetLayout, VkPipelineCache pipelineCache) {
     // Create pipeline layout
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipelineLayoutInfo.setLayoutCount = 1;
     pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
     
+    VkPushConstantRange tileRange{};
+    tileRange.stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+    tileRange.offset = 0;
+    tileRange.size = sizeof(RaygenPushConstants);
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &tileRange;
+    
     if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create ray tracing pipeline layout!");
     }
@@ -216,7 +241,7 @@ void RayTracingPipeline::createPipeline(VkDescriptorSetLayout descriptorSetLayou
     rtPipelineInfo.maxPipelineRayRecursionDepth = 2;
     rtPipelineInfo.layout = pipelineLayout;
     
-    if (vkCreateRayTracingPipelinesKHR(device, VK_NULL_HANDLE, VK_NULL_HANDLE, 1, 
+    if (vkCreateRayTracingPipelinesKHR(device, VK_NULL_HANDLE, pipelineCache, 1, 
                                        &rtPipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
         throw std::runtime_error("failed to create ray tracing pipeline!");
     }
@@ -227,143 +252,239 @@ void RayTracingPipeline::createPipeline(VkDescriptorSetLayout descriptorSetLayou
     vkDestroyShaderModule(device, closestHitShaderModule, nullptr);
     vkDestroyShaderModule(device, shadowMissShaderModule, nullptr);
     
-    std::cout << "Ray Tracing Pipeline created successfully" << std::endl;
+    LOG_INFO("Ray Tracing Pipeline created successfully");
 }
 
 void RayTracingPipeline::createAccelerationStructures(VkBuffer vertexBuffer, VkBuffer indexBuffer,
-                                                      uint32_t vertexCount, uint32_t indexCount) {
-    
-    std::cout << "Step 1: Creating BLAS (Bottom Level Acceleration Structure)" << std::endl;
-    
-    // BLAS geometry setup
-    VkAccelerationStructureGeometryKHR geometry{};
-    geometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
-    geometry.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
-    geometry.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
-    
-    geometry.geometry.triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
-    geometry.geometry.triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
-    geometry.geometry.triangles.vertexData.deviceAddress = getBufferDeviceAddress(vertexBuffer);
-    geometry.geometry.triangles.vertexStride = sizeof(Vertex);
-    geometry.geometry.triangles.maxVertex = vertexCount - 1;
-    geometry.geometry.triangles.indexType = VK_INDEX_TYPE_UINT32;
-    geometry.geometry.triangles.indexData.deviceAddress = getBufferDeviceAddress(indexBuffer);
-    
-    // Build info
-    VkAccelerationStructureBuildGeometryInfoKHR buildInfo{};
-    buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
-    buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
-    buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
-    buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
-    buildInfo.geometryCount = 1;
-    buildInfo.pGeometries = &geometry;
-    
-    uint32_t primitiveCount = indexCount / 3;
-    VkAccelerationStructureBuildSizesInfoKHR blasSizeInfo{};
-    blasSizeInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
-    vkGetAccelerationStructureBuildSizesKHR(device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, 
-                                           &buildInfo, &primitiveCount, &blasSizeInfo);
-    
-    std::cout << "✅ BLAS size calculated: " << blasSizeInfo.accelerationStructureSize << " bytes" << std::endl;
-    std::cout << "   - Vertices: " << vertexCount << ", Triangles: " << primitiveCount << std::endl;
-    
-    // Step 2: Create BLAS buffer and memory
-    std::cout << "Step 2: Creating BLAS buffer and memory allocation" << std::endl;
-    
-    VulkanHelpers::createBuffer(device, physicalDevice, 
-                               blasSizeInfo.accelerationStructureSize,
-                               VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                               bottomLevelASBuffer, bottomLevelASMemory);
-    
-    std::cout << "✅ BLAS buffer created: " << blasSizeInfo.accelerationStructureSize << " bytes allocated" << std::endl;
-    
-    // Step 3: Create actual acceleration structure
-    std::cout << "Step 3: Creating BLAS acceleration structure" << std::endl;
-    
-    VkAccelerationStructureCreateInfoKHR asCreateInfo{};
-    asCreateInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
-    asCreateInfo.buffer = bottomLevelASBuffer;
-    asCreateInfo.size = blasSizeInfo.accelerationStructureSize;
-    asCreateInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
-    
-    VkResult result = vkCreateAccelerationStructureKHR(device, &asCreateInfo, nullptr, &bottomLevelAS);
-    if (result != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create bottom level acceleration structure");
+                                                      const std::vector<ClippyGeometry::Part>& parts,
+                                                      const std::vector<ClippyGeometry::PartInstance>& instances) {
+    
+    LOG_INFO("Step 1: Creating one BLAS per part (" << parts.size() << " parts)");
+    
+    VkDeviceAddress vertexAddress = getBufferDeviceAddress(vertexBuffer);
+    VkDeviceAddress indexAddress = getBufferDeviceAddress(indexBuffer);
+    
+    bottomLevels.assign(parts.size(), BottomLevel{});
+    std::vector<VkAccelerationStructureBuildGeometryInfoKHR> buildInfos(parts.size());
+    uint32_t compactableCount = 0;
+    uint32_t totalTriangles = 0;
+    asStats.assign(parts.size(), AccelerationStructureStats{});
+    std::vector<VkAccelerationStructureKHR> deviceBuilt(parts.size(), VK_NULL_HANDLE);   // Pre-compaction handles
+    
+    for (size_t p = 0; p < parts.size(); p++) {
+        const ClippyGeometry::Part& part = parts[p];
+        BottomLevel& blas = bottomLevels[p];
+        bool animated = hasAnimatedGeometry() && p == animatedPart;
+        bool hostBuild = hostBuilder && !animated;   // Refits stay on the frame command buffers
+        blas.name = part.name;
+        
+        // BLAS geometry setup (kept as a member: the batched build and animated refits read it)
+        VkAccelerationStructureGeometryKHR& geometry = blas.geometry;
+        geometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+        geometry.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
+        geometry.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+        
+        geometry.geometry.triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+        geometry.geometry.triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
+        if (animated) {
+            // The deformed buffer only holds this part's vertices
+            geometry.geometry.triangles.vertexData.deviceAddress = getBufferDeviceAddress(animatedPositionBuffer);
+            geometry.geometry.triangles.vertexStride = animatedPositionStride;
+        } else {
+            geometry.geometry.triangles.vertexData.deviceAddress = vertexAddress + part.firstVertex * sizeof(Vertex);
+            geometry.geometry.triangles.vertexStride = sizeof(Vertex);
+        }
+        geometry.geometry.triangles.maxVertex = part.vertexCount - 1;
+        geometry.geometry.triangles.indexType = VK_INDEX_TYPE_UINT32;
+        geometry.geometry.triangles.indexData.deviceAddress = indexAddress + part.firstIndex * sizeof(uint32_t);
+        if (hostBuild) {
+            geometry.geometry.triangles.vertexData.hostAddress = hostVertices->data() + part.firstVertex;
+            geometry.geometry.triangles.indexData.hostAddress = hostIndices->data() + part.firstIndex;
+        }
+        
+        blas.range.primitiveCount = part.indexCount / 3;
+        totalTriangles += blas.range.primitiveCount;
+        
+        AccelerationStructureStats& stats = asStats[p];
+        stats.name = part.name;
+        stats.primitiveCount = blas.range.primitiveCount;
+        stats.degenerateTriangles = part.degenerateTriangles;
+        
+        // Build info
+        VkAccelerationStructureBuildGeometryInfoKHR& buildInfo = buildInfos[p];
+        buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+        buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+        buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+        if (animated) {
+            // Refit-friendly; a deforming BLAS is not worth compacting
+            buildInfo.flags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+        } else if (compactBLAS) {
+            buildInfo.flags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
+        }
+        buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+        buildInfo.geometryCount = 1;
+        buildInfo.pGeometries = &geometry;
+        
+        // Warm start: a compatible serialized copy of this part replaces the build (and compaction)
+        if (asCache && !animated) {
+            uint64_t flags = buildInfo.flags;
+            blas.cacheKey = AccelerationStructureCache::hash(&flags, sizeof(flags), part.contentHash);
+            if (loadCachedBottomLevel(blas)) {
+                stats.source = "cache";
+                stats.buildSize = blas.size;
+                LOG_INFO("✅ BLAS '" << part.name << "': " << blas.range.primitiveCount << " triangles, "
+                         << blas.size << " bytes (deserialized from cache)");
+                continue;
+            }
+        }
+        if (buildInfo.flags & VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR) {
+            compactableCount++;
+        }
+        
+        VkAccelerationStructureBuildSizesInfoKHR blasSizeInfo{};
+        blasSizeInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+        vkGetAccelerationStructureBuildSizesKHR(device, hostBuild ? VK_ACCELERATION_STRUCTURE_BUILD_TYPE_HOST_KHR
+                                                                  : VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+                                               &buildInfo, &blas.range.primitiveCount, &blasSizeInfo);
+        
+        // Step 2: Create BLAS buffer and memory (host builds write it from the CPU)
+        VulkanHelpers::createBuffer(device, physicalDevice, 
+                                   blasSizeInfo.accelerationStructureSize,
+                                   VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                                   hostBuild ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+                                             : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                   blas.buffer, blas.memory);
+        
+        // Step 3: Create actual acceleration structure
+        VkAccelerationStructureCreateInfoKHR asCreateInfo{};
+        asCreateInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+        asCreateInfo.buffer = blas.buffer;
+        asCreateInfo.size = blasSizeInfo.accelerationStructureSize;
+        asCreateInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+        
+        VkResult result = vkCreateAccelerationStructureKHR(device, &asCreateInfo, nullptr, &blas.handle);
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create bottom level acceleration structure");
+        }
+        blas.size = blasSizeInfo.accelerationStructureSize;
+        stats.buildSize = blas.size;
+        stats.buildScratchSize = blasSizeInfo.buildScratchSize;
+        stats.updateScratchSize = blasSizeInfo.updateScratchSize;
+        
+        // Animated parts refit every frame from the shared scratch arena
+        if (animated) {
+            asBuilder->reserveScratch(std::max(blasSizeInfo.buildScratchSize, blasSizeInfo.updateScratchSize));
+        }
+        
+        // Step 4: Queue the build; all device parts go out in one vkCmdBuildAccelerationStructuresKHR
+        buildInfo.dstAccelerationStructure = blas.handle;
+        if (hostBuild) {
+            hostBuilder->addBuild(buildInfo, &blas.range, blasSizeInfo.buildScratchSize);
+            blas.hostBuilt = true;
+            stats.source = "host";
+        } else {
+            asBuilder->addBuild(buildInfo, &blas.range, blasSizeInfo.buildScratchSize);
+            deviceBuilt[p] = blas.handle;
+        }
+        
+        LOG_INFO("✅ BLAS '" << part.name << "': " << part.vertexCount << " vertices, "
+                 << blas.range.primitiveCount << " triangles, " << blas.size << " bytes"
+                 << (animated ? " (animated)" : "") << (hostBuild ? " (host build)" : ""));
     }
     
-    std::cout << "✅ BLAS acceleration structure created successfully" << std::endl;
-    
-    // Step 4: Build the BLAS with command buffer (complex step)
-    std::cout << "Step 4: Building BLAS with command buffer" << std::endl;
-    
-    // Need scratch buffer for building
-    VkBuffer scratchBuffer;
-    VkDeviceMemory scratchMemory;
-    VulkanHelpers::createBuffer(device, physicalDevice,
-                               blasSizeInfo.buildScratchSize,
-                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                               scratchBuffer, scratchMemory);
-    
-    // Update build info with destination and scratch addresses
-    buildInfo.dstAccelerationStructure = bottomLevelAS;
-    buildInfo.scratchData.deviceAddress = getBufferDeviceAddress(scratchBuffer);
-    
-    // Build range info
-    VkAccelerationStructureBuildRangeInfoKHR buildRangeInfo{};
-    buildRangeInfo.primitiveCount = primitiveCount;
-    buildRangeInfo.primitiveOffset = 0;
-    buildRangeInfo.firstVertex = 0;
-    buildRangeInfo.transformOffset = 0;
-    
-    const VkAccelerationStructureBuildRangeInfoKHR* pBuildRangeInfo = &buildRangeInfo;
-    
-    // Real command buffer building
-    std::cout << "   - Scratch buffer created: " << blasSizeInfo.buildScratchSize << " bytes" << std::endl;
-    std::cout << "   - Build info configured with addresses" << std::endl;
-    
-    VkCommandBuffer buildCommandBuffer = beginSingleTimeCommands();
-    
-    std::cout << "   - Executing vkCmdBuildAccelerationStructuresKHR..." << std::endl;
-    vkCmdBuildAccelerationStructuresKHR(buildCommandBuffer, 1, &buildInfo, &pBuildRangeInfo);
-    
-    endSingleTimeCommands(buildCommandBuffer);
-    std::cout << "   - Command buffer executed and submitted to GPU" << std::endl;
-    
-    // Cleanup scratch buffer
-    vkDestroyBuffer(device, scratchBuffer, nullptr);
-    vkFreeMemory(device, scratchMemory, nullptr);
+    // Host builds run on the worker pool while the device batch is recorded; they must be done
+    // before anything on the queue reads those structures
+    if (hostBuilder) {
+        hostBuilder->submit();
+    }
+    auto waitForHostBuilds = [&]() {
+        if (hostBuilder && hostBuilder->isBusy()) {
+            hostBuilder->wait();
+            LOG_INFO("   - Host BLAS builds completed: " << hostBuilder->getLastBuildMs() << " ms on "
+                     << hostBuilder->getWorkerCount() << " worker thread(s)");
+        }
+    };
+    // Read while the built handles are alive (compaction retires them)
+    auto collectBuildTimes = [&]() {
+        for (size_t p = 0; p < bottomLevels.size(); p++) {
+            if (deviceBuilt[p] != VK_NULL_HANDLE && asStats[p].buildMs < 0.0) {
+                asStats[p].buildMs = asBuilder->getBuildMs(deviceBuilt[p]);
+            }
+        }
+    };
+    
+    // The compacted sizes are only known once the builds have run: query them in the same batch
+    // and submit early. The compaction copies then go out together with the TLAS build.
+    auto isCompactable = [&](uint32_t p) {
+        return !bottomLevels[p].fromCache &&
+               (buildInfos[p].flags & VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR) != 0;
+    };
+    if (compactableCount > 0) {
+        VkQueryPool compactedSizeQuery = VK_NULL_HANDLE;
+        VkQueryPoolCreateInfo queryPoolInfo{};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR;
+        queryPoolInfo.queryCount = static_cast<uint32_t>(bottomLevels.size());
+        if (vkCreateQueryPool(device, &queryPoolInfo, nullptr, &compactedSizeQuery) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create BLAS compaction query pool!");
+        }
+        
+        for (uint32_t p = 0; p < bottomLevels.size(); p++) {
+            if (isCompactable(p)) {
+                asBuilder->addPropertyQuery(bottomLevels[p].handle, VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR,
+                                            compactedSizeQuery, p);
+            }
+        }
+        waitForHostBuilds();
+        asBuilder->flush();
+        LOG_INFO("   - BLAS build batch completed (fence)");
+        collectBuildTimes();
+        
+        // Step 4b: Swap each BLAS for a right-sized copy before the TLAS references its address
+        for (uint32_t p = 0; p < bottomLevels.size(); p++) {
+            if (isCompactable(p)) {
+                compactBottomLevelAS(bottomLevels[p], compactedSizeQuery, p);
+            }
+        }
+        vkDestroyQueryPool(device, compactedSizeQuery, nullptr);
+    }
     
-    std::cout << "✅ BLAS built successfully with " << primitiveCount << " triangles" << std::endl;
-    std::cout << "Acceleration structures setup (step 4: BLAS fully built!)" << std::endl;
+    // Host builds that were not compacted still sit in host-visible memory: trace a device-local clone
+    for (BottomLevel& blas : bottomLevels) {
+        if (blas.hostBuilt) {
+            copyBottomLevelAS(blas, blas.size, VK_COPY_ACCELERATION_STRUCTURE_MODE_CLONE_KHR);
+            LOG_INFO("   - BLAS '" << blas.name << "' cloned to device-local memory (" << blas.size << " bytes)");
+        }
+    }
     
     // === TOP LEVEL ACCELERATION STRUCTURE (TLAS) ===
-    std::cout << "\nStep 5: Creating TLAS (Top Level Acceleration Structure)" << std::endl;
-    
-    // Step 5a: Create instance data for Clippy
-    VkAccelerationStructureInstanceKHR instance{};
-    
-    // Identity transformation matrix (Clippy at origin)
-    instance.transform.matrix[0][0] = 1.0f; instance.transform.matrix[0][1] = 0.0f; instance.transform.matrix[0][2] = 0.0f; instance.transform.matrix[0][3] = 0.0f;
-    instance.transform.matrix[1][0] = 0.0f; instance.transform.matrix[1][1] = 1.0f; instance.transform.matrix[1][2] = 0.0f; instance.transform.matrix[1][3] = 0.0f;
-    instance.transform.matrix[2][0] = 0.0f; instance.transform.matrix[2][1] = 0.0f; instance.transform.matrix[2][2] = 1.0f; instance.transform.matrix[2][3] = 0.0f;
-    
-    instance.instanceCustomIndex = 0;  // Custom index for shader access
-    instance.mask = 0xFF;              // Visibility mask
-    instance.instanceShaderBindingTableRecordOffset = 0; // Hit group offset
-    instance.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
-    instance.accelerationStructureReference = getAccelerationStructureDeviceAddress(bottomLevelAS);
+    LOG_INFO("\nStep 5: Creating TLAS (Top Level Acceleration Structure)");
+    
+    // Step 5a: One instance per part placement and crowd member; repeated parts share their BLAS
+    layoutCrowd();
+    instancesPerClippy = static_cast<uint32_t>(instances.size());
+    uint32_t instanceCount = instancesPerClippy * static_cast<uint32_t>(crowd.size());
+    std::vector<VkAccelerationStructureInstanceKHR> instanceTemplates(instancesPerClippy);
+    instanceLocalTransforms.clear();
+    
+    for (uint32_t i = 0; i < instancesPerClippy; i++) {
+        VkAccelerationStructureInstanceKHR& instance = instanceTemplates[i];
+        instanceLocalTransforms.push_back(instances[i].transform);
+        
+        // Transforms, custom index and mask are per crowd member (see fillInstances)
+        instance.instanceShaderBindingTableRecordOffset = 0; // Hit group offset
+        instance.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
+        instance.accelerationStructureReference = getAccelerationStructureDeviceAddress(bottomLevels[instances[i].part].handle);
+    }
     
-    std::cout << "✅ TLAS instance created with identity transform" << std::endl;
-    std::cout << "   - BLAS address: 0x" << std::hex << instance.accelerationStructureReference << std::dec << std::endl;
+    LOG_INFO("✅ TLAS instances created: " << instanceCount << " instances of " << bottomLevels.size() << " BLASes ("
+             << crowd.size() << " Clippies)");
     
     // Step 5b: Create instance buffer and upload data
-    std::cout << "Step 5b: Creating TLAS instance buffer" << std::endl;
+    LOG_INFO("Step 5b: Creating TLAS instance buffer");
     
-    VkBuffer instanceBuffer;
-    VkDeviceMemory instanceBufferMemory;
-    VkDeviceSize instanceBufferSize = sizeof(VkAccelerationStructureInstanceKHR);
+    // One copy of the instances per frame slot; stays mapped for the per-frame transform writes
+    VkDeviceSize instanceBufferSize = sizeof(VkAccelerationStructureInstanceKHR) * instanceCount * instanceSlots;
     
     VulkanHelpers::createBuffer(device, physicalDevice,
                                instanceBufferSize,
@@ -374,20 +495,30 @@ void RayTracingPipeline::createAccelerationStructures(VkBuffer vertexBuffer, VkB
     // Upload instance data to buffer
     void* mappedData;
     vkMapMemory(device, instanceBufferMemory, 0, instanceBufferSize, 0, &mappedData);
-    memcpy(mappedData, &instance, sizeof(VkAccelerationStructureInstanceKHR));
-    vkUnmapMemory(device, instanceBufferMemory);
+    instanceData = static_cast<VkAccelerationStructureInstanceKHR*>(mappedData);
+    tlasInstanceCount = instanceCount;
+    for (uint32_t slot = 0; slot < instanceSlots; slot++) {
+        VkAccelerationStructureInstanceKHR* slotInstances = instanceData + slot * instanceCount;
+        for (uint32_t member = 0; member < crowd.size(); member++) {
+            memcpy(&slotInstances[member * instancesPerClippy], instanceTemplates.data(),
+                   sizeof(VkAccelerationStructureInstanceKHR) * instancesPerClippy);
+        }
+        fillInstances(slotInstances, glm::mat4(1.0f), 0.0f);
+    }
+    
+    createInstanceShadingBuffer(instances);
     
     VkDeviceAddress instanceBufferAddress = getBufferDeviceAddress(instanceBuffer);
     
-    std::cout << "✅ TLAS instance buffer created and uploaded" << std::endl;
-    std::cout << "   - Instance buffer size: " << instanceBufferSize << " bytes" << std::endl;
-    std::cout << "   - Instance buffer address: 0x" << std::hex << instanceBufferAddress << std::dec << std::endl;
+    LOG_INFO("✅ TLAS instance buffer created and uploaded");
+    LOG_INFO("   - Instance buffer size: " << instanceBufferSize << " bytes");
+    LOG_INFO("   - Instance buffer address: 0x" << std::hex << instanceBufferAddress << std::dec);
     
     // Step 5c: Create TLAS geometry and build info
-    std::cout << "Step 5c: Creating TLAS geometry and build info" << std::endl;
+    LOG_INFO("Step 5c: Creating TLAS geometry and build info");
     
     // TLAS geometry setup (different from BLAS - uses instances)
-    VkAccelerationStructureGeometryKHR tlasGeometry{};
+    tlasGeometry = {};
     tlasGeometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
     tlasGeometry.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR;
     tlasGeometry.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
@@ -400,24 +531,24 @@ void RayTracingPipeline::createAccelerationStructures(VkBuffer vertexBuffer, VkB
     VkAccelerationStructureBuildGeometryInfoKHR tlasBuildInfo{};
     tlasBuildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
     tlasBuildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
-    tlasBuildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+    tlasBuildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+                          VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;   // Refit per frame
     tlasBuildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
     tlasBuildInfo.geometryCount = 1;
     tlasBuildInfo.pGeometries = &tlasGeometry;
     
-    uint32_t instanceCount = 1; // One Clippy instance
     VkAccelerationStructureBuildSizesInfoKHR tlasSizeInfo{};
     tlasSizeInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
     vkGetAccelerationStructureBuildSizesKHR(device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
                                            &tlasBuildInfo, &instanceCount, &tlasSizeInfo);
     
-    std::cout << "✅ TLAS geometry and build info created" << std::endl;
-    std::cout << "   - TLAS size: " << tlasSizeInfo.accelerationStructureSize << " bytes" << std::endl;
-    std::cout << "   - TLAS scratch size: " << tlasSizeInfo.buildScratchSize << " bytes" << std::endl;
-    std::cout << "   - Instance count: " << instanceCount << std::endl;
+    LOG_INFO("✅ TLAS geometry and build info created");
+    LOG_INFO("   - TLAS size: " << tlasSizeInfo.accelerationStructureSize << " bytes");
+    LOG_INFO("   - TLAS scratch size: " << tlasSizeInfo.buildScratchSize << " bytes");
+    LOG_INFO("   - Instance count: " << instanceCount);
     
     // Step 5d: Build complete TLAS - FINAL STEP!
-    std::cout << "Step 5d: Building complete TLAS with command buffer (FINAL STEP!)" << std::endl;
+    LOG_INFO("Step 5d: Building complete TLAS with command buffer (FINAL STEP!)");
     
     // Create TLAS buffer
     VulkanHelpers::createBuffer(device, physicalDevice,
@@ -438,20 +569,12 @@ void RayTracingPipeline::createAccelerationStructures(VkBuffer vertexBuffer, VkB
         throw std::runtime_error("Failed to create top level acceleration structure");
     }
     
-    std::cout << "   ✅ TLAS buffer and acceleration structure created" << std::endl;
+    LOG_INFO("   ✅ TLAS buffer and acceleration structure created");
     
-    // Create TLAS scratch buffer
-    VkBuffer tlasScratchBuffer;
-    VkDeviceMemory tlasScratchMemory;
-    VulkanHelpers::createBuffer(device, physicalDevice,
-                               tlasSizeInfo.buildScratchSize,
-                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                               tlasScratchBuffer, tlasScratchMemory);
+    // The per-frame TLAS updates use the shared scratch arena
+    asBuilder->reserveScratch(std::max(tlasSizeInfo.buildScratchSize, tlasSizeInfo.updateScratchSize));
     
-    // Update TLAS build info with destination and scratch addresses
     tlasBuildInfo.dstAccelerationStructure = topLevelAS;
-    tlasBuildInfo.scratchData.deviceAddress = getBufferDeviceAddress(tlasScratchBuffer);
     
     // TLAS build range info
     VkAccelerationStructureBuildRangeInfoKHR tlasBuildRangeInfo{};
@@ -460,33 +583,476 @@ void RayTracingPipeline::createAccelerationStructures(VkBuffer vertexBuffer, VkB
     tlasBuildRangeInfo.firstVertex = 0;
     tlasBuildRangeInfo.transformOffset = 0;
     
-    const VkAccelerationStructureBuildRangeInfoKHR* pTlasBuildRangeInfo = &tlasBuildRangeInfo;
+    asBuilder->addBuild(tlasBuildInfo, &tlasBuildRangeInfo, tlasSizeInfo.buildScratchSize);
+    
+    // One command buffer for everything still queued (BLASes or compaction copies, then TLAS),
+    // completion signalled by the builder's fence
+    LOG_INFO("   - Submitting acceleration structure batch...");
+    waitForHostBuilds();
+    asBuilder->flush();
+    tlasBuildMs = asBuilder->getLastTopLevelBuildMs();
+    collectBuildTimes();
+    
+    for (size_t p = 0; p < bottomLevels.size(); p++) {
+        asStats[p].finalSize = bottomLevels[p].size;
+    }
+    AccelerationStructureStats tlasStats;
+    tlasStats.name = "tlas";
+    tlasStats.topLevel = true;
+    tlasStats.primitiveCount = instanceCount;
+    tlasStats.buildSize = tlasSizeInfo.accelerationStructureSize;
+    tlasStats.finalSize = tlasSizeInfo.accelerationStructureSize;
+    tlasStats.buildScratchSize = tlasSizeInfo.buildScratchSize;
+    tlasStats.updateScratchSize = tlasSizeInfo.updateScratchSize;
+    tlasStats.buildMs = asBuilder->getBuildMs(topLevelAS);
+    if (tlasStats.buildMs < 0.0 && tlasBuildMs > 0.0) {
+        tlasStats.buildMs = tlasBuildMs;   // Phase timestamps: the TLAS is the only build in it
+    }
+    asStats.push_back(tlasStats);
+    
+    if (asCache) {
+        storeBottomLevelsInCache();
+    }
+    
+    VkDeviceSize totalBLASSize = 0;
+    for (const BottomLevel& blas : bottomLevels) {
+        totalBLASSize += blas.size;
+    }
+    
+    LOG_INFO("🎉 ✅ COMPLETE ACCELERATION STRUCTURE HIERARCHY BUILT!");
+    LOG_INFO("   - BLAS: " << bottomLevels.size() << " parts, " << totalTriangles << " unique triangles ("
+             << totalBLASSize << " bytes)");
+    LOG_INFO("   - TLAS: " << instanceCount << " instances (" << tlasSizeInfo.accelerationStructureSize << " bytes, "
+             << tlasBuildMs << " ms GPU build)");
+    LOG_INFO("🚀 RTX RAY TRACING INFRASTRUCTURE READY!");
+}
+
+void RayTracingPipeline::setHostBuilds(const std::vector<Vertex>* vertices, const std::vector<uint32_t>* indices) {
+    hostVertices = vertices;
+    hostIndices = indices;
+    hostBuilder = std::make_unique<HostAccelerationStructureBuilder>(device);
+    LOG_INFO("🧵 Static BLASes will be built on the host (" << hostBuilder->getWorkerCount() << " worker threads)");
+}
+
+void RayTracingPipeline::setAnimatedGeometry(uint32_t part, VkBuffer positionBuffer, VkDeviceSize positionStride,
+                                             uint32_t rebuildInterval) {
+    animatedPart = part;
+    animatedPositionBuffer = positionBuffer;
+    animatedPositionStride = positionStride;
+    blasRebuildInterval = std::max(rebuildInterval, 1u);
+}
+
+bool RayTracingPipeline::recordGeometryUpdate(VkCommandBuffer commandBuffer, bool forceRebuild) {
+    if (!hasAnimatedGeometry()) return false;
+    
+    // The previous frame may still be building or tracing this BLAS/TLAS and using the scratch
+    VkMemoryBarrier previousFrameBarrier{};
+    previousFrameBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    previousFrameBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+    previousFrameBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR |
+                                         VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+                         VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                         0, 1, &previousFrameBarrier, 0, nullptr, 0, nullptr);
+    
+    // Refits keep the topology of the last full build, so quality drifts as vertices move away
+    // from it: rebuild periodically, or right away when the caller sees a large deformation
+    bool rebuild = forceRebuild || framesSinceBLASBuild + 1 >= blasRebuildInterval;
+    BottomLevel& blas = bottomLevels[animatedPart];
+    
+    VkAccelerationStructureBuildGeometryInfoKHR blasBuildInfo{};
+    blasBuildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+    blasBuildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+    blasBuildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+                          VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+    blasBuildInfo.mode = rebuild ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR
+                                 : VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
+    blasBuildInfo.srcAccelerationStructure = rebuild ? VK_NULL_HANDLE : blas.handle;
+    blasBuildInfo.dstAccelerationStructure = blas.handle;
+    blasBuildInfo.geometryCount = 1;
+    blasBuildInfo.pGeometries = &blas.geometry;
+    blasBuildInfo.scratchData.deviceAddress = asBuilder->getScratchAddress();
+    
+    const VkAccelerationStructureBuildRangeInfoKHR* pBlasRange = &blas.range;
+    vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &blasBuildInfo, &pBlasRange);
+    
+    framesSinceBLASBuild = rebuild ? 0 : framesSinceBLASBuild + 1;
+    
+    // The TLAS update reads the BLAS bounds
+    VkMemoryBarrier blasBarrier{};
+    blasBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    blasBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+    blasBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                         VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                         0, 1, &blasBarrier, 0, nullptr, 0, nullptr);
+    
+    return rebuild;
+}
+
+void RayTracingPipeline::recordInstanceUpdate(VkCommandBuffer commandBuffer, uint32_t frameSlot,
+                                              const glm::mat4& transform, float time) {
+    // This slot's previous frame has completed (the caller waited on its fence), so the host
+    // write cannot race the GPU. Coherent memory: visible to the build at submit.
+    uint32_t slot = frameSlot % instanceSlots;
+    auto fillStart = std::chrono::high_resolution_clock::now();
+    fillInstances(instanceData + slot * tlasInstanceCount, transform, time);
+    lastInstanceFillMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - fillStart).count();
+    
+    // The previous frame may still be tracing against (or refitting) the TLAS
+    VkMemoryBarrier previousFrameBarrier{};
+    previousFrameBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    previousFrameBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+    previousFrameBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR |
+                                         VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+                         VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                         0, 1, &previousFrameBarrier, 0, nullptr, 0, nullptr);
+    
+    // Same instance count and flags as the initial build, so an update is enough
+    tlasGeometry.geometry.instances.data.deviceAddress =
+        getBufferDeviceAddress(instanceBuffer) + slot * tlasInstanceCount * sizeof(VkAccelerationStructureInstanceKHR);
+    
+    VkAccelerationStructureBuildGeometryInfoKHR tlasBuildInfo{};
+    tlasBuildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+    tlasBuildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
+    tlasBuildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+                          VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+    tlasBuildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
+    tlasBuildInfo.srcAccelerationStructure = topLevelAS;
+    tlasBuildInfo.dstAccelerationStructure = topLevelAS;
+    tlasBuildInfo.geometryCount = 1;
+    tlasBuildInfo.pGeometries = &tlasGeometry;
+    tlasBuildInfo.scratchData.deviceAddress = asBuilder->getScratchAddress();
+    
+    VkAccelerationStructureBuildRangeInfoKHR tlasRange{};
+    tlasRange.primitiveCount = tlasInstanceCount;
+    const VkAccelerationStructureBuildRangeInfoKHR* pTlasRange = &tlasRange;
+    vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &tlasBuildInfo, &pTlasRange);
+    
+    // traceRays reads the TLAS
+    VkMemoryBarrier tlasBarrier{};
+    tlasBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    tlasBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+    tlasBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                         VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+                         0, 1, &tlasBarrier, 0, nullptr, 0, nullptr);
+}
+
+void RayTracingPipeline::setCrowdSize(uint32_t count) {
+    crowdSize = std::min(std::max(count, 1u), MAX_CROWD_SIZE);
+}
+
+void RayTracingPipeline::layoutCrowd() {
+    crowd.assign(crowdSize, CrowdMember{});
+    
+    // Big crowds fill their instances in parallel every frame: the threads are started here, once
+    fillPool.reset();
+    if (crowdSize >= PARALLEL_FILL_MIN_MEMBERS) {
+        uint32_t threadCount = std::min(std::max(std::thread::hardware_concurrency(), 1u), crowdSize / PARALLEL_FILL_MIN_MEMBERS);
+        if (threadCount > 1) {
+            fillPool = std::make_unique<WorkStealingPool>(threadCount);
+        }
+    }
+    
+    // Member 0 is the hero at the origin and follows the UBO personality. The rest fill a
+    // sunflower half-disc behind it (golden angle spiral, constant density).
+    const float goldenAngle = 2.39996323f;
+    const float spacing = 1.4f;
+    for (uint32_t member = 1; member < crowdSize; member++) {
+        CrowdMember& clippy = crowd[member];
+        float radius = spacing * std::sqrt(2.0f * member);
+        float angle = std::fmod(member * goldenAngle, glm::pi<float>());
+        clippy.position = glm::vec3(radius * std::cos(angle), 0.0f, -spacing - radius * std::sin(angle));
+        
+        // Cheap integer hash so neighbours differ
+        uint32_t hash = member * 2654435761u;
+        clippy.personality = static_cast<int32_t>((hash >> 16) % PERSONALITY_COUNT);
+        clippy.yaw = (hash & 0xFFFF) / 65535.0f * glm::two_pi<float>();
+        clippy.phase = ((hash >> 8) & 0xFF) / 255.0f * glm::two_pi<float>();
+    }
+}
+
+void RayTracingPipeline::fillInstanceRange(VkAccelerationStructureInstanceKHR* slotInstances, const glm::mat4& model,
+                                           float time, uint32_t firstMember, uint32_t endMember) const {
+    for (uint32_t member = firstMember; member < endMember; member++) {
+        const CrowdMember& clippy = crowd[member];
+        glm::mat4 memberTransform = model;
+        if (member > 0) {
+            // Each crowd Clippy bobs on its own phase and faces its own way
+            float bob = std::sin(time * 2.0f + clippy.phase) * 0.05f;
+            memberTransform = glm::translate(glm::mat4(1.0f), clippy.position + glm::vec3(0.0f, bob, 0.0f)) *
+                              glm::rotate(glm::mat4(1.0f), clippy.yaw, glm::vec3(0.0f, 1.0f, 0.0f)) * model;
+        }
+        uint8_t mask = member == 0 ? MASK_HERO : static_cast<uint8_t>(MASK_CROWD << clippy.personality);
+        
+        for (uint32_t i = 0; i < instancesPerClippy; i++) {
+            uint32_t index = member * instancesPerClippy + i;
+            VkAccelerationStructureInstanceKHR& instance = slotInstances[index];
+            glm::mat4 instanceTransform = memberTransform * instanceLocalTransforms[i];
+            for (int row = 0; row < 3; row++) {
+                for (int column = 0; column < 4; column++) {
+                    instance.transform.matrix[row][column] = instanceTransform[column][row];   // glm is column-major
+                }
+            }
+            instance.instanceCustomIndex = index;   // Row of the instance shading buffer
+            instance.mask = mask;
+        }
+    }
+}
+
+void RayTracingPipeline::fillInstances(VkAccelerationStructureInstanceKHR* slotInstances, const glm::mat4& model,
+                                       float time) const {
+    uint32_t memberCount = static_cast<uint32_t>(crowd.size());
+    if (!fillPool) {
+        fillInstanceRange(slotInstances, model, time, 0, memberCount);
+        return;
+    }
     
-    // Build TLAS with command buffer
-    std::cout << "   - Executing TLAS build with command buffer..." << std::endl;
-    VkCommandBuffer tlasBuildCommandBuffer = beginSingleTimeCommands();
+    // Disjoint member ranges, so the workers never write the same instance
+    uint32_t taskCount = (memberCount + FILL_CHUNK_MEMBERS - 1) / FILL_CHUNK_MEMBERS;
+    fillPool->run(taskCount, [&](uint32_t task, uint32_t) {
+        uint32_t first = task * FILL_CHUNK_MEMBERS;
+        fillInstanceRange(slotInstances, model, time, first, std::min(first + FILL_CHUNK_MEMBERS, memberCount));
+    });
+}
+
+void RayTracingPipeline::createInstanceShadingBuffer(const std::vector<ClippyGeometry::PartInstance>& instances) {
+    // Crowd tints, roughly the personality colours the app puts in the UBO
+    static const glm::vec3 personalityTints[PERSONALITY_COUNT] = {
+        glm::vec3(1.0f, 0.843f, 0.0f),   // IDLE - gold
+        glm::vec3(1.0f, 1.0f, 0.0f),     // EXCITED - bright yellow
+        glm::vec3(0.0f, 1.0f, 1.0f),     // QUANTUM - cyan
+        glm::vec3(1.0f, 0.2f, 0.8f),     // PARTY - magenta
+        glm::vec3(0.0f, 1.0f, 0.0f),     // HELPING - green
+        glm::vec3(0.5f, 0.0f, 1.0f)      // THINKING - purple
+    };
+    
+    std::vector<InstanceShading> shading(tlasInstanceCount);
+    for (uint32_t member = 0; member < crowd.size(); member++) {
+        for (uint32_t i = 0; i < instancesPerClippy; i++) {
+            InstanceShading& entry = shading[member * instancesPerClippy + i];
+            entry.material = instances[i].material;
+            if (member == 0) {
+                entry.tint = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);   // Hero: personality from the UBO
+                entry.personalityMode = -1;
+            } else {
+                entry.tint = glm::vec4(personalityTints[crowd[member].personality], 0.85f);
+                entry.personalityMode = crowd[member].personality;
+            }
+        }
+    }
     
-    vkCmdBuildAccelerationStructuresKHR(tlasBuildCommandBuffer, 1, &tlasBuildInfo, &pTlasBuildRangeInfo);
+    VkDeviceSize bufferSize = sizeof(InstanceShading) * shading.size();
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingMemory;
+    VulkanHelpers::createBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                stagingBuffer, stagingMemory);
     
-    endSingleTimeCommands(tlasBuildCommandBuffer);
+    void* data;
+    vkMapMemory(device, stagingMemory, 0, bufferSize, 0, &data);
+    memcpy(data, shading.data(), (size_t) bufferSize);
+    vkUnmapMemory(device, stagingMemory);
     
-    // Cleanup TLAS scratch buffer
-    vkDestroyBuffer(device, tlasScratchBuffer, nullptr);
-    vkFreeMemory(device, tlasScratchMemory, nullptr);
+    VulkanHelpers::createBuffer(device, physicalDevice, bufferSize,
+                                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, instanceShadingBuffer, instanceShadingMemory);
+    VulkanHelpers::copyBuffer(device, commandPool, graphicsQueue, stagingBuffer, instanceShadingBuffer, bufferSize);
     
-    // Cleanup instance buffer (no longer needed)
-    vkDestroyBuffer(device, instanceBuffer, nullptr);
-    vkFreeMemory(device, instanceBufferMemory, nullptr);
+    vkDestroyBuffer(device, stagingBuffer, nullptr);
+    vkFreeMemory(device, stagingMemory, nullptr);
     
-    std::cout << "🎉 ✅ COMPLETE ACCELERATION STRUCTURE HIERARCHY BUILT!" << std::endl;
-    std::cout << "   - BLAS: " << primitiveCount << " triangles (" << blasSizeInfo.accelerationStructureSize << " bytes)" << std::endl;
-    std::cout << "   - TLAS: " << instanceCount << " instance (" << tlasSizeInfo.accelerationStructureSize << " bytes)" << std::endl;
-    std::cout << "   - Total hierarchy: TLAS → BLAS → " << primitiveCount << " triangles" << std::endl;
-    std::cout << "🚀 RTX RAY TRACING INFRASTRUCTURE READY!" << std::endl;
+    LOG_INFO("✅ Instance shading buffer: " << shading.size() << " entries (" << bufferSize << " bytes)");
+}
+
+bool RayTracingPipeline::loadCachedBottomLevel(BottomLevel& blas) {
+    const std::vector<uint8_t>* data = asCache->find(blas.cacheKey);
+    VkDeviceSize size = data ? AccelerationStructureCache::deserializedSize(*data) : 0;
+    if (size == 0) {
+        return false;
+    }
+    
+    VulkanHelpers::createBuffer(device, physicalDevice, size,
+                               VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                               blas.buffer, blas.memory);
+    
+    VkAccelerationStructureCreateInfoKHR asCreateInfo{};
+    asCreateInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+    asCreateInfo.buffer = blas.buffer;
+    asCreateInfo.size = size;
+    asCreateInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+    
+    if (vkCreateAccelerationStructureKHR(device, &asCreateInfo, nullptr, &blas.handle) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create cached bottom level acceleration structure!");
+    }
+    
+    // Source of the deserialization; freed by the builder once the batch has completed
+    // (buffer allocations satisfy the 256-byte source alignment)
+    VkBuffer uploadBuffer;
+    VkDeviceMemory uploadMemory;
+    VulkanHelpers::createBuffer(device, physicalDevice, data->size(),
+                               VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                               uploadBuffer, uploadMemory);
+    
+    void* mapped;
+    vkMapMemory(device, uploadMemory, 0, data->size(), 0, &mapped);
+    memcpy(mapped, data->data(), data->size());
+    vkUnmapMemory(device, uploadMemory);
+    
+    VkCopyMemoryToAccelerationStructureInfoKHR copyInfo{};
+    copyInfo.sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_ACCELERATION_STRUCTURE_INFO_KHR;
+    copyInfo.src.deviceAddress = getBufferDeviceAddress(uploadBuffer);
+    copyInfo.dst = blas.handle;
+    copyInfo.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_DESERIALIZE_KHR;
+    
+    asBuilder->addDeserialize(copyInfo);
+    asBuilder->retireAfterCompletion(VK_NULL_HANDLE, uploadBuffer, uploadMemory);
+    
+    blas.size = size;
+    blas.fromCache = true;
+    return true;
+}
+
+void RayTracingPipeline::storeBottomLevelsInCache() {
+    std::vector<uint32_t> fresh;
+    for (uint32_t p = 0; p < bottomLevels.size(); p++) {
+        if (bottomLevels[p].cacheKey != 0 && !bottomLevels[p].fromCache) {
+            fresh.push_back(p);
+        }
+    }
+    if (fresh.empty()) return;
+    
+    // Serialized sizes are only known after the build: one batch for the queries, one for the copies
+    VkQueryPool serializationSizeQuery = VK_NULL_HANDLE;
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_SERIALIZATION_SIZE_KHR;
+    queryPoolInfo.queryCount = static_cast<uint32_t>(fresh.size());
+    if (vkCreateQueryPool(device, &queryPoolInfo, nullptr, &serializationSizeQuery) != VK_SUCCESS) {
+        LOG_WARN("⚠️  BLAS serialization skipped (no query pool)");
+        return;
+    }
+    
+    for (uint32_t i = 0; i < fresh.size(); i++) {
+        asBuilder->addPropertyQuery(bottomLevels[fresh[i]].handle,
+                                    VK_QUERY_TYPE_ACCELERATION_STRUCTURE_SERIALIZATION_SIZE_KHR,
+                                    serializationSizeQuery, i);
+    }
+    asBuilder->flush();
+    
+    std::vector<VkDeviceSize> sizes(fresh.size());
+    VkResult queryResult = vkGetQueryPoolResults(device, serializationSizeQuery, 0, static_cast<uint32_t>(sizes.size()),
+                                                 sizeof(VkDeviceSize) * sizes.size(), sizes.data(), sizeof(VkDeviceSize),
+                                                 VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    vkDestroyQueryPool(device, serializationSizeQuery, nullptr);
+    if (queryResult != VK_SUCCESS) {
+        LOG_WARN("⚠️  BLAS serialization skipped (size query failed)");
+        return;
+    }
+    
+    std::vector<VkBuffer> readbackBuffers(fresh.size(), VK_NULL_HANDLE);
+    std::vector<VkDeviceMemory> readbackMemory(fresh.size(), VK_NULL_HANDLE);
+    for (uint32_t i = 0; i < fresh.size(); i++) {
+        if (sizes[i] == 0) continue;
+        VulkanHelpers::createBuffer(device, physicalDevice, sizes[i],
+                                   VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                   readbackBuffers[i], readbackMemory[i]);
+        
+        VkCopyAccelerationStructureToMemoryInfoKHR copyInfo{};
+        copyInfo.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_TO_MEMORY_INFO_KHR;
+        copyInfo.src = bottomLevels[fresh[i]].handle;
+        copyInfo.dst.deviceAddress = getBufferDeviceAddress(readbackBuffers[i]);
+        copyInfo.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_SERIALIZE_KHR;
+        asBuilder->addSerialize(copyInfo);
+    }
+    asBuilder->flush();
+    
+    for (uint32_t i = 0; i < fresh.size(); i++) {
+        if (readbackBuffers[i] == VK_NULL_HANDLE) continue;
+        
+        std::vector<uint8_t> data(sizes[i]);
+        void* mapped;
+        vkMapMemory(device, readbackMemory[i], 0, sizes[i], 0, &mapped);
+        memcpy(data.data(), mapped, data.size());
+        vkUnmapMemory(device, readbackMemory[i]);
+        asCache->store(bottomLevels[fresh[i]].cacheKey, std::move(data));
+        
+        vkDestroyBuffer(device, readbackBuffers[i], nullptr);
+        vkFreeMemory(device, readbackMemory[i], nullptr);
+        
+        LOG_INFO("💾 BLAS '" << bottomLevels[fresh[i]].name << "' serialized: " << sizes[i] << " bytes");
+    }
+}
+
+void RayTracingPipeline::compactBottomLevelAS(BottomLevel& blas, VkQueryPool compactedSizeQuery, uint32_t query) {
+    LOG_INFO("Step 4b: Compacting BLAS '" << blas.name << "'");
+    
+    // The builder waited on its fence, so the result is available
+    VkDeviceSize compactedSize = 0;
+    VkResult queryResult = vkGetQueryPoolResults(device, compactedSizeQuery, query, 1, sizeof(compactedSize),
+                                                 &compactedSize, sizeof(compactedSize),
+                                                 VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    if (queryResult != VK_SUCCESS || compactedSize == 0 || compactedSize >= blas.size) {
+        LOG_WARN("⚠️  BLAS compaction skipped (compacted size " << compactedSize << " bytes)");
+        return;   // A host build still gets its device-local clone before the TLAS
+    }
+    
+    VkDeviceSize originalSize = blas.size;
+    copyBottomLevelAS(blas, compactedSize, VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR);
+    LOG_INFO("✅ BLAS compaction queued: " << originalSize << " -> " << compactedSize << " bytes ("
+             << (100 - compactedSize * 100 / originalSize) << "% saved)");
+}
+
+void RayTracingPipeline::copyBottomLevelAS(BottomLevel& blas, VkDeviceSize size, VkCopyAccelerationStructureModeKHR mode) {
+    VkBuffer copyBuffer;
+    VkDeviceMemory copyMemory;
+    VulkanHelpers::createBuffer(device, physicalDevice, size,
+                               VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                               copyBuffer, copyMemory);
+    
+    VkAccelerationStructureCreateInfoKHR copyCreateInfo{};
+    copyCreateInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+    copyCreateInfo.buffer = copyBuffer;
+    copyCreateInfo.size = size;
+    copyCreateInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+    
+    VkAccelerationStructureKHR copyAS;
+    if (vkCreateAccelerationStructureKHR(device, &copyCreateInfo, nullptr, &copyAS) != VK_SUCCESS) {
+        vkDestroyBuffer(device, copyBuffer, nullptr);
+        vkFreeMemory(device, copyMemory, nullptr);
+        throw std::runtime_error("failed to create bottom level acceleration structure copy!");
+    }
+    
+    VkCopyAccelerationStructureInfoKHR copyInfo{};
+    copyInfo.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR;
+    copyInfo.src = blas.handle;
+    copyInfo.dst = copyAS;
+    copyInfo.mode = mode;
+    
+    // Recorded ahead of the TLAS build; the original goes once that batch completes
+    asBuilder->addCopy(copyInfo);
+    asBuilder->retireAfterCompletion(blas.handle, blas.buffer, blas.memory);
+    
+    blas.handle = copyAS;
+    blas.buffer = copyBuffer;
+    blas.memory = copyMemory;
+    blas.size = size;
+    blas.hostBuilt = false;
 }
 
 void RayTracingPipeline::createShaderBindingTable() {
-    std::cout << "Creating REAL Shader Binding Table with actual handles!" << std::endl;
+    LOG_INFO("Creating REAL Shader Binding Table with actual handles!");
     
     // Get RT pipeline properties
     VkPhysicalDeviceRayTracingPipelinePropertiesKHR rtPipelineProps{};
@@ -501,9 +1067,9 @@ void RayTracingPipeline::createShaderBindingTable() {
     const uint32_t handleAlignment = rtPipelineProps.shaderGroupHandleAlignment;
     const uint32_t numGroups = 4; // raygen, miss, shadowMiss, hitGroup
     
-    std::cout << "   - Handle size: " << handleSize << " bytes" << std::endl;
-    std::cout << "   - Handle alignment: " << handleAlignment << " bytes" << std::endl;
-    std::cout << "   - Number of groups: " << numGroups << std::endl;
+    LOG_INFO("   - Handle size: " << handleSize << " bytes");
+    LOG_INFO("   - Handle alignment: " << handleAlignment << " bytes");
+    LOG_INFO("   - Number of groups: " << numGroups);
     
     // Get shader handles from pipeline
     const uint32_t sbtSize = numGroups * handleSize;
@@ -514,7 +1080,7 @@ void RayTracingPipeline::createShaderBindingTable() {
         throw std::runtime_error("Failed to get ray tracing shader group handles");
     }
     
-    std::cout << "✅ Retrieved " << numGroups << " real shader handles (" << sbtSize << " bytes total)" << std::endl;
+    LOG_INFO("✅ Retrieved " << numGroups << " real shader handles (" << sbtSize << " bytes total)");
     
     // Calculate aligned sizes for SBT regions
     const uint32_t alignedHandleSize = (handleSize + handleAlignment - 1) & ~(handleAlignment - 1);
@@ -559,70 +1125,52 @@ void RayTracingPipeline::createShaderBindingTable() {
     // Callable region (unused for now)
     callableRegion = {};
     
-    std::cout << "🚀 ✅ REAL SHADER BINDING TABLE CREATED!" << std::endl;
-    std::cout << "   - SBT buffer: " << totalSbtSize << " bytes at 0x" << std::hex << sbtAddress << std::dec << std::endl;
-    std::cout << "   - Raygen region: 0x" << std::hex << raygenRegion.deviceAddress << std::dec << std::endl;
-    std::cout << "   - Miss region: 0x" << std::hex << missRegion.deviceAddress << std::dec << std::endl;
-    std::cout << "   - Hit region: 0x" << std::hex << hitRegion.deviceAddress << std::dec << std::endl;
+    LOG_INFO("🚀 ✅ REAL SHADER BINDING TABLE CREATED!");
+    LOG_INFO("   - SBT buffer: " << totalSbtSize << " bytes at 0x" << std::hex << sbtAddress << std::dec);
+    LOG_INFO("   - Raygen region: 0x" << std::hex << raygenRegion.deviceAddress << std::dec);
+    LOG_INFO("   - Miss region: 0x" << std::hex << missRegion.deviceAddress << std::dec);
+    LOG_INFO("   - Hit region: 0x" << std::hex << hitRegion.deviceAddress << std::dec);
 }
 
-void RayTracingPipeline::traceRays(VkCommandBuffer commandBuffer, uint32_t width, uint32_t height, VkDescriptorSet descriptorSet) {
-    std::cout << "🔥 EXECUTING REAL RAY TRACING DISPATCH WITH TLAS! 🔥" << std::endl;
-    std::cout << "   - Resolution: " << width << "x" << height << std::endl;
-    std::cout << "   - Using TLAS: 0x" << std::hex << getAccelerationStructureDeviceAddress(topLevelAS) << std::dec << std::endl;
+void RayTracingPipeline::traceRays(VkCommandBuffer commandBuffer, uint32_t width, uint32_t height, VkDescriptorSet descriptorSet,
+                                   uint32_t uniformOffset, const std::vector<TileScheduler::Tile>& tiles) {
+    LOG_TRACE("🔥 EXECUTING REAL RAY TRACING DISPATCH WITH TLAS! 🔥");
+    LOG_TRACE("   - Resolution: " << width << "x" << height);
+    LOG_TRACE("   - Using TLAS: 0x" << std::hex << getAccelerationStructureDeviceAddress(topLevelAS) << std::dec);
     
     // Bind ray tracing pipeline
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipeline);
     
     // CRITICAL: Bind descriptor set with TLAS!
     vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, 
-                           pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+                           pipelineLayout, 0, 1, &descriptorSet, 1, &uniformOffset);
     
-    std::cout << "✅ Descriptor set bound with TLAS!" << std::endl;
+    LOG_TRACE("✅ Descriptor set bound with TLAS!");
     
     // REAL RAY TRACING DISPATCH WITH OUR ACCELERATION STRUCTURES!
-    vkCmdTraceRaysKHR(commandBuffer,
-                      &raygenRegion,   // Raygen shader region
-                      &missRegion,     // Miss shader region  
-                      &hitRegion,      // Hit group region
-                      &callableRegion, // Callable region (unused)
-                      width, height, 1);
-    
-    std::cout << "⚡ vkCmdTraceRaysKHR dispatched with real TLAS and descriptor set!" << std::endl;
-    std::cout << "🎯 Tracing " << (width * height) << " rays through Clippy geometry!" << std::endl;
-}
-
-VkCommandBuffer RayTracingPipeline::beginSingleTimeCommands() {
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = commandPool;
-    allocInfo.commandBufferCount = 1;
-
-    VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
-
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-    return commandBuffer;
-}
-
-void RayTracingPipeline::endSingleTimeCommands(VkCommandBuffer commandBuffer) {
-    vkEndCommandBuffer(commandBuffer);
-
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
-
-    vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphicsQueue);
-
-    vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+    // Tiles never overlap, so consecutive launches need no barrier between them
+    uint64_t tracedPixels = 0;
+    for (const TileScheduler::Tile& tile : tiles) {
+        RaygenPushConstants constants{};
+        constants.tileOffset[0] = static_cast<int32_t>(tile.x);
+        constants.tileOffset[1] = static_cast<int32_t>(tile.y);
+        constants.imageSize[0] = static_cast<int32_t>(width);
+        constants.imageSize[1] = static_cast<int32_t>(height);
+        constants.resetHistory = tile.resetHistory ? 1 : 0;
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+                           0, sizeof(constants), &constants);
+        
+        vkCmdTraceRaysKHR(commandBuffer,
+                          &raygenRegion,   // Raygen shader region
+                          &missRegion,     // Miss shader region  
+                          &hitRegion,      // Hit group region
+                          &callableRegion, // Callable region (unused)
+                          tile.width, tile.height, 1);
+        tracedPixels += static_cast<uint64_t>(tile.width) * tile.height;
+    }
+    
+    LOG_TRACE("⚡ vkCmdTraceRaysKHR dispatched with real TLAS and descriptor set!");
+    LOG_TRACE("🎯 Tracing " << tracedPixels << " rays in " << tiles.size() << " tile(s) through Clippy geometry!");
 }
 
 VkShaderModule RayTracingPipeline::createShaderModule(const std::vector<char>& code) {
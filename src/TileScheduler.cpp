@@ -0,0 +1,116 @@
+#include "TileScheduler.h"
+#include "Logger.h"
+#include <algorithm>
+#include <numeric>
+
+void TileScheduler::configure(VkExtent2D newExtent, uint32_t newTileSize, uint32_t newTilesPerFrame) {
+    if (newExtent.width == extent.width && newExtent.height == extent.height &&
+        newTileSize == tileSize && newTilesPerFrame == tilesPerFrame && !tiles.empty()) {
+        return;
+    }
+
+    extent = newExtent;
+    tileSize = newTileSize;
+    tilesPerFrame = newTilesPerFrame;
+    buildTiles();
+
+    uint32_t tileCount = static_cast<uint32_t>(tiles.size());
+    batchCount = (tilesPerFrame == 0 || tilesPerFrame >= tileCount)
+                     ? 1 : (tileCount + tilesPerFrame - 1) / tilesPerFrame;
+    batches.clear();
+    nextBatchIndex = 0;
+
+    if (isTiled()) {
+        LOG_INFO("🧩 Tiled traceRays: " << tileCount << " tiles of " << tileSize << "px over "
+                 << batchCount << " frame(s) per pass");
+    }
+}
+
+void TileScheduler::buildTiles() {
+    tiles.clear();
+
+    uint32_t step = tileSize == 0 ? std::max(extent.width, extent.height) : tileSize;
+    for (uint32_t y = 0; y < extent.height; y += step) {
+        for (uint32_t x = 0; x < extent.width; x += step) {
+            Tile tile;
+            tile.x = x;
+            tile.y = y;
+            tile.width = std::min(step, extent.width - x);
+            tile.height = std::min(step, extent.height - y);
+            tiles.push_back(tile);
+        }
+    }
+}
+
+void TileScheduler::setHotRegion(float minX, float minY, float maxX, float maxY, float costFactor) {
+    hotMinX = minX;
+    hotMinY = minY;
+    hotMaxX = maxX;
+    hotMaxY = maxY;
+    hitCostFactor = costFactor;
+}
+
+void TileScheduler::restartAccumulation() {
+    for (Tile& tile : tiles) {
+        tile.resetHistory = true;
+    }
+}
+
+float TileScheduler::estimateCost(const Tile& tile) const {
+    float overlapX = std::min(hotMaxX, static_cast<float>(tile.x + tile.width)) - std::max(hotMinX, static_cast<float>(tile.x));
+    float overlapY = std::min(hotMaxY, static_cast<float>(tile.y + tile.height)) - std::max(hotMinY, static_cast<float>(tile.y));
+    if (overlapX <= 0.0f || overlapY <= 0.0f) {
+        return 1.0f;
+    }
+
+    float coverage = (overlapX * overlapY) / static_cast<float>(tile.width * tile.height);
+    return 1.0f + hitCostFactor * coverage;
+}
+
+void TileScheduler::buildBatches() {
+    for (Tile& tile : tiles) {
+        tile.cost = estimateCost(tile);
+    }
+
+    std::vector<uint32_t> order(tiles.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(),
+                     [this](uint32_t a, uint32_t b) { return tiles[a].cost > tiles[b].cost; });
+
+    // Longest-processing-time first: each tile goes to the cheapest batch that still has room,
+    // so every frame of the pass gets a similar amount of work
+    uint32_t capacity = static_cast<uint32_t>((tiles.size() + batchCount - 1) / batchCount);
+    batches.assign(batchCount, {});
+    std::vector<float> batchCost(batchCount, 0.0f);
+
+    for (uint32_t index : order) {
+        uint32_t best = UINT32_MAX;
+        for (uint32_t b = 0; b < batchCount; b++) {
+            if (batches[b].size() < capacity && (best == UINT32_MAX || batchCost[b] < batchCost[best])) {
+                best = b;
+            }
+        }
+        batches[best].push_back(index);
+        batchCost[best] += tiles[index].cost;
+    }
+}
+
+const std::vector<TileScheduler::Tile>& TileScheduler::nextBatch() {
+    if (nextBatchIndex == 0 || batches.empty()) {
+        buildBatches();
+        nextBatchIndex = 0;
+    }
+
+    currentBatch.clear();
+    for (uint32_t index : batches[nextBatchIndex]) {
+        currentBatch.push_back(tiles[index]);
+        tiles[index].resetHistory = false;
+    }
+
+    nextBatchIndex = (nextBatchIndex + 1) % batchCount;
+    return currentBatch;
+}
+
+uint64_t TileScheduler::averagePixelsPerBatch() const {
+    return static_cast<uint64_t>(extent.width) * extent.height / batchCount;
+}
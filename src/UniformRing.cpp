@@ -0,0 +1,81 @@
+#include "UniformRing.h"
+#include "VulkanHelpers.h"
+#include "Logger.h"
+#include <stdexcept>
+#include <cstring>
+#include <algorithm>
+
+UniformRing::UniformRing(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t framesInFlight,
+                         VkDeviceSize bytesPerFrame)
+    : device(device), framesInFlight(framesInFlight) {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    alignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 16);
+    frameStride = alignUp(bytesPerFrame);
+
+    VulkanHelpers::createBuffer(device, physicalDevice, frameStride * framesInFlight,
+                                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                buffer, memory);
+
+    void* data = nullptr;
+    if (vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data) != VK_SUCCESS) {
+        throw std::runtime_error("failed to map uniform ring buffer!");
+    }
+    mapped = static_cast<uint8_t*>(data);
+
+    shadows.assign(framesInFlight, std::vector<uint8_t>());
+    written.assign(framesInFlight, std::vector<bool>());
+
+    LOG_INFO("✅ Uniform ring created: " << framesInFlight << " x " << frameStride
+             << " bytes (alignment " << alignment << ")");
+}
+
+UniformRing::~UniformRing() {
+    if (mapped) {
+        vkUnmapMemory(device, memory);
+    }
+    if (buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, buffer, nullptr);
+    }
+    if (memory != VK_NULL_HANDLE) {
+        vkFreeMemory(device, memory, nullptr);
+    }
+}
+
+UniformRing::BlockHandle UniformRing::allocateBlock(VkDeviceSize size) {
+    VkDeviceSize offset = persistentEnd;
+    if (offset + size > frameStride) {
+        throw std::runtime_error("uniform ring out of space for persistent block!");
+    }
+    persistentEnd = alignUp(offset + size);
+
+    blocks.push_back({offset, size});
+    for (uint32_t i = 0; i < framesInFlight; i++) {
+        shadows[i].resize(persistentEnd);
+        written[i].push_back(false);
+    }
+    return static_cast<BlockHandle>(blocks.size() - 1);
+}
+
+bool UniformRing::write(BlockHandle block, uint32_t frameIndex, const void* data, VkDeviceSize size) {
+    const Block& b = blocks[block];
+    if (size > b.size) {
+        throw std::runtime_error("uniform ring write larger than its block!");
+    }
+
+    // Dirty check against what this frame region already holds
+    uint8_t* shadow = shadows[frameIndex].data() + b.offset;
+    if (written[frameIndex][block] && std::memcmp(shadow, data, size) == 0) {
+        return false;
+    }
+
+    std::memcpy(shadow, data, size);
+    std::memcpy(mapped + frameIndex * frameStride + b.offset, data, size);
+    written[frameIndex][block] = true;
+    return true;
+}
+
+uint32_t UniformRing::dynamicOffset(BlockHandle block, uint32_t frameIndex) const {
+    return static_cast<uint32_t>(frameIndex * frameStride + blocks[block].offset);
+}
@@ -1,7 +1,7 @@
 #include "VulkanHelpers.h"
+#include "Logger.h"
 #include <fstream>
 #include <stdexcept>
-#include <iostream>
 #include <set>
 #include <algorithm>
 #include <cstring>
@@ -52,8 +52,13 @@ QueueFamilyIndices VulkanHelpers::findQueueFamilies(VkPhysicalDevice device, VkS
             indices.graphicsFamily = i;
         }
         
+        // Headless (no surface): nothing is presented, the graphics queue stands in
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+        if (surface != VK_NULL_HANDLE) {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+        } else {
+            presentSupport = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        }
         
         if (presentSupport) {
             indices.presentFamily = i;
@@ -288,7 +293,9 @@ bool VulkanHelpers::isDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surfa
     bool extensionsSupported = checkDeviceExtensionSupport(device, deviceExtensions);
     
     bool swapChainAdequate = false;
-    if (extensionsSupported) {
+    if (surface == VK_NULL_HANDLE) {
+        swapChainAdequate = true;  // Headless: no surface/present requirements
+    } else if (extensionsSupported) {
         SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device, surface);
         swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
     }
@@ -296,7 +303,17 @@ bool VulkanHelpers::isDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surfa
     VkPhysicalDeviceFeatures supportedFeatures;
     vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
     
-    return indices.isComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
+    // The frame loop is built on timeline semaphores
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    
+    VkPhysicalDeviceFeatures2 features2{};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = &timelineFeatures;
+    vkGetPhysicalDeviceFeatures2(device, &features2);
+    
+    return indices.isComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy &&
+           timelineFeatures.timelineSemaphore;
 }
 
 VKAPI_ATTR VkBool32 VKAPI_CALL VulkanHelpers::debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
@@ -350,30 +367,45 @@ VKAPI_ATTR VkBool32 VKAPI_CALL VulkanHelpers::debugCallback(VkDebugUtilsMessageS
         }
     }
     
-    // Special formatting for RT messages
-    if (isRayTracingRelated) {
-        std::cerr << "\033[1;35m🚀 RAY TRACING DEBUG\033[0m " << severityColor 
-                  << "[" << typeStr << "] " << resetColor;
-    } else {
-        std::cerr << severityColor << "[" << typeStr << "] " << resetColor;
+    // Validation output goes through the async logger as well (same severity mapping)
+    LogLevel level = LogLevel::Debug;
+    if (messageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
+        level = LogLevel::Error;
+    } else if (messageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) {
+        level = LogLevel::Warn;
+    } else if (messageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT) {
+        level = LogLevel::Info;
     }
     
-    std::cerr << pCallbackData->pMessage << std::endl;
+    if (!Logger::isEnabled(level)) {
+        return VK_FALSE;
+    }
+    
+    // Special formatting for RT messages
+    {
+        Logger::Line line(level);
+        if (isRayTracingRelated) {
+            line.stream() << "\033[1;35m🚀 RAY TRACING DEBUG\033[0m ";
+        }
+        line.stream() << severityColor << "[" << typeStr << "] " << resetColor << pCallbackData->pMessage;
+    }
     
     // Additional object debugging info for RT issues
     if (isRayTracingRelated && pCallbackData->objectCount > 0) {
-        std::cerr << "  📋 Objects involved:" << std::endl;
+        Logger::Line line(level);
+        line.stream() << "  📋 Objects involved:";
         for (uint32_t i = 0; i < pCallbackData->objectCount; i++) {
-            std::cerr << "    - " << pCallbackData->pObjects[i].pObjectName 
-                      << " (Handle: 0x" << std::hex << pCallbackData->pObjects[i].objectHandle 
-                      << std::dec << ")" << std::endl;
+            const char* objectName = pCallbackData->pObjects[i].pObjectName;
+            line.stream() << "\n    - " << (objectName ? objectName : "<unnamed>")
+                          << " (Handle: 0x" << std::hex << pCallbackData->pObjects[i].objectHandle 
+                          << std::dec << ")";
         }
     }
     
     // Break on critical RT errors for debugging
     #ifdef ENABLE_RAY_TRACING_DEBUG
     if (messageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT && isRayTracingRelated) {
-        std::cerr << "\033[1;31m💥 CRITICAL RAY TRACING ERROR - Consider breakpoint here\033[0m" << std::endl;
+        LOG_ERROR("\033[1;31m💥 CRITICAL RAY TRACING ERROR - Consider breakpoint here\033[0m");
     }
     #endif
     
@@ -2,14 +2,14 @@
 // This file contains the remaining pipeline implementations
 
 #include "ClippyRTXApp.h"
+#include "Logger.h"
 #include <array>
 #include <stdexcept>
 #include <cstring>
-#include <iostream>
 
 // Descriptor Set Layout Implementation
 void ClippyRTXApp::createDescriptorSetLayout() {
-    std::cout << "Creating descriptor set layout with TLAS support..." << std::endl;
+    LOG_INFO("Creating descriptor set layout with TLAS support...");
     
     std::vector<VkDescriptorSetLayoutBinding> bindings;
     
@@ -40,16 +40,25 @@ void ClippyRTXApp::createDescriptorSetLayout() {
     accumulationLayoutBinding.stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR;
     bindings.push_back(accumulationLayoutBinding);
     
-    // Binding 3: Camera uniform buffer (MOVED from binding 0)
+    // Binding 3: Camera uniform buffer (MOVED from binding 0) - dynamic offset into the uniform ring
     VkDescriptorSetLayoutBinding uboLayoutBinding{};
     uboLayoutBinding.binding = 3;
     uboLayoutBinding.descriptorCount = 1;
-    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     uboLayoutBinding.pImmutableSamplers = nullptr;
     uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | 
                                  VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
     bindings.push_back(uboLayoutBinding);
     
+    // Binding 4: Per-instance shading data, indexed by gl_InstanceCustomIndexEXT
+    VkDescriptorSetLayoutBinding instanceLayoutBinding{};
+    instanceLayoutBinding.binding = 4;
+    instanceLayoutBinding.descriptorCount = 1;
+    instanceLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    instanceLayoutBinding.pImmutableSamplers = nullptr;
+    instanceLayoutBinding.stageFlags = VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR;
+    bindings.push_back(instanceLayoutBinding);
+    
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
@@ -59,11 +68,12 @@ void ClippyRTXApp::createDescriptorSetLayout() {
         throw std::runtime_error("failed to create descriptor set layout!");
     }
     
-    std::cout << "✅ Descriptor set layout created with " << bindings.size() << " bindings:" << std::endl;
-    std::cout << "   - Binding 0: TLAS (acceleration structure)" << std::endl;
-    std::cout << "   - Binding 1: Ray tracing output image" << std::endl;
-    std::cout << "   - Binding 2: Accumulation buffer" << std::endl;
-    std::cout << "   - Binding 3: Camera uniform buffer" << std::endl;
+    LOG_INFO("✅ Descriptor set layout created with " << bindings.size() << " bindings:");
+    LOG_INFO("   - Binding 0: TLAS (acceleration structure)");
+    LOG_INFO("   - Binding 1: Ray tracing output image");
+    LOG_INFO("   - Binding 2: Accumulation buffer");
+    LOG_INFO("   - Binding 3: Camera uniform buffer");
+    LOG_INFO("   - Binding 4: Instance shading buffer");
 }
 
 // Graphics Pipeline Implementation
@@ -193,7 +203,7 @@ void ClippyRTXApp::createGraphicsPipeline() {
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
     
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+    if (vkCreateGraphicsPipelines(device, pipelineCache->get(), 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
         throw std::runtime_error("failed to create graphics pipeline!");
     }
     
@@ -286,13 +296,12 @@ void ClippyRTXApp::createUIFramebuffers() {
         }
     }
     
-    std::cout << "UI overlay framebuffers created (preserves RTX content)" << std::endl;
+    LOG_INFO("UI overlay framebuffers created (preserves RTX content)");
 }
 
-// Vertex Buffer Implementation
-void ClippyRTXApp::createVertexBuffer() {
-    VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-    
+// Uploads data through a staging buffer into a new device-local buffer (TRANSFER_DST is added)
+void ClippyRTXApp::createDeviceLocalBuffer(const void* contents, VkDeviceSize bufferSize, VkBufferUsageFlags usage,
+                                           VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
     VkBuffer stagingBuffer;
     VkDeviceMemory stagingBufferMemory;
     VulkanHelpers::createBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
@@ -301,110 +310,110 @@ void ClippyRTXApp::createVertexBuffer() {
     
     void* data;
     vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, vertices.data(), (size_t) bufferSize);
+    memcpy(data, contents, (size_t) bufferSize);
     vkUnmapMemory(device, stagingBufferMemory);
     
     VulkanHelpers::createBuffer(device, physicalDevice, bufferSize, 
-                               VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, 
-                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
+                               VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, 
+                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, bufferMemory);
     
-    VulkanHelpers::copyBuffer(device, commandPool, graphicsQueue, stagingBuffer, vertexBuffer, bufferSize);
+    VulkanHelpers::copyBuffer(device, commandPool, graphicsQueue, stagingBuffer, buffer, bufferSize);
     
     vkDestroyBuffer(device, stagingBuffer, nullptr);
     vkFreeMemory(device, stagingBufferMemory, nullptr);
 }
 
+// Vertex Buffer Implementation
+void ClippyRTXApp::createVertexBuffer() {
+    createDeviceLocalBuffer(vertices.data(), sizeof(vertices[0]) * vertices.size(),
+                            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                            vertexBuffer, vertexBufferMemory);
+}
+
 // Index Buffer Implementation
 void ClippyRTXApp::createIndexBuffer() {
-    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-    
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    VulkanHelpers::createBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-                               stagingBuffer, stagingBufferMemory);
-    
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, indices.data(), (size_t) bufferSize);
-    vkUnmapMemory(device, stagingBufferMemory);
-    
-    VulkanHelpers::createBuffer(device, physicalDevice, bufferSize, 
-                               VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, 
-                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
-    
-    VulkanHelpers::copyBuffer(device, commandPool, graphicsQueue, stagingBuffer, indexBuffer, bufferSize);
-    
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+    createDeviceLocalBuffer(indices.data(), sizeof(indices[0]) * indices.size(),
+                            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                            indexBuffer, indexBufferMemory);
+}
+
+// Per-part geometry for the ray tracing BLASes (indices relative to each part)
+void ClippyRTXApp::createPartBuffers() {
+    createDeviceLocalBuffer(partVertices.data(), sizeof(partVertices[0]) * partVertices.size(),
+                            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+                            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
+                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,   // Read by the deformation pass
+                            partVertexBuffer, partVertexBufferMemory);
+    createDeviceLocalBuffer(partIndices.data(), sizeof(partIndices[0]) * partIndices.size(),
+                            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+                            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
+                            partIndexBuffer, partIndexBufferMemory);
 }
 
 // Uniform Buffers Implementation
 void ClippyRTXApp::createUniformBuffers() {
-    VkDeviceSize bufferSize = sizeof(UniformBufferObject);
-    
-    uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-    
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        VulkanHelpers::createBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
-                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-                                   uniformBuffers[i], uniformBuffersMemory[i]);
-    }
+    // One persistently mapped ring for every pass; the scene UBO is its first block
+    uniformRing = std::make_unique<UniformRing>(device, physicalDevice, framesInFlight);
+    sceneUniformBlock = uniformRing->allocateBlock(sizeof(UniformBufferObject));
 }
 
 // Descriptor Pool Implementation
 void ClippyRTXApp::createDescriptorPool() {
-    std::cout << "Creating descriptor pool with RTX support..." << std::endl;
+    LOG_INFO("Creating descriptor pool with RTX support...");
     
-    std::array<VkDescriptorPoolSize, 3> poolSizes{};
+    std::array<VkDescriptorPoolSize, 4> poolSizes{};
     
     // Acceleration structure (TLAS) - binding 0
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
-    poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    poolSizes[0].descriptorCount = framesInFlight;
     
     // Storage images (bindings 1 and 2) - output and accumulation
     poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT * 2);  // 2 images per frame
+    poolSizes[1].descriptorCount = framesInFlight * 2;  // 2 images per frame
+    
+    // Uniform buffer (binding 3) - camera data, addressed with a dynamic offset into the ring
+    poolSizes[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    poolSizes[2].descriptorCount = framesInFlight;
     
-    // Uniform buffer (binding 3) - camera data
-    poolSizes[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSizes[2].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    // Storage buffer (binding 4) - per-instance shading data
+    poolSizes[3].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[3].descriptorCount = framesInFlight;
     
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
     poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    poolInfo.maxSets = framesInFlight;
     
     if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
         throw std::runtime_error("failed to create descriptor pool!");
     }
     
-    std::cout << "✅ Descriptor pool created with:" << std::endl;
-    std::cout << "   - " << poolSizes[0].descriptorCount << " acceleration structures" << std::endl;
-    std::cout << "   - " << poolSizes[1].descriptorCount << " storage images" << std::endl;
-    std::cout << "   - " << poolSizes[2].descriptorCount << " uniform buffers" << std::endl;
+    LOG_INFO("✅ Descriptor pool created with:");
+    LOG_INFO("   - " << poolSizes[0].descriptorCount << " acceleration structures");
+    LOG_INFO("   - " << poolSizes[1].descriptorCount << " storage images");
+    LOG_INFO("   - " << poolSizes[2].descriptorCount << " uniform buffers");
+    LOG_INFO("   - " << poolSizes[3].descriptorCount << " storage buffers");
 }
 
 // Descriptor Sets Implementation
 void ClippyRTXApp::createDescriptorSets() {
-    std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
+    std::vector<VkDescriptorSetLayout> layouts(framesInFlight, descriptorSetLayout);
     VkDescriptorSetAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = descriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+    allocInfo.descriptorSetCount = framesInFlight;
     allocInfo.pSetLayouts = layouts.data();
     
-    descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+    descriptorSets.resize(framesInFlight);
     if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate descriptor sets!");
     }
     
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    for (size_t i = 0; i < framesInFlight; i++) {
         VkDescriptorBufferInfo bufferInfo{};
-        bufferInfo.buffer = uniformBuffers[i];
-        bufferInfo.offset = 0;
+        bufferInfo.buffer = uniformRing->getBuffer();
+        bufferInfo.offset = 0;  // Frame/block offset supplied at bind time
         bufferInfo.range = sizeof(UniformBufferObject);
         
         std::array<VkWriteDescriptorSet, 1> descriptorWrites{};
@@ -414,32 +423,32 @@ void ClippyRTXApp::createDescriptorSets() {
         descriptorWrites[0].dstSet = descriptorSets[i];
         descriptorWrites[0].dstBinding = 3;  // Changed from 0 to 3 for ray tracing
         descriptorWrites[0].dstArrayElement = 0;
-        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         descriptorWrites[0].descriptorCount = 1;
         descriptorWrites[0].pBufferInfo = &bufferInfo;
         
         vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
     }
     
-    std::cout << "✅ Descriptor sets created (uniform buffer only - TLAS will be added later)" << std::endl;
+    LOG_INFO("✅ Descriptor sets created (uniform buffer only - TLAS will be added later)");
 }
 
 // Update Descriptor Sets with TLAS and Storage Images for Ray Tracing
 void ClippyRTXApp::updateDescriptorSetsWithTLAS() {
     if (!rayTracingPipeline) {
-        std::cout << "❌ Cannot update descriptor sets - no ray tracing pipeline" << std::endl;
+        LOG_ERROR("❌ Cannot update descriptor sets - no ray tracing pipeline");
         return;
     }
     
-    std::cout << "Updating descriptor sets with TLAS and storage images..." << std::endl;
+    LOG_INFO("Updating descriptor sets with TLAS and storage images...");
     VkAccelerationStructureKHR tlas = rayTracingPipeline->getTopLevelAS();
     
     if (tlas == VK_NULL_HANDLE) {
-        std::cout << "❌ TLAS is null - cannot bind to descriptor set" << std::endl;
+        LOG_ERROR("❌ TLAS is null - cannot bind to descriptor set");
         return;
     }
     
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    for (size_t i = 0; i < framesInFlight; i++) {
         std::vector<VkWriteDescriptorSet> descriptorWrites;
         
         // Binding 0: TLAS (Acceleration Structure)
@@ -490,55 +499,119 @@ void ClippyRTXApp::updateDescriptorSetsWithTLAS() {
         rtAccumWrite.pImageInfo = &rtAccumImageInfo;
         descriptorWrites.push_back(rtAccumWrite);
         
+        // Binding 4: Instance shading (Storage Buffer)
+        VkDescriptorBufferInfo instanceShadingInfo{};
+        instanceShadingInfo.buffer = rayTracingPipeline->getInstanceShadingBuffer();
+        instanceShadingInfo.offset = 0;
+        instanceShadingInfo.range = VK_WHOLE_SIZE;
+        
+        VkWriteDescriptorSet instanceShadingWrite{};
+        instanceShadingWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        instanceShadingWrite.dstSet = descriptorSets[i];
+        instanceShadingWrite.dstBinding = 4;
+        instanceShadingWrite.dstArrayElement = 0;
+        instanceShadingWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        instanceShadingWrite.descriptorCount = 1;
+        instanceShadingWrite.pBufferInfo = &instanceShadingInfo;
+        descriptorWrites.push_back(instanceShadingWrite);
+        
         // Update all descriptor sets at once
         vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), 
                               descriptorWrites.data(), 0, nullptr);
     }
     
-    std::cout << "✅ Descriptor sets updated with complete RTX bindings for " << MAX_FRAMES_IN_FLIGHT << " frames:" << std::endl;
-    std::cout << "   - Binding 0: TLAS (acceleration structure)" << std::endl;
-    std::cout << "   - Binding 1: RT output image (" << swapChainExtent.width << "x" << swapChainExtent.height << ")" << std::endl;
-    std::cout << "   - Binding 2: Accumulation image (" << swapChainExtent.width << "x" << swapChainExtent.height << ")" << std::endl;
-    std::cout << "   - Binding 3: Uniform buffer (already bound)" << std::endl;
+    LOG_INFO("✅ Descriptor sets updated with complete RTX bindings for " << framesInFlight << " frames:");
+    LOG_INFO("   - Binding 0: TLAS (acceleration structure)");
+    LOG_INFO("   - Binding 1: RT output image (" << swapChainExtent.width << "x" << swapChainExtent.height << ")");
+    LOG_INFO("   - Binding 2: Accumulation image (" << swapChainExtent.width << "x" << swapChainExtent.height << ")");
+    LOG_INFO("   - Binding 3: Uniform buffer (already bound)");
+    LOG_INFO("   - Binding 4: Instance shading (" << rayTracingPipeline->getInstanceCount() << " instances)");
 }
 
 // Command Buffers Implementation
 void ClippyRTXApp::createCommandBuffers() {
-    commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    QueueFamilyIndices queueFamilyIndices = VulkanHelpers::findQueueFamilies(physicalDevice, surface);
     
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.commandPool = commandPool;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = (uint32_t) commandBuffers.size();
+    frameCommandPools.resize(framesInFlight);
+    commandBuffers.resize(framesInFlight);
     
-    if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate command buffers!");
+    // TRANSIENT: the buffers are re-recorded every frame, the whole pool is reset at once
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+    
+    for (size_t i = 0; i < framesInFlight; i++) {
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &frameCommandPools[i]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create per-frame command pool!");
+        }
+        
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = frameCommandPools[i];
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+        
+        if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffers[i]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate command buffers!");
+        }
     }
 }
 
 // Synchronization Objects Implementation
 void ClippyRTXApp::createSyncObjects() {
-    imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-    imagesInFlight.resize(swapChainImages.size(), VK_NULL_HANDLE);
+    imageAvailableSemaphores.resize(framesInFlight);
+    frameSlotTimelineValues.assign(framesInFlight, 0);
     
     VkSemaphoreCreateInfo semaphoreInfo{};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
     
-    VkFenceCreateInfo fenceInfo{};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-    
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
-            
+    for (size_t i = 0; i < framesInFlight; i++) {
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS) {
             throw std::runtime_error("failed to create synchronization objects for a frame!");
         }
     }
+    
+    // One timeline semaphore replaces the per-frame fences
+    VkSemaphoreTypeCreateInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineInfo.initialValue = 0;
+    
+    VkSemaphoreCreateInfo timelineSemaphoreInfo{};
+    timelineSemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    timelineSemaphoreInfo.pNext = &timelineInfo;
+    
+    if (vkCreateSemaphore(device, &timelineSemaphoreInfo, nullptr, &frameTimeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create frame timeline semaphore!");
+    }
+    frameTimelineValue = 0;
+    
+    createPresentSemaphores();
+    
+    gpuWatchdog = std::make_unique<GpuWatchdog>(device, frameTimeline);
+    
+    QueueFamilyIndices queueFamilyIndices = VulkanHelpers::findQueueFamilies(physicalDevice, surface);
+    gpuProfiler = std::make_unique<GpuProfiler>(device, physicalDevice, queueFamilyIndices.graphicsFamily.value(),
+                                                framesInFlight);
+}
+
+// Present semaphores are indexed by swapchain image: a binary semaphore handed to
+// vkQueuePresentKHR can only be reused once that image has been acquired again
+void ClippyRTXApp::createPresentSemaphores() {
+    for (VkSemaphore semaphore : renderFinishedSemaphores) {
+        vkDestroySemaphore(device, semaphore, nullptr);
+    }
+    renderFinishedSemaphores.assign(swapChainImages.size(), VK_NULL_HANDLE);
+    
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    
+    for (size_t i = 0; i < renderFinishedSemaphores.size(); i++) {
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create present semaphores!");
+        }
+    }
 }
 
 // Swapchain Recreation Implementation
@@ -561,15 +634,24 @@ void ClippyRTXApp::recreateSwapChain() {
     createRayTracingStorageImages();  // Recreate RT storage images with new size
     createFramebuffers();
     
+    // The image count may change with the new swapchain
+    createPresentSemaphores();
+    
     // Update descriptor sets with new storage images
     if (rayTracingPipeline) {
         updateDescriptorSetsWithTLAS();
     }
+    
+    // Upload buffers are sized for the extent
+    if (cpuPathTracer) {
+        destroyCpuTraceUploadBuffers();
+        createCpuTraceUploadBuffers();
+    }
 }
 
 // Ray Tracing Storage Images Implementation
 void ClippyRTXApp::createRayTracingStorageImages() {
-    std::cout << "Creating ray tracing storage images..." << std::endl;
+    LOG_INFO("Creating ray tracing storage images...");
     
     // Create RT output image (for final ray traced result)
     VulkanHelpers::createImage(
@@ -603,9 +685,49 @@ void ClippyRTXApp::createRayTracingStorageImages() {
         device, rtAccumulationImage, VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 1
     );
     
-    std::cout << "✅ Ray tracing storage images created:" << std::endl;
-    std::cout << "   - RT Output: " << swapChainExtent.width << "x" << swapChainExtent.height << " RGBA8" << std::endl;
-    std::cout << "   - Accumulation: " << swapChainExtent.width << "x" << swapChainExtent.height << " RGBA32F" << std::endl;
+    // New images start UNDEFINED: the next RTX frame moves them to GENERAL and restarts accumulation
+    rtStorageImagesNeedInit = true;
+    
+    LOG_INFO("✅ Ray tracing storage images created:");
+    LOG_INFO("   - RT Output: " << swapChainExtent.width << "x" << swapChainExtent.height << " RGBA8");
+    LOG_INFO("   - Accumulation: " << swapChainExtent.width << "x" << swapChainExtent.height << " RGBA32F");
+}
+
+// Storage images stay in GENERAL across frames. The accumulation image is read back by the next
+// frame's raygen, so its writes must be made visible before tracing again.
+void ClippyRTXApp::prepareRTStorageImages(VkCommandBuffer commandBuffer) {
+    VkImageMemoryBarrier barriers[2]{};
+    uint32_t barrierCount = 0;
+    
+    auto addBarrier = [&](VkImage image, VkImageLayout oldLayout, VkAccessFlags srcAccess) {
+        VkImageMemoryBarrier& barrier = barriers[barrierCount++];
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+    };
+    
+    VkPipelineStageFlags srcStage = VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
+    if (rtStorageImagesNeedInit) {
+        addBarrier(rtOutputImage, VK_IMAGE_LAYOUT_UNDEFINED, 0);
+        addBarrier(rtAccumulationImage, VK_IMAGE_LAYOUT_UNDEFINED, 0);
+        srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        rtStorageImagesNeedInit = false;
+    } else {
+        addBarrier(rtAccumulationImage, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_WRITE_BIT);
+    }
+    
+    vkCmdPipelineBarrier(commandBuffer, srcStage, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+                        0, 0, nullptr, 0, nullptr, barrierCount, barriers);
 }
 
 // Swapchain Cleanup Implementation
@@ -668,12 +790,16 @@ void ClippyRTXApp::cleanupSwapChain() {
         vkDestroyImageView(device, imageView, nullptr);
     }
     
-    vkDestroySwapchainKHR(device, swapChain, nullptr);
+    // Headless images belong to headlessTarget
+    if (swapChain != VK_NULL_HANDLE) {
+        vkDestroySwapchainKHR(device, swapChain, nullptr);
+        swapChain = VK_NULL_HANDLE;
+    }
 }
 
 // Copy RT Output Image to Swapchain for Display (WORKING VERSION!)
 void ClippyRTXApp::copyRTOutputToSwapchain(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
-    std::cout << "🖼️ Copying RT output to swapchain image " << imageIndex << std::endl;
+    LOG_TRACE("🖼️ Copying RT output to swapchain image " << imageIndex);
     
     // Transition RT output image to transfer src layout
     VkImageMemoryBarrier rtImageBarrier{};
@@ -740,7 +866,7 @@ void ClippyRTXApp::copyRTOutputToSwapchain(VkCommandBuffer commandBuffer, uint32
     VkImageMemoryBarrier presentBarrier{};
     presentBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     presentBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    presentBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    presentBarrier.newLayout = outputFinalLayout;
     presentBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
     presentBarrier.dstAccessMask = 0;
     presentBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
@@ -774,6 +900,82 @@ void ClippyRTXApp::copyRTOutputToSwapchain(VkCommandBuffer commandBuffer, uint32
                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
                         0, 0, nullptr, 0, nullptr, 2, finalBarriers);
     
-    std::cout << "✅ RT output copied to swapchain - ready for display!" << std::endl;
+    LOG_TRACE("✅ RT output copied to swapchain - ready for display!");
 }
 
+// CPU fallback: one host-visible staging buffer per frame in flight, mapped for the whole run
+void ClippyRTXApp::createCpuTraceUploadBuffers() {
+    VkDeviceSize size = static_cast<VkDeviceSize>(swapChainExtent.width) * swapChainExtent.height * 4;
+    
+    cpuTraceUploadBuffers.assign(framesInFlight, VK_NULL_HANDLE);
+    cpuTraceUploadMemories.assign(framesInFlight, VK_NULL_HANDLE);
+    cpuTraceUploadMapped.assign(framesInFlight, nullptr);
+    
+    for (uint32_t i = 0; i < framesInFlight; i++) {
+        VulkanHelpers::createBuffer(device, physicalDevice, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                    cpuTraceUploadBuffers[i], cpuTraceUploadMemories[i]);
+        if (vkMapMemory(device, cpuTraceUploadMemories[i], 0, size, 0, &cpuTraceUploadMapped[i]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to map CPU trace upload buffer!");
+        }
+    }
+    
+    LOG_INFO("✅ CPU trace upload buffers created: " << framesInFlight << " x "
+             << swapChainExtent.width << "x" << swapChainExtent.height << " RGBA8");
+}
+
+void ClippyRTXApp::destroyCpuTraceUploadBuffers() {
+    for (size_t i = 0; i < cpuTraceUploadBuffers.size(); i++) {
+        vkUnmapMemory(device, cpuTraceUploadMemories[i]);
+        vkDestroyBuffer(device, cpuTraceUploadBuffers[i], nullptr);
+        vkFreeMemory(device, cpuTraceUploadMemories[i], nullptr);
+    }
+    cpuTraceUploadBuffers.clear();
+    cpuTraceUploadMemories.clear();
+    cpuTraceUploadMapped.clear();
+}
+
+// Copies this slot's CPU traced frame into the output image, which ends in outputFinalLayout
+// like the RTX copy. The pixels are already in the output's channel order (ubo.isBGRFormat).
+void ClippyRTXApp::recordCpuTraceUpload(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = swapChainImages[imageIndex];
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    
+    // Host writes before the submit are visible to the transfer without a host barrier
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                        0, 0, nullptr, 0, nullptr, 1, &barrier);
+    
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;     // Tightly packed
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {swapChainExtent.width, swapChainExtent.height, 1};
+    
+    vkCmdCopyBufferToImage(commandBuffer, cpuTraceUploadBuffers[currentFrame], swapChainImages[imageIndex],
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = outputFinalLayout;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
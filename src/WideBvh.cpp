@@ -0,0 +1,631 @@
+#include "WideBvh.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define WIDE_BVH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define WIDE_BVH_TARGET_AVX2
+#else
+// Only the 8-wide kernel is compiled for AVX2; everything else keeps the baseline target
+#define WIDE_BVH_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#else
+#define WIDE_BVH_X86 0
+#endif
+
+static bool cpuHasAvx2() {
+#if WIDE_BVH_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    if (!osxsave || !fma || (_xgetbv(0) & 0x6) != 0x6) return false;   // OS must save the YMM state
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+#else
+    return false;
+#endif
+}
+
+static uint32_t lowestLane(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long lane;
+    _BitScanForward(&lane, mask);
+    return static_cast<uint32_t>(lane);
+#else
+    return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+}
+
+static float surfaceArea(const Bvh::Node& node) {
+    glm::vec3 extent = node.boundsMax - node.boundsMin;
+    return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+WideBvh::Isa WideBvh::detectIsa() {
+    if (isSupported(Isa::Avx2)) return Isa::Avx2;
+    if (isSupported(Isa::Sse)) return Isa::Sse;
+    return Isa::Scalar;
+}
+
+bool WideBvh::isSupported(Isa isa) {
+    switch (isa) {
+        case Isa::Sse: return WIDE_BVH_X86 == 1;   // SSE2 is part of x86-64
+        case Isa::Avx2: return cpuHasAvx2();
+        default: return true;
+    }
+}
+
+const char* WideBvh::isaName(Isa isa) {
+    switch (isa) {
+        case Isa::Sse: return "sse";
+        case Isa::Avx2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+uint32_t WideBvh::laneCount(Isa isa) {
+    switch (isa) {
+        case Isa::Sse: return 4;
+        case Isa::Avx2: return 8;
+        default: return 1;
+    }
+}
+
+void WideBvh::build(const Bvh& bvh, Isa buildIsa) {
+    if (!isSupported(buildIsa)) {
+        throw std::runtime_error(std::string("failed to build wide BVH: ") + isaName(buildIsa) + " is not supported!");
+    }
+
+    isa = buildIsa;
+    source = &bvh;
+    nodes4.clear();
+    packets4.clear();
+    nodes8.clear();
+    packets8.clear();
+    if (bvh.getTriangles().empty()) return;
+
+    if (isa == Isa::Sse) {
+        collapse<4>(0, nodes4, packets4);
+    } else if (isa == Isa::Avx2) {
+        collapse<8>(0, nodes8, packets8);
+    }
+}
+
+size_t WideBvh::getNodeCount() const {
+    switch (isa) {
+        case Isa::Sse: return nodes4.size();
+        case Isa::Avx2: return nodes8.size();
+        default: return source ? source->getNodes().size() : 0;
+    }
+}
+
+size_t WideBvh::getPacketCount() const {
+    return isa == Isa::Sse ? packets4.size() : packets8.size();
+}
+
+template <int W, typename NodeVector, typename PacketVector>
+uint32_t WideBvh::collapse(uint32_t binaryNode, NodeVector& nodes, PacketVector& packets) const {
+    const auto& binary = source->getNodes();
+
+    // Gather up to W children by opening the largest interior one, so the big boxes that most
+    // rays enter are the ones flattened into this node
+    uint32_t children[W];
+    uint32_t childCount = 0;
+    if (binary[binaryNode].isLeaf()) {
+        children[childCount++] = binaryNode;   // Single-leaf tree
+    } else {
+        children[childCount++] = binary[binaryNode].leftOrFirst;
+        children[childCount++] = binary[binaryNode].leftOrFirst + 1;
+    }
+    while (childCount < static_cast<uint32_t>(W)) {
+        int largest = -1;
+        float largestArea = -1.0f;
+        for (uint32_t i = 0; i < childCount; i++) {
+            const Bvh::Node& child = binary[children[i]];
+            if (!child.isLeaf() && surfaceArea(child) > largestArea) {
+                largest = static_cast<int>(i);
+                largestArea = surfaceArea(child);
+            }
+        }
+        if (largest < 0) break;
+
+        uint32_t opened = children[largest];
+        children[largest] = binary[opened].leftOrFirst;
+        children[childCount++] = binary[opened].leftOrFirst + 1;
+    }
+
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+
+    Node<W> node;
+    for (int lane = 0; lane < W; lane++) {
+        node.minX[lane] = node.minY[lane] = node.minZ[lane] = std::numeric_limits<float>::infinity();
+        node.maxX[lane] = node.maxY[lane] = node.maxZ[lane] = -std::numeric_limits<float>::infinity();
+        node.child[lane] = EMPTY;
+        node.packetCount[lane] = 0;
+    }
+
+    const auto& order = source->getTriangleOrder();
+    const auto& triangles = source->getTriangles();
+    for (uint32_t lane = 0; lane < childCount; lane++) {
+        const Bvh::Node& child = binary[children[lane]];
+        node.minX[lane] = child.boundsMin.x;
+        node.minY[lane] = child.boundsMin.y;
+        node.minZ[lane] = child.boundsMin.z;
+        node.maxX[lane] = child.boundsMax.x;
+        node.maxY[lane] = child.boundsMax.y;
+        node.maxZ[lane] = child.boundsMax.z;
+
+        if (!child.isLeaf()) {
+            node.child[lane] = collapse<W>(children[lane], nodes, packets);
+            continue;
+        }
+
+        // Leaf: its triangles as v0 / edge packets, padding lanes left zero-area
+        node.child[lane] = static_cast<uint32_t>(packets.size());
+        for (uint32_t first = 0; first < child.count; first += W) {
+            TrianglePacket<W> packet{};
+            for (int i = 0; i < W; i++) {
+                packet.triangle[i] = EMPTY;
+                if (first + i >= child.count) continue;
+
+                uint32_t triangle = order[child.leftOrFirst + first + i];
+                const Bvh::Triangle& t = triangles[triangle];
+                glm::vec3 e1 = t.v1 - t.v0;
+                glm::vec3 e2 = t.v2 - t.v0;
+                packet.v0x[i] = t.v0.x; packet.v0y[i] = t.v0.y; packet.v0z[i] = t.v0.z;
+                packet.e1x[i] = e1.x;   packet.e1y[i] = e1.y;   packet.e1z[i] = e1.z;
+                packet.e2x[i] = e2.x;   packet.e2y[i] = e2.y;   packet.e2z[i] = e2.z;
+                packet.triangle[i] = triangle;
+            }
+            packets.push_back(packet);
+            node.packetCount[lane]++;
+        }
+    }
+
+    nodes[index] = node;
+    return index;
+}
+
+bool WideBvh::intersect(const Bvh::Ray& ray, Bvh::Hit& hit) const {
+    switch (isa) {
+        case Isa::Sse: return intersect4(ray, hit);
+        case Isa::Avx2: return intersect8(ray, hit);
+        default: return source && source->intersect(ray, hit);
+    }
+}
+
+#if WIDE_BVH_X86
+
+// Möller-Trumbore against the 4 triangles of a packet; updates hit when one is closer
+static bool intersectPacket4(const float* packet, const uint32_t* packetTriangles,
+                             __m128 ox, __m128 oy, __m128 oz, __m128 dx, __m128 dy, __m128 dz,
+                             float& closest, Bvh::Hit& hit) {
+    const __m128 v0x = _mm_load_ps(packet + 0),  v0y = _mm_load_ps(packet + 4),  v0z = _mm_load_ps(packet + 8);
+    const __m128 e1x = _mm_load_ps(packet + 12), e1y = _mm_load_ps(packet + 16), e1z = _mm_load_ps(packet + 20);
+    const __m128 e2x = _mm_load_ps(packet + 24), e2y = _mm_load_ps(packet + 28), e2z = _mm_load_ps(packet + 32);
+
+    // p = cross(d, e2), det = dot(e1, p)
+    __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+    __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+    __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+    __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+    __m128 absDet = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+    __m128 valid = _mm_cmpge_ps(absDet, _mm_set1_ps(1e-12f));
+    __m128 inverseDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+    __m128 sx = _mm_sub_ps(ox, v0x), sy = _mm_sub_ps(oy, v0y), sz = _mm_sub_ps(oz, v0z);
+    __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverseDet);
+
+    // q = cross(s, e1)
+    __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+    __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+    __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+    __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inverseDet);
+    __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverseDet);
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+    valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+    valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpgt_ps(t, zero), _mm_cmplt_ps(t, _mm_set1_ps(closest))));
+
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(valid));
+    if (mask == 0) return false;
+
+    alignas(16) float tLanes[4], uLanes[4], vLanes[4];
+    _mm_store_ps(tLanes, t);
+    _mm_store_ps(uLanes, u);
+    _mm_store_ps(vLanes, v);
+    while (mask) {
+        uint32_t lane = lowestLane(mask);
+        mask &= mask - 1;
+        if (tLanes[lane] < closest) {
+            closest = tLanes[lane];
+            hit.t = tLanes[lane];
+            hit.u = uLanes[lane];
+            hit.v = vLanes[lane];
+            hit.triangle = packetTriangles[lane];
+        }
+    }
+    return true;
+}
+
+bool WideBvh::intersect4(const Bvh::Ray& ray, Bvh::Hit& hit) const {
+    if (nodes4.empty()) return false;
+    const uint32_t W = 4;
+
+    // Near and far plane of every axis, picked once from the direction signs (float offsets
+    // into Node<4>): the slab test needs no min/max and rejects the inverted empty lanes
+    glm::vec3 inverseDirection = 1.0f / ray.direction;
+    uint32_t nearX = inverseDirection.x >= 0.0f ? 0 : 3 * W;
+    uint32_t nearY = (inverseDirection.y >= 0.0f ? 0 : 3 * W) + W;
+    uint32_t nearZ = (inverseDirection.z >= 0.0f ? 0 : 3 * W) + 2 * W;
+    uint32_t farX = inverseDirection.x >= 0.0f ? 3 * W : 0;
+    uint32_t farY = (inverseDirection.y >= 0.0f ? 3 * W : 0) + W;
+    uint32_t farZ = (inverseDirection.z >= 0.0f ? 3 * W : 0) + 2 * W;
+
+    const __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+    const __m128 dx = _mm_set1_ps(ray.direction.x), dy = _mm_set1_ps(ray.direction.y), dz = _mm_set1_ps(ray.direction.z);
+    const __m128 idx = _mm_set1_ps(inverseDirection.x);
+    const __m128 idy = _mm_set1_ps(inverseDirection.y);
+    const __m128 idz = _mm_set1_ps(inverseDirection.z);
+
+    float closest = std::min(ray.tMax, hit.t);
+    bool found = false;
+
+    uint32_t stack[STACK_SIZE];
+    float stackNear[STACK_SIZE];
+    uint32_t stackSize = 0;
+    stack[stackSize] = 0;
+    stackNear[stackSize++] = 0.0f;
+
+    while (stackSize > 0) {
+        stackSize--;
+        if (stackNear[stackSize] > closest) continue;   // A closer hit was found since the push
+        const Node<4>& node = nodes4[stack[stackSize]];
+        const float* planes = node.minX;
+
+        __m128 tNearX = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(planes + nearX), ox), idx);
+        __m128 tNearY = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(planes + nearY), oy), idy);
+        __m128 tNearZ = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(planes + nearZ), oz), idz);
+        __m128 tFarX = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(planes + farX), ox), idx);
+        __m128 tFarY = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(planes + farY), oy), idy);
+        __m128 tFarZ = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(planes + farZ), oz), idz);
+        __m128 tNear = _mm_max_ps(_mm_max_ps(tNearX, tNearY), _mm_max_ps(tNearZ, _mm_setzero_ps()));
+        __m128 tFar = _mm_min_ps(_mm_min_ps(tFarX, tFarY), _mm_min_ps(tFarZ, _mm_set1_ps(closest)));
+
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tNear, tFar)));
+        if (mask == 0) continue;
+
+        alignas(16) float nearT[4];
+        _mm_store_ps(nearT, tNear);
+
+        // Leaves are tested right away; interior children are pushed farthest first
+        uint32_t interior[4];
+        float interiorNear[4];
+        uint32_t interiorCount = 0;
+        while (mask) {
+            uint32_t lane = lowestLane(mask);
+            mask &= mask - 1;
+
+            if (node.packetCount[lane] > 0) {
+                for (uint32_t p = node.child[lane]; p < node.child[lane] + node.packetCount[lane]; p++) {
+                    const TrianglePacket<4>& packet = packets4[p];
+                    found |= intersectPacket4(packet.v0x, packet.triangle, ox, oy, oz, dx, dy, dz, closest, hit);
+                }
+                continue;
+            }
+
+            uint32_t i = interiorCount++;
+            while (i > 0 && interiorNear[i - 1] < nearT[lane]) {
+                interior[i] = interior[i - 1];
+                interiorNear[i] = interiorNear[i - 1];
+                i--;
+            }
+            interior[i] = node.child[lane];
+            interiorNear[i] = nearT[lane];
+        }
+
+        for (uint32_t i = 0; i < interiorCount; i++) {
+            stack[stackSize] = interior[i];
+            stackNear[stackSize++] = interiorNear[i];
+        }
+    }
+    return found;
+}
+
+WIDE_BVH_TARGET_AVX2
+static bool intersectPacket8(const float* packet, const uint32_t* packetTriangles,
+                             __m256 ox, __m256 oy, __m256 oz, __m256 dx, __m256 dy, __m256 dz,
+                             float& closest, Bvh::Hit& hit) {
+    const __m256 v0x = _mm256_load_ps(packet + 0),  v0y = _mm256_load_ps(packet + 8),  v0z = _mm256_load_ps(packet + 16);
+    const __m256 e1x = _mm256_load_ps(packet + 24), e1y = _mm256_load_ps(packet + 32), e1z = _mm256_load_ps(packet + 40);
+    const __m256 e2x = _mm256_load_ps(packet + 48), e2y = _mm256_load_ps(packet + 56), e2z = _mm256_load_ps(packet + 64);
+
+    __m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+    __m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+    __m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+    __m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+    __m256 absDet = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), det);
+    __m256 valid = _mm256_cmp_ps(absDet, _mm256_set1_ps(1e-12f), _CMP_GE_OQ);
+    __m256 inverseDet = _mm256_div_ps(_mm256_set1_ps(1.0f), det);
+
+    __m256 sx = _mm256_sub_ps(ox, v0x), sy = _mm256_sub_ps(oy, v0y), sz = _mm256_sub_ps(oz, v0z);
+    __m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, px), _mm256_mul_ps(sy, py)),
+                                           _mm256_mul_ps(sz, pz)), inverseDet);
+
+    __m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+    __m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+    __m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+    __m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)),
+                                           _mm256_mul_ps(dz, qz)), inverseDet);
+    __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)),
+                                           _mm256_mul_ps(e2z, qz)), inverseDet);
+
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(u, one, _CMP_LE_OQ)));
+    valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ),
+                                               _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ)));
+    valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(t, zero, _CMP_GT_OQ),
+                                               _mm256_cmp_ps(t, _mm256_set1_ps(closest), _CMP_LT_OQ)));
+
+    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(valid));
+    if (mask == 0) return false;
+
+    alignas(32) float tLanes[8], uLanes[8], vLanes[8];
+    _mm256_store_ps(tLanes, t);
+    _mm256_store_ps(uLanes, u);
+    _mm256_store_ps(vLanes, v);
+    while (mask) {
+        uint32_t lane = lowestLane(mask);
+        mask &= mask - 1;
+        if (tLanes[lane] < closest) {
+            closest = tLanes[lane];
+            hit.t = tLanes[lane];
+            hit.u = uLanes[lane];
+            hit.v = vLanes[lane];
+            hit.triangle = packetTriangles[lane];
+        }
+    }
+    return true;
+}
+
+WIDE_BVH_TARGET_AVX2
+bool WideBvh::intersect8(const Bvh::Ray& ray, Bvh::Hit& hit) const {
+    if (nodes8.empty()) return false;
+    const uint32_t W = 8;
+
+    glm::vec3 inverseDirection = 1.0f / ray.direction;
+    uint32_t nearX = inverseDirection.x >= 0.0f ? 0 : 3 * W;
+    uint32_t nearY = (inverseDirection.y >= 0.0f ? 0 : 3 * W) + W;
+    uint32_t nearZ = (inverseDirection.z >= 0.0f ? 0 : 3 * W) + 2 * W;
+    uint32_t farX = inverseDirection.x >= 0.0f ? 3 * W : 0;
+    uint32_t farY = (inverseDirection.y >= 0.0f ? 3 * W : 0) + W;
+    uint32_t farZ = (inverseDirection.z >= 0.0f ? 3 * W : 0) + 2 * W;
+
+    const __m256 ox = _mm256_set1_ps(ray.origin.x), oy = _mm256_set1_ps(ray.origin.y), oz = _mm256_set1_ps(ray.origin.z);
+    const __m256 dx = _mm256_set1_ps(ray.direction.x), dy = _mm256_set1_ps(ray.direction.y), dz = _mm256_set1_ps(ray.direction.z);
+    const __m256 idx = _mm256_set1_ps(inverseDirection.x);
+    const __m256 idy = _mm256_set1_ps(inverseDirection.y);
+    const __m256 idz = _mm256_set1_ps(inverseDirection.z);
+
+    float closest = std::min(ray.tMax, hit.t);
+    bool found = false;
+
+    uint32_t stack[STACK_SIZE];
+    float stackNear[STACK_SIZE];
+    uint32_t stackSize = 0;
+    stack[stackSize] = 0;
+    stackNear[stackSize++] = 0.0f;
+
+    while (stackSize > 0) {
+        stackSize--;
+        if (stackNear[stackSize] > closest) continue;
+        const Node<8>& node = nodes8[stack[stackSize]];
+        const float* planes = node.minX;
+
+        __m256 tNearX = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(planes + nearX), ox), idx);
+        __m256 tNearY = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(planes + nearY), oy), idy);
+        __m256 tNearZ = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(planes + nearZ), oz), idz);
+        __m256 tFarX = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(planes + farX), ox), idx);
+        __m256 tFarY = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(planes + farY), oy), idy);
+        __m256 tFarZ = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(planes + farZ), oz), idz);
+        __m256 tNear = _mm256_max_ps(_mm256_max_ps(tNearX, tNearY), _mm256_max_ps(tNearZ, _mm256_setzero_ps()));
+        __m256 tFar = _mm256_min_ps(_mm256_min_ps(tFarX, tFarY), _mm256_min_ps(tFarZ, _mm256_set1_ps(closest)));
+
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(tNear, tFar, _CMP_LE_OQ)));
+        if (mask == 0) continue;
+
+        alignas(32) float nearT[8];
+        _mm256_store_ps(nearT, tNear);
+
+        uint32_t interior[8];
+        float interiorNear[8];
+        uint32_t interiorCount = 0;
+        while (mask) {
+            uint32_t lane = lowestLane(mask);
+            mask &= mask - 1;
+
+            if (node.packetCount[lane] > 0) {
+                for (uint32_t p = node.child[lane]; p < node.child[lane] + node.packetCount[lane]; p++) {
+                    const TrianglePacket<8>& packet = packets8[p];
+                    found |= intersectPacket8(packet.v0x, packet.triangle, ox, oy, oz, dx, dy, dz, closest, hit);
+                }
+                continue;
+            }
+
+            uint32_t i = interiorCount++;
+            while (i > 0 && interiorNear[i - 1] < nearT[lane]) {
+                interior[i] = interior[i - 1];
+                interiorNear[i] = interiorNear[i - 1];
+                i--;
+            }
+            interior[i] = node.child[lane];
+            interiorNear[i] = nearT[lane];
+        }
+
+        for (uint32_t i = 0; i < interiorCount; i++) {
+            stack[stackSize] = interior[i];
+            stackNear[stackSize++] = interiorNear[i];
+        }
+    }
+    return found;
+}
+
+#else
+
+bool WideBvh::intersect4(const Bvh::Ray& ray, Bvh::Hit& hit) const {
+    return source && source->intersect(ray, hit);
+}
+
+bool WideBvh::intersect8(const Bvh::Ray& ray, Bvh::Hit& hit) const {
+    return source && source->intersect(ray, hit);
+}
+
+#endif
+
+bool WideBvh::writeTraversalReport(const std::string& path, const std::vector<Vertex>& vertices,
+                                   const std::vector<uint32_t>& indices, uint32_t rayCount) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        LOG_ERROR("❌ Could not write BVH traversal report to " << path);
+        return false;
+    }
+
+    Bvh reference;
+    reference.build(vertices, indices);
+    if (reference.getTriangles().empty()) {
+        LOG_ERROR("❌ BVH traversal report needs a non-empty mesh");
+        return false;
+    }
+    const Bvh::Node& root = reference.getNodes()[0];
+    glm::vec3 center = (root.boundsMin + root.boundsMax) * 0.5f;
+    float radius = glm::length(root.boundsMax - root.boundsMin) * 0.5f;
+
+    // Coherent: a pinhole camera framing the mesh. Incoherent: random chords through a sphere
+    // around it, aimed at random points of the bounds.
+    uint32_t side = std::max(static_cast<uint32_t>(std::sqrt(static_cast<float>(rayCount))), 1u);
+    std::vector<Bvh::Ray> coherentRays;
+    coherentRays.reserve(static_cast<size_t>(side) * side);
+    glm::vec3 eye = center + glm::vec3(0.0f, radius * 0.3f, radius * 2.5f);
+    glm::vec3 forward = glm::normalize(center - eye);
+    glm::vec3 right = glm::normalize(glm::cross(forward, glm::vec3(0.0f, 1.0f, 0.0f)));
+    glm::vec3 up = glm::cross(right, forward);
+    for (uint32_t y = 0; y < side; y++) {
+        for (uint32_t x = 0; x < side; x++) {
+            float px = ((x + 0.5f) / side * 2.0f - 1.0f) * 0.5f;
+            float py = ((y + 0.5f) / side * 2.0f - 1.0f) * 0.5f;
+            Bvh::Ray ray;
+            ray.origin = eye;
+            ray.direction = glm::normalize(forward + right * px + up * py);
+            coherentRays.push_back(ray);
+        }
+    }
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<Bvh::Ray> incoherentRays(coherentRays.size());
+    for (Bvh::Ray& ray : incoherentRays) {
+        float z = unit(rng) * 2.0f - 1.0f;
+        float phi = unit(rng) * 6.2831853f;
+        float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+        ray.origin = center + glm::vec3(r * std::cos(phi), r * std::sin(phi), z) * (radius * 2.0f);
+        glm::vec3 target(root.boundsMin.x + (root.boundsMax.x - root.boundsMin.x) * unit(rng),
+                         root.boundsMin.y + (root.boundsMax.y - root.boundsMin.y) * unit(rng),
+                         root.boundsMin.z + (root.boundsMax.z - root.boundsMin.z) * unit(rng));
+        ray.direction = glm::normalize(target - ray.origin);
+    }
+
+    struct RaySet {
+        const char* name;
+        const std::vector<Bvh::Ray>* rays;
+        std::vector<Bvh::Hit> referenceHits;
+    };
+    RaySet sets[2] = {{"coherent", &coherentRays, {}}, {"incoherent", &incoherentRays, {}}};
+    for (RaySet& set : sets) {
+        set.referenceHits.resize(set.rays->size());
+        for (size_t i = 0; i < set.rays->size(); i++) {
+            reference.intersect((*set.rays)[i], set.referenceHits[i]);
+        }
+    }
+
+    out << "{\n";
+    out << "  \"triangles\": " << reference.getTriangles().size() << ",\n";
+    out << "  \"raysPerSet\": " << coherentRays.size() << ",\n";
+    out << "  \"detectedIsa\": \"" << isaName(detectIsa()) << "\",\n";
+    out << "  \"kernels\": [\n";
+    bool firstEntry = true;
+    for (Isa isa : {Isa::Scalar, Isa::Sse, Isa::Avx2}) {
+        out << (firstEntry ? "" : ",\n");
+        firstEntry = false;
+        if (!isSupported(isa)) {
+            out << "    {\"isa\": \"" << isaName(isa) << "\", \"supported\": false}";
+            continue;
+        }
+
+        // Leaves sized to the lane count so a leaf is one packet
+        Bvh::BuildOptions options;
+        options.maxLeafSize = std::max(laneCount(isa), 4u);
+        Bvh bvh;
+        bvh.build(vertices, indices, options);
+        WideBvh wide;
+        wide.build(bvh, isa);
+
+        out << "    {\"isa\": \"" << isaName(isa) << "\", \"supported\": true, \"lanes\": " << laneCount(isa)
+            << ", \"nodes\": " << wide.getNodeCount();
+        for (const RaySet& set : sets) {
+            std::vector<Bvh::Hit> hits(set.rays->size());
+            auto start = std::chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < set.rays->size(); i++) {
+                wide.intersect((*set.rays)[i], hits[i]);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            double mrays = set.rays->size() / std::max(seconds, 1e-9) / 1.0e6;
+
+            // Same closest distance as the scalar reference: ties may pick another triangle, and rays
+            // grazing a shared edge can round to either side of it when the kernel contracts to FMA
+            uint32_t hitCount = 0;
+            uint32_t mismatches = 0;
+            for (size_t i = 0; i < hits.size(); i++) {
+                bool hitWide = hits[i].triangle != UINT32_MAX;
+                bool hitReference = set.referenceHits[i].triangle != UINT32_MAX;
+                hitCount += hitWide ? 1 : 0;
+                if (hitWide != hitReference ||
+                    (hitWide && std::abs(hits[i].t - set.referenceHits[i].t) > 1e-4f * std::max(1.0f, hits[i].t))) {
+                    mismatches++;
+                }
+            }
+
+            out << ", \"" << set.name << "MraysPerSecondPerCore\": " << mrays
+                << ", \"" << set.name << "HitRate\": " << static_cast<double>(hitCount) / hits.size()
+                << ", \"" << set.name << "Mismatches\": " << mismatches;
+            LOG_INFO("🌲 " << isaName(isa) << " " << set.name << ": " << mrays << " Mrays/s per core, "
+                     << mismatches << " mismatches");
+        }
+        out << "}";
+    }
+    out << "\n  ]\n";
+    out << "}\n";
+
+    LOG_INFO("🌲 BVH traversal report written to " << path);
+    return true;
+}
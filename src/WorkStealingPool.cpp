@@ -0,0 +1,117 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(uint32_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    for (uint32_t i = 0; i < threadCount; i++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (uint32_t worker = 1; worker < threadCount; worker++) {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, worker);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::run(uint32_t taskCount, const Task& task) {
+    if (taskCount == 0) return;
+
+    // Contiguous blocks: participant p owns [p * n / P, (p + 1) * n / P)
+    uint32_t participants = getThreadCount();
+    for (uint32_t p = 0; p < participants; p++) {
+        uint32_t begin = static_cast<uint32_t>(uint64_t(taskCount) * p / participants);
+        uint32_t end = static_cast<uint32_t>(uint64_t(taskCount) * (p + 1) / participants);
+        std::lock_guard<std::mutex> lock(queues[p]->mutex);
+        for (uint32_t i = begin; i < end; i++) {
+            queues[p]->tasks.push_back(i);
+        }
+    }
+    remaining.store(taskCount);
+    steals.store(0);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = &task;
+        batch++;
+    }
+    wake.notify_all();
+
+    drain(0, task);
+
+    // Every task has run and no worker still holds the task pointer: safe to return
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return remaining.load() == 0 && busyWorkers == 0; });
+    current = nullptr;
+    lastSteals = steals.load();
+}
+
+void WorkStealingPool::workerLoop(uint32_t worker) {
+    uint64_t seenBatch = 0;
+    while (true) {
+        const Task* task = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || (current != nullptr && batch != seenBatch); });
+            if (stopping) return;
+            seenBatch = batch;
+            task = current;
+            busyWorkers++;
+        }
+
+        drain(worker, *task);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busyWorkers--;
+        }
+        done.notify_all();
+    }
+}
+
+void WorkStealingPool::drain(uint32_t worker, const Task& task) {
+    uint32_t index;
+    while (popLocal(worker, index) || steal(worker, index)) {
+        task(index, worker);
+        if (remaining.fetch_sub(1) == 1) {
+            // Taking the lock orders this with run()'s predicate check, so the wakeup is not lost
+            { std::lock_guard<std::mutex> lock(mutex); }
+            done.notify_all();
+        }
+    }
+}
+
+bool WorkStealingPool::popLocal(uint32_t worker, uint32_t& task) {
+    Queue& queue = *queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::steal(uint32_t worker, uint32_t& task) {
+    // Victims in ring order from the next participant, so thieves spread over different deques
+    uint32_t participants = getThreadCount();
+    for (uint32_t offset = 1; offset < participants; offset++) {
+        Queue& victim = *queues[(worker + offset) % participants];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) continue;
+        task = victim.tasks.back();
+        victim.tasks.pop_back();
+        steals.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
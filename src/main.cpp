@@ -1,27 +1,278 @@
 #include "ClippyRTXApp.h"
-#include <iostream>
+#include "Logger.h"
+#include "Bvh.h"
+#include "ClippyGeometry.h"
+#include "CpuPathTracer.h"
+#include "ImageCompare.h"
+#include "WideBvh.h"
 #include <stdexcept>
+#include <cstdio>
 #include <cstdlib>
+#include <filesystem>
+#include <string>
 
-int main() {
+// --cpu-trace: the headless frame sequence rendered by CpuPathTracer alone, no Vulkan device
+static bool runCpuTrace(const ClippyRTXApp::HeadlessOptions& options, uint32_t threadCount, bool packetTracing,
+                        bool wavefront) {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<ClippyGeometry::Part> parts;
+    std::vector<ClippyGeometry::PartInstance> instances;
+    ClippyGeometry::generateClippyParts(vertices, indices, parts, instances);
+    
+    CpuPathTracer tracer(threadCount);
+    tracer.setScene(vertices, indices, parts, instances);
+    tracer.setPacketTracing(packetTracing);
+    tracer.setWavefront(wavefront);
+    std::filesystem::create_directories(options.outputDir);
+    
+    LOG_INFO("Tracing " << options.frameCount << " frames on the CPU (" << options.width << "x" << options.height
+             << ", " << tracer.getThreadCount() << " threads)...");
+    
+    double totalMs = 0.0;
+    bool written = true;
+    for (uint32_t frame = 0; frame < options.frameCount; frame++) {
+        // Same fixed timestep as the headless loop
+        float time = static_cast<float>(frame + 1) / 60.0f;
+        UniformBufferObject ubo = CpuPathTracer::defaultUniforms(time, frame, options.width, options.height);
+        tracer.render(ubo, options.width, options.height);
+        totalMs += tracer.getLastRenderMs();
+        
+        bool isLastFrame = frame + 1 == options.frameCount;
+        bool save = options.saveEvery > 0 ? (frame % options.saveEvery == 0) : isLastFrame;
+        if (save) {
+            char name[32];
+            std::snprintf(name, sizeof(name), "frame_%05u.ppm", frame);
+            written = tracer.writePPM((std::filesystem::path(options.outputDir) / name).string()) && written;
+        }
+        LOG_INFO_EVERY_MS(1000, "   frame " << frame + 1 << "/" << options.frameCount
+                          << " (" << tracer.getLastRenderMs() << " ms)");
+    }
+    
+    if (options.frameCount > 0) {
+        double averageMs = totalMs / options.frameCount;
+        double megaPixels = static_cast<double>(options.width) * options.height / 1.0e6;
+        LOG_INFO("🖥️  CPU trace: " << averageMs << " ms/frame average, "
+                 << megaPixels * 1000.0 / averageMs << " Mpixel/s on " << tracer.getThreadCount() << " threads");
+    }
+    return written;
+}
+
+int main(int argc, char** argv) {
+    Logger::start();
+    
     ClippyRTXApp app;
     
-    std::cout << "==================================" << std::endl;
-    std::cout << "   Clippy RTX - Vulkan Ray Tracing" << std::endl;
-    std::cout << "==================================" << std::endl;
-    std::cout << "Initializing Clippy RTX..." << std::endl;
-    std::cout << "Controls:" << std::endl;
-    std::cout << "  SPACE - Toggle RTX On/Off" << std::endl;
-    std::cout << "  ESC   - Exit application" << std::endl;
-    std::cout << "==================================" << std::endl;
+    bool headless = false;
+    ClippyRTXApp::HeadlessOptions headlessOptions;
+    bool benchmark = false;
+    Benchmark::Options benchmarkOptions;
+    uint32_t tileSize = 0;
+    uint32_t tilesPerFrame = 0;
+    bool animatedBLAS = true;
+    uint32_t blasRebuildInterval = 60;
+    std::string bvhReportPath;
+    std::string bvhTraceReportPath;
+    std::string packetReportPath;
+    std::string wavefrontReportPath;
+    bool cpuTrace = false;
+    bool cpuFallback = true;
+    uint32_t cpuThreads = 0;
+    bool cpuPackets = true;
+    bool cpuWavefront = false;
+    bool compareReference = false;
+    std::string compareReferenceDir;
+    std::string compareTestDir;
+    ImageCompare::Thresholds compareThresholds;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--frames-in-flight" && i + 1 < argc) {
+            app.setFramesInFlight(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)));
+        } else if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--frames" && i + 1 < argc) {
+            headlessOptions.frameCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--width" && i + 1 < argc) {
+            headlessOptions.width = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--height" && i + 1 < argc) {
+            headlessOptions.height = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--save-every" && i + 1 < argc) {
+            headlessOptions.saveEvery = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--output" && i + 1 < argc) {
+            headlessOptions.outputDir = argv[++i];
+        } else if (arg == "--benchmark" && i + 1 < argc) {
+            benchmark = true;
+            benchmarkOptions.frames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            benchmarkOptions.warmupFrames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--timestep" && i + 1 < argc) {
+            benchmarkOptions.timestep = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--script" && i + 1 < argc) {
+            benchmarkOptions.scriptPath = argv[++i];
+        } else if (arg == "--report" && i + 1 < argc) {
+            benchmarkOptions.reportPath = argv[++i];
+        } else if (arg == "--tile-size" && i + 1 < argc) {
+            tileSize = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--tiles-per-frame" && i + 1 < argc) {
+            tilesPerFrame = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--no-blas-compaction") {
+            app.setBLASCompaction(false);
+        } else if (arg == "--no-animated-blas") {
+            animatedBLAS = false;
+        } else if (arg == "--blas-rebuild-interval" && i + 1 < argc) {
+            blasRebuildInterval = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--no-as-cache") {
+            app.setAccelerationStructureCache(false);
+        } else if (arg == "--as-report" && i + 1 < argc) {
+            app.setAccelerationStructureReport(argv[++i]);
+        } else if (arg == "--no-host-as-builds") {
+            app.setHostASBuilds(false);
+        } else if (arg == "--crowd" && i + 1 < argc) {
+            app.setCrowdSize(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)));
+        } else if (arg == "--bvh-report" && i + 1 < argc) {
+            bvhReportPath = argv[++i];
+        } else if (arg == "--bvh-trace-report" && i + 1 < argc) {
+            bvhTraceReportPath = argv[++i];
+        } else if (arg == "--cpu-trace") {
+            cpuTrace = true;
+        } else if (arg == "--no-cpu-fallback") {
+            cpuFallback = false;
+        } else if (arg == "--cpu-threads" && i + 1 < argc) {
+            cpuThreads = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--no-cpu-packets") {
+            cpuPackets = false;
+        } else if (arg == "--packet-report" && i + 1 < argc) {
+            packetReportPath = argv[++i];
+        } else if (arg == "--cpu-wavefront") {
+            cpuWavefront = true;
+        } else if (arg == "--wavefront-report" && i + 1 < argc) {
+            wavefrontReportPath = argv[++i];
+        } else if (arg == "--compare-reference") {
+            compareReference = true;
+        } else if (arg == "--compare-images" && i + 2 < argc) {
+            compareReferenceDir = argv[++i];
+            compareTestDir = argv[++i];
+        } else if (arg == "--compare-min-psnr" && i + 1 < argc) {
+            compareThresholds.minPsnr = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--compare-max-flip" && i + 1 < argc) {
+            compareThresholds.maxMeanFlip = std::strtod(argv[++i], nullptr);
+        } else {
+            LOG_WARN("Ignoring unknown argument: " << arg);
+        }
+    }
+    
+    LOG_INFO("==================================");
+    LOG_INFO("   Clippy RTX - Vulkan Ray Tracing");
+    LOG_INFO("==================================");
+    LOG_INFO("Initializing Clippy RTX...");
+    LOG_INFO("Controls:");
+    LOG_INFO("  SPACE - Toggle RTX On/Off");
+    LOG_INFO("  ESC   - Exit application");
+    LOG_INFO("Options:");
+    LOG_INFO("  --frames-in-flight N  (1-" << MAX_FRAMES_IN_FLIGHT << ", default " << DEFAULT_FRAMES_IN_FLIGHT << ")");
+    LOG_INFO("  --headless            (offscreen, no window; for render nodes / CI)");
+    LOG_INFO("    --frames N  --width W  --height H  --save-every N  --output DIR");
+    LOG_INFO("  --benchmark N         (fixed timestep run, JSON report; windowed or --headless)");
+    LOG_INFO("    --warmup N  --timestep S  --script FILE  --report FILE");
+    LOG_INFO("  --tile-size PX        (split traceRays into tiles; 0 = single launch)");
+    LOG_INFO("    --tiles-per-frame N (spread a pass over several frames/submits; 0 = all)");
+    LOG_INFO("  --no-blas-compaction  (keep the BLAS at its worst-case build size)");
+    LOG_INFO("  --no-animated-blas    (trace the rest pose; no per-frame BLAS refit)");
+    LOG_INFO("    --blas-rebuild-interval N (full BLAS rebuild every N refits, default 60)");
+    LOG_INFO("  --no-as-cache         (always build; skip the serialized BLAS cache as_cache.bin)");
+    LOG_INFO("  --as-report FILE      (per-BLAS/TLAS sizes, GPU build times and CPU BVH quality as JSON)");
+    LOG_INFO("  --no-host-as-builds   (build BLASes on the GPU even if host builds are supported)");
+    LOG_INFO("  --crowd N             (N Clippies in one TLAS, up to " << RayTracingPipeline::MAX_CROWD_SIZE << ")");
+    LOG_INFO("  --bvh-report FILE     (CPU BVH build scaling as JSON, no GPU needed; then exit)");
+    LOG_INFO("  --bvh-trace-report FILE (scalar/SSE/AVX2 BVH traversal Mrays/s as JSON, no GPU needed; then exit)");
+    LOG_INFO("  --cpu-trace           (headless frames from the CPU path tracer, no GPU needed; then exit)");
+    LOG_INFO("  --no-cpu-fallback     (rasterize instead of CPU path tracing when RT is unsupported)");
+    LOG_INFO("    --cpu-threads N     (CPU path tracer threads; 0 = all hardware threads)");
+    LOG_INFO("    --no-cpu-packets    (one primary ray per pixel instead of 8x8 ray packets)");
+    LOG_INFO("    --cpu-wavefront     (trace bounces as sorted frame-wide ray queues instead of recursively)");
+    LOG_INFO("  --packet-report FILE  (single-ray vs packet Mrays/s, primary and shadow, at --width/--height as JSON; then exit)");
+    LOG_INFO("  --wavefront-report FILE (recursive vs wavefront bounces at 2 and 4 bounces, at --width/--height as JSON; then exit)");
+    LOG_INFO("  --compare-reference   (headless: CPU reference of each saved frame, compared after the run; fails on regressions)");
+    LOG_INFO("  --compare-images REF_DIR TEST_DIR (compare frame_*.ppm of two runs, no GPU needed; then exit)");
+    LOG_INFO("    --compare-min-psnr DB (default 30)  --compare-max-flip F (mean FLIP-style error, default 0.05)");
+    LOG_INFO("==================================");
+    
+    // CPU-only: no window or Vulkan device is created
+    if (!bvhReportPath.empty()) {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        ClippyGeometry::generateClippy(vertices, indices);
+        bool written = Bvh::writeScalingReport(bvhReportPath, vertices, indices);
+        Logger::shutdown();
+        return written ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (!bvhTraceReportPath.empty()) {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        ClippyGeometry::generateClippy(vertices, indices);
+        bool written = WideBvh::writeTraversalReport(bvhTraceReportPath, vertices, indices);
+        Logger::shutdown();
+        return written ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (!packetReportPath.empty()) {
+        bool written = CpuPathTracer::writePacketReport(packetReportPath, headlessOptions.width, headlessOptions.height);
+        Logger::shutdown();
+        return written ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (!wavefrontReportPath.empty()) {
+        bool written = CpuPathTracer::writeWavefrontReport(wavefrontReportPath, headlessOptions.width,
+                                                           headlessOptions.height, cpuThreads);
+        Logger::shutdown();
+        return written ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (!compareTestDir.empty()) {
+        std::filesystem::path testDir(compareTestDir);
+        bool passed = ImageCompare::compareDirectories(compareReferenceDir, compareTestDir, (testDir / "compare").string(),
+                                                       (testDir / "image_compare.json").string(), compareThresholds);
+        Logger::shutdown();
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (cpuTrace) {
+        bool written = runCpuTrace(headlessOptions, cpuThreads, cpuPackets, cpuWavefront);
+        Logger::shutdown();
+        return written ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
     
     try {
+        if (headless) {
+            app.setHeadless(headlessOptions);
+        }
+        if (benchmark) {
+            app.setBenchmark(benchmarkOptions);  // Loads the script: may throw
+        }
+        
+        app.setTracing(tileSize, tilesPerFrame);
+        app.setAnimatedBLAS(animatedBLAS, blasRebuildInterval);
+        app.setCpuFallback(cpuFallback, cpuThreads);
+        app.setCpuPacketTracing(cpuPackets);
+        app.setCpuWavefront(cpuWavefront);
+        if (compareReference) {
+            if (!headless) {
+                LOG_WARN("⚠️  --compare-reference needs --headless; ignored");
+            } else {
+                app.setImageComparison(compareThresholds);
+            }
+        }
         app.run();
     } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
+        LOG_ERROR("Error: " << e.what());
+        Logger::shutdown();
+        return EXIT_FAILURE;
+    }
+    
+    if (!app.imageComparisonPassed()) {
+        LOG_ERROR("❌ Rendered frames differ from the CPU reference");
+        Logger::shutdown();
         return EXIT_FAILURE;
     }
     
-    std::cout << "Clippy RTX terminated successfully." << std::endl;
+    LOG_INFO("Clippy RTX terminated successfully.");
+    Logger::shutdown();
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
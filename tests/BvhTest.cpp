@@ -0,0 +1,171 @@
+#include "Bvh.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Bvh::intersect against testing every triangle, on a random soup and on a degenerate mesh deep
+// enough to hit Bvh::MAX_DEPTH. No GPU involved. Exits non-zero on the first disagreement.
+
+static int failures = 0;
+
+#define CHECK(condition, ...)                                    \
+    do {                                                         \
+        if (!(condition)) {                                      \
+            std::fprintf(stderr, "FAILED %s:%d: ", __FILE__, __LINE__); \
+            std::fprintf(stderr, __VA_ARGS__);                   \
+            std::fprintf(stderr, "\n");                          \
+            failures++;                                          \
+        }                                                        \
+    } while (0)
+
+static void addTriangle(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                        const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    for (const glm::vec3& p : {a, b, c}) {
+        Vertex vertex{};
+        vertex.pos = p;
+        indices.push_back(static_cast<uint32_t>(vertices.size()));
+        vertices.push_back(vertex);
+    }
+}
+
+// Möller-Trumbore, the same test Bvh uses, so only the traversal can make them disagree
+static bool bruteForce(const Bvh& bvh, const Bvh::Ray& ray, Bvh::Hit& hit) {
+    bool found = false;
+    const std::vector<Bvh::Triangle>& triangles = bvh.getTriangles();
+    for (uint32_t i = 0; i < triangles.size(); i++) {
+        const Bvh::Triangle& triangle = triangles[i];
+        glm::vec3 edge1 = triangle.v1 - triangle.v0;
+        glm::vec3 edge2 = triangle.v2 - triangle.v0;
+        glm::vec3 p = glm::cross(ray.direction, edge2);
+        float determinant = glm::dot(edge1, p);
+        if (std::abs(determinant) < 1e-12f) continue;
+
+        float inverseDeterminant = 1.0f / determinant;
+        glm::vec3 s = ray.origin - triangle.v0;
+        float u = glm::dot(s, p) * inverseDeterminant;
+        if (u < 0.0f || u > 1.0f) continue;
+        glm::vec3 q = glm::cross(s, edge1);
+        float v = glm::dot(ray.direction, q) * inverseDeterminant;
+        if (v < 0.0f || u + v > 1.0f) continue;
+
+        float t = glm::dot(edge2, q) * inverseDeterminant;
+        if (t > 0.0f && t < std::min(ray.tMax, hit.t)) {
+            hit.t = t;
+            hit.triangle = i;
+            found = true;
+        }
+    }
+    return found;
+}
+
+static void compareRays(const char* name, const Bvh& bvh, const std::vector<Bvh::Ray>& rays) {
+    uint32_t hits = 0;
+    for (size_t i = 0; i < rays.size(); i++) {
+        Bvh::Hit expected, actual;
+        bool expectedFound = bruteForce(bvh, rays[i], expected);
+        bool actualFound = bvh.intersect(rays[i], actual);
+        CHECK(expectedFound == actualFound, "%s: ray %zu %s by brute force but %s by the BVH", name, i,
+              expectedFound ? "hits" : "misses", actualFound ? "hits" : "misses");
+        if (expectedFound && actualFound) {
+            // Two triangles can share the closest distance; the distance itself must match
+            CHECK(std::abs(expected.t - actual.t) <= 1e-5f * std::max(1.0f, expected.t),
+                  "%s: ray %zu closest t %g (triangle %u), BVH %g (triangle %u)", name, i, expected.t,
+                  expected.triangle, actual.t, actual.triangle);
+            hits++;
+        }
+    }
+    std::printf("%s: %zu rays, %u hits, %u nodes, depth %u\n", name, rays.size(), hits,
+                bvh.getStats().nodeCount, bvh.getStats().maxDepth);
+}
+
+static void testRandomSoup() {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    for (int i = 0; i < 5000; i++) {
+        glm::vec3 center(position(rng), position(rng), position(rng));
+        addTriangle(vertices, indices, center + glm::vec3(offset(rng), offset(rng), offset(rng)),
+                    center + glm::vec3(offset(rng), offset(rng), offset(rng)),
+                    center + glm::vec3(offset(rng), offset(rng), offset(rng)));
+    }
+
+    std::vector<Bvh::Ray> rays(20000);
+    for (Bvh::Ray& ray : rays) {
+        ray.origin = glm::vec3(position(rng), position(rng), position(rng)) * 1.5f;
+        ray.direction = glm::normalize(glm::vec3(offset(rng), offset(rng), offset(rng)) + glm::vec3(1e-3f));
+    }
+
+    for (bool parallel : {false, true}) {
+        Bvh::BuildOptions options;
+        options.parallel = parallel;
+        options.parallelMinTriangles = 256;
+        Bvh bvh;
+        bvh.build(vertices, indices, options);
+        CHECK(bvh.getStats().triangleCount == 5000, "random soup: %u triangles", bvh.getStats().triangleCount);
+        compareRays(parallel ? "random soup (parallel build)" : "random soup", bvh, rays);
+    }
+}
+
+// Unit squares across the x axis at geometrically growing x: every binned split peels off only
+// the farthest one or two, so the tree degenerates into a chain far deeper than MAX_DEPTH allows.
+// Each square sits at one of three heights, so rays along x pass through many before their hit.
+static void testDeepChain() {
+    const int count = 200;
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    for (int i = 0; i < count; i++) {
+        float x = std::pow(1.5f, static_cast<float>(i));
+        float y = static_cast<float>((i * 7) % 3) * 2.0f;
+        addTriangle(vertices, indices, glm::vec3(x, y, 0.0f), glm::vec3(x, y + 1.0f, 0.0f), glm::vec3(x, y, 1.0f));
+        addTriangle(vertices, indices, glm::vec3(x, y + 1.0f, 1.0f), glm::vec3(x, y, 1.0f), glm::vec3(x, y + 1.0f, 0.0f));
+    }
+
+    Bvh::BuildOptions options;
+    options.binCount = 2;
+    options.maxLeafSize = 1;
+    Bvh bvh;
+    bvh.build(vertices, indices, options);
+    CHECK(bvh.getStats().maxDepth == Bvh::MAX_DEPTH, "deep chain: depth %u, expected the cap %u",
+          bvh.getStats().maxDepth, Bvh::MAX_DEPTH);
+
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<int> square(0, count - 1);
+    std::vector<Bvh::Ray> rays(4000);
+    for (size_t i = 0; i < rays.size(); i++) {
+        Bvh::Ray& ray = rays[i];
+        float y = static_cast<float>(i % 3) * 2.0f + unit(rng);
+        float start = std::pow(1.5f, static_cast<float>(square(rng))) * (0.5f + unit(rng));
+        ray.origin = glm::vec3(i % 2 == 0 ? start : 1e36f, y, unit(rng));
+        ray.direction = glm::vec3(i % 2 == 0 ? 1.0f : -1.0f, 0.0f, 0.0f);
+    }
+    compareRays("deep chain", bvh, rays);
+}
+
+static void testEmpty() {
+    Bvh bvh;
+    bvh.build({}, {});
+    Bvh::Ray ray;
+    ray.origin = glm::vec3(0.0f);
+    ray.direction = glm::vec3(0.0f, 0.0f, 1.0f);
+    Bvh::Hit hit;
+    CHECK(!bvh.intersect(ray, hit), "empty BVH reported a hit");
+}
+
+int main() {
+    testEmpty();
+    testRandomSoup();
+    testDeepChain();
+
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All BVH checks passed\n");
+    return EXIT_SUCCESS;
+}